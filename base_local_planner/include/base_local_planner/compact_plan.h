@@ -0,0 +1,146 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#ifndef COMPACT_PLAN_H_
+#define COMPACT_PLAN_H_
+
+#include <vector>
+#include <string>
+#include <ros/ros.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <nav_msgs/Path.h>
+
+namespace base_local_planner {
+  /**
+   * @class CompactPlan
+   * @brief A planar plan with one array per coordinate, a single frame and stamp for all its poses and the
+   * cumulative arc length. Copies are a few contiguous arrays instead of a header per pose, plans are only
+   * converted to vectors of PoseStamped where they are handed to a plugin or published.
+   */
+  class CompactPlan {
+    public:
+      /**
+       * @brief  Constructs an empty plan
+       */
+      CompactPlan();
+
+      /**
+       * @brief  Constructs a plan from poses, taking the frame and stamp of the first one
+       */
+      explicit CompactPlan(const std::vector<geometry_msgs::PoseStamped>& poses);
+
+      size_t size() const { return x_.size(); }
+      bool empty() const { return x_.empty(); }
+      void clear();
+      void reserve(size_t num_poses);
+
+      /**
+       * @brief  Appends a pose, the arc length is extended with its distance to the previous one
+       */
+      void push_back(double x, double y, double yaw);
+
+      /**
+       * @brief  Appends the poses [begin, end) of another plan, which is expected to be in the same frame
+       */
+      void append(const CompactPlan& other, size_t begin, size_t end);
+      void append(const CompactPlan& other);
+
+      /**
+       * @brief  Keeps only the first num_poses poses
+       */
+      void truncate(size_t num_poses);
+
+      void swap(CompactPlan& other);
+
+      double x(size_t i) const { return x_[i]; }
+      double y(size_t i) const { return y_[i]; }
+      double yaw(size_t i) const { return yaw_[i]; }
+
+      /**
+       * @brief  Distance along the plan from its first pose to pose i
+       */
+      double arcLength(size_t i) const { return arc_length_[i]; }
+
+      /**
+       * @brief  Distance along the plan from its first to its last pose, 0 for an empty plan
+       */
+      double length() const { return arc_length_.empty() ? 0.0 : arc_length_.back(); }
+
+      /**
+       * @brief  Index of the first pose at or beyond arc length s, size() if the plan is shorter
+       */
+      size_t indexAtArcLength(double s) const;
+
+      /**
+       * @brief  Identifies the poses of the plan: copies share it, and any change of the poses gives a new one.
+       * Assigned on the first call after a change, so a plan is not meant to be read by several threads then
+       */
+      unsigned long revision() const;
+
+      const std::string& frameId() const { return frame_id_; }
+      void setFrameId(const std::string& frame_id) { frame_id_ = frame_id; }
+      const ros::Time& stamp() const { return stamp_; }
+      void setStamp(const ros::Time& stamp) { stamp_ = stamp; }
+
+      /**
+       * @brief  Pose i as a message, with the frame and stamp of the plan
+       */
+      geometry_msgs::PoseStamped pose(size_t i) const;
+
+      /**
+       * @brief  Replaces the plan by poses, taking the frame and stamp of the first one
+       */
+      void fromPoses(const std::vector<geometry_msgs::PoseStamped>& poses);
+
+      /**
+       * @brief  All the poses as messages, e.g. for nav_core plugins
+       */
+      void toPoses(std::vector<geometry_msgs::PoseStamped>& poses) const;
+
+      /**
+       * @brief  The plan as a path message for publishing
+       */
+      void toPath(nav_msgs::Path& path) const;
+
+    private:
+      std::vector<double> x_, y_, yaw_;
+      std::vector<double> arc_length_;
+      mutable unsigned long revision_;    // 0 until asked for after a change
+      std::string frame_id_;
+      ros::Time stamp_;
+  };
+};
+#endif
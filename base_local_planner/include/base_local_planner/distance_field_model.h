@@ -0,0 +1,173 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#ifndef TRAJECTORY_ROLLOUT_DISTANCE_FIELD_MODEL_H_
+#define TRAJECTORY_ROLLOUT_DISTANCE_FIELD_MODEL_H_
+
+#include <vector>
+#include <queue>
+#include <base_local_planner/world_model.h>
+#include <base_local_planner/costmap_model.h>
+#include <costmap_2d/costmap_2d.h>
+
+namespace base_local_planner {
+  /**
+   * @class DistanceFieldModel
+   * @brief A class that implements the WorldModel interface with a Euclidean distance transform of the
+   * lethal and unknown cells of the costmap. A rectangular footprint is covered by a row of circles along its
+   * long side and checked with one distance lookup per circle. Other footprints are checked with a CostmapModel.
+   * The distances are kept up to date by update(), which only propagates the cells that changed since the last call.
+   */
+  class DistanceFieldModel : public WorldModel {
+    public:
+      /**
+       * @brief  Constructor for the DistanceFieldModel
+       * @param costmap The costmap that should be used
+       * @param max_cover_overshoot How far the circle cover may stick out of the sides of the footprint, in meters. Defaults to the costmap resolution
+       */
+      DistanceFieldModel(const costmap_2d::Costmap2D& costmap, double max_cover_overshoot = -1.0);
+
+      /**
+       * @brief  Destructor for the world model
+       */
+      virtual ~DistanceFieldModel(){}
+      using WorldModel::footprintCost;
+
+      /**
+       * @brief  Checks if any obstacles in the costmap lie inside the circle cover of a rectangular footprint.
+       * The check is conservative: the circles are grown by the distance from their center to the center of its cell plus half a cell diagonal.
+       * Safe to call concurrently as long as update is not called
+       * @param  position The position of the robot in world coordinates
+       * @param  footprint The specification of the footprint of the robot in world coordinates
+       * @param  inscribed_radius The radius of the inscribed circle of the robot
+       * @param  circumscribed_radius The radius of the circumscribed circle of the robot
+       * @return Zero if the circles are free of obstacles, negative otherwise
+       */
+      virtual double footprintCost(const geometry_msgs::Point& position, const std::vector<geometry_msgs::Point>& footprint,
+          double inscribed_radius, double circumscribed_radius);
+
+      /**
+       * @brief  Sets the footprint used by footprintCost(x, y, theta), its circle cover is computed once
+       * @param footprint_spec The footprint of the robot in the robot frame
+       * @return True if the footprint changed
+       */
+      bool setFootprint(const std::vector<geometry_msgs::Point>& footprint_spec);
+
+      /**
+       * @brief  Checks the footprint given to setFootprint at a pose, like the WorldModel footprintCost but without
+       * transforming the footprint first. Safe to call concurrently as long as update and setFootprint are not called
+       * @param x The x position of the robot in world coordinates
+       * @param y The y position of the robot in world coordinates
+       * @param theta The orientation of the robot
+       * @return Zero if the circles are free of obstacles, negative otherwise
+       */
+      double footprintCost(double x, double y, double theta) const;
+
+      /**
+       * @brief  Brings the distances up to date with the costmap. Only the cells that changed are propagated,
+       * a costmap that moved by whole cells is shifted, and a resized costmap is transformed from scratch
+       * @return True if any obstacle was added or removed
+       */
+      bool update();
+
+      /**
+       * @brief  Distance from the center of a cell to the center of the closest obstacle cell, as of the last update
+       * @param x The x position of the cell in cell coordinates
+       * @param y The y position of the cell in cell coordinates
+       * @return The distance in meters, a negative value if there are no obstacles
+       */
+      double distance(unsigned int x, unsigned int y) const;
+
+      /**
+       * @brief  Lower bound of the distance from a point to the closest obstacle cell or to the map bounds, as of the last update.
+       * Any footprint inside the circle of this radius around the point is free. Safe to call concurrently as long as update is not called
+       * @param x The x position of the point in world coordinates
+       * @param y The y position of the point in world coordinates
+       * @return The distance in meters, zero or negative outside the map
+       */
+      double clearance(double x, double y) const;
+
+    private:
+      typedef std::pair<int, unsigned int> QueueEntry;    // squared distance in cells, cell index
+
+      static const int NO_OBSTACLE = -1;
+      static const int MAX_SQ_DIST = 0x7fffffff;
+
+      /**
+       * @brief Circles covering the rectangle with corners x0, x0 + a, x0 + a + b and x0 + b
+       */
+      struct RectangleCover
+      {
+          double x0, y0, ax, ay, bx, by;
+          int n_a, n_b;
+          double radius, inscribed_radius, circumscribed_radius;
+      };
+
+      bool makeCover(const std::vector<geometry_msgs::Point>& rectangle, RectangleCover& cover) const;
+      double coverCost(const RectangleCover& cover, double x, double y, double cos_th, double sin_th) const;
+      void distanceBounds(double wx, double wy, double& lower, double& upper) const;
+      bool geometryMatchesCostmap() const;
+
+      void reset();
+      void shift(int dx, int dy);
+      void setObstacle(unsigned int index);
+      void removeObstacle(unsigned int index);
+      void propagate();
+      void raise(unsigned int index);
+      void lower(unsigned int index);
+
+      bool isObstacleCost(unsigned char cost) const;
+
+      const costmap_2d::Costmap2D& costmap_; ///< @brief Allows access of costmap obstacle information
+      mutable CostmapModel costmap_model_; ///< @brief Used for footprints that are not rectangles
+      double max_cover_overshoot_;
+      std::vector<geometry_msgs::Point> footprint_spec_;
+      RectangleCover cover_;
+      bool has_cover_;
+
+      // Geometry of the costmap the distances belong to
+      unsigned int size_x_, size_y_;
+      double resolution_, origin_x_, origin_y_;
+
+      std::vector<unsigned char> last_costs_; ///< @brief Costmap as of the last update
+      std::vector<unsigned char> occupied_;   ///< @brief Obstacle cells as of the last update
+      std::vector<int> sq_dist_;              ///< @brief Squared distance to the closest obstacle, in cells
+      std::vector<int> closest_obstacle_;     ///< @brief Index of the closest obstacle cell, or NO_OBSTACLE
+      std::vector<unsigned char> to_raise_;   ///< @brief The closest obstacle was removed, the cell waits to be cleared
+      std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > open_;
+  };
+};
+#endif
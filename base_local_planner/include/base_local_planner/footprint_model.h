@@ -0,0 +1,180 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#ifndef FOOTPRINT_MODEL_H_
+#define FOOTPRINT_MODEL_H_
+
+#include <vector>
+#include <cmath>
+#include <geometry_msgs/Point.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace base_local_planner {
+  /**
+   * @class FootprintModel
+   * @brief Everything derived from a footprint that footprint checks need: the vertices, the inscribed and
+   * circumscribed radii, the corners of a rectangular footprint and its perimeter rasterized per heading.
+   * A model never changes once built, so it is shared between threads and planners by pointer. A new
+   * footprint is a new model with a new version.
+   */
+  class FootprintModel {
+    public:
+      struct CellOffset
+      {
+          int dx, dy;
+          bool operator<(const CellOffset& other) const { return dy < other.dy || (dy == other.dy && dx < other.dx); }
+          bool operator==(const CellOffset& other) const { return dx == other.dx && dy == other.dy; }
+      };
+
+      /**
+       * @brief  Perimeter cells of the footprint at one heading, relative to the cell of the robot center, sorted by row
+       */
+      struct HeadingTemplate
+      {
+          std::vector<CellOffset> cells;
+          int min_dx, max_dx, min_dy, max_dy;
+      };
+
+      /**
+       * @brief  Constructor for the FootprintModel
+       * @param footprint_spec The footprint of the robot in the robot frame
+       * @param resolution Costmap resolution the templates are rasterized for, 0 to build no templates
+       * @param num_heading_bins Number of heading bins over a full turn, a multiple of 4 keeps the axis aligned headings exact
+       */
+      FootprintModel(const std::vector<geometry_msgs::Point>& footprint_spec, double resolution = 0.0, unsigned int num_heading_bins = 256);
+
+      const std::vector<geometry_msgs::Point>& getFootprint() const { return footprint_spec_; }
+
+      /**
+       * @brief  A footprint with at least 3 points, otherwise the robot is taken as a point
+       */
+      bool hasFootprint() const { return footprint_spec_.size() >= 3; }
+
+      double inscribedRadius() const { return inscribed_radius_; }
+      double circumscribedRadius() const { return circumscribed_radius_; }
+
+      /**
+       * @brief  Unique per model, a changed footprint always gets a higher version
+       */
+      unsigned long version() const { return version_; }
+
+      /**
+       * @brief  Whether the footprint has four points, one in each quadrant around the center of rotation.
+       * Only then the corner accessors are meaningful. The robot heads along the x axis
+       */
+      bool hasFourCorners() const { return four_corners_; }
+      const geometry_msgs::Point& frontLeftCorner() const { return front_left_; }
+      const geometry_msgs::Point& frontRightCorner() const { return front_right_; }
+      const geometry_msgs::Point& rearLeftCorner() const { return rear_left_; }
+      const geometry_msgs::Point& rearRightCorner() const { return rear_right_; }
+
+      /**
+       * @brief  Whether footprint_spec has the same points as this model
+       */
+      bool sameFootprint(const std::vector<geometry_msgs::Point>& footprint_spec) const;
+
+      /**
+       * @brief  Whether the templates of this model were rasterized for this resolution and number of bins
+       */
+      bool hasTemplates(double resolution, unsigned int num_heading_bins) const;
+
+      double resolution() const { return resolution_; }
+      unsigned int numHeadingBins() const { return num_heading_bins_; }
+
+      /**
+       * @brief  The template of the bin closest to theta. Only valid when the model has templates
+       */
+      const HeadingTemplate& headingTemplate(double theta) const { return templates_[headingBin(theta)]; }
+
+    private:
+      void buildTemplate(double theta, HeadingTemplate& heading_template) const;
+
+      unsigned int headingBin(double theta) const {
+        int bin = (int) floor(theta * num_heading_bins_ / (2.0 * M_PI) + 0.5) % (int) num_heading_bins_;
+        if(bin < 0)
+          bin += num_heading_bins_;
+        return bin;
+      }
+
+      std::vector<geometry_msgs::Point> footprint_spec_;
+      double inscribed_radius_, circumscribed_radius_;
+      unsigned long version_;
+      bool four_corners_;
+      geometry_msgs::Point front_left_, front_right_, rear_left_, rear_right_;
+      double resolution_;
+      unsigned int num_heading_bins_;
+      std::vector<HeadingTemplate> templates_;
+  };
+
+  typedef boost::shared_ptr<const FootprintModel> FootprintModelConstPtr;
+
+  /**
+   * @class SharedFootprintModel
+   * @brief The current footprint model of a robot, shared by the planners that check its footprint.
+   * Installing a new footprint swaps the model, a reader keeps the model it took until it takes a new one.
+   */
+  class SharedFootprintModel {
+    public:
+      /**
+       * @param num_heading_bins Number of heading bins of the templates of the models built by set
+       */
+      SharedFootprintModel(unsigned int num_heading_bins = 256);
+
+      /**
+       * @brief  The current model, empty until a footprint is set
+       */
+      FootprintModelConstPtr get() const;
+
+      /**
+       * @brief  Builds and installs a model for footprint_spec, unless the current one already matches it
+       * @param resolution Costmap resolution the templates are rasterized for
+       * @return True if a new model was installed
+       */
+      bool set(const std::vector<geometry_msgs::Point>& footprint_spec, double resolution);
+
+      /**
+       * @brief  Installs a model built elsewhere
+       */
+      void set(const FootprintModelConstPtr& model);
+
+    private:
+      unsigned int num_heading_bins_;
+      mutable boost::mutex mutex_;
+      FootprintModelConstPtr model_;
+  };
+};
+#endif
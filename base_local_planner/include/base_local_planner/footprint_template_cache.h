@@ -0,0 +1,106 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#ifndef FOOTPRINT_TEMPLATE_CACHE_H_
+#define FOOTPRINT_TEMPLATE_CACHE_H_
+
+#include <vector>
+#include <base_local_planner/costmap_model.h>
+#include <base_local_planner/footprint_model.h>
+#include <costmap_2d/costmap_2d.h>
+#include <geometry_msgs/Point.h>
+
+namespace base_local_planner {
+  /**
+   * @class FootprintTemplateCache
+   * @brief Rasterizes the perimeter of a footprint once per quantized heading, so that a footprint check
+   * is a single worldToMap of the robot center plus a gather of cell offsets from the costmap char array.
+   * The result follows CostmapModel::footprintCost, up to the heading quantization and to the robot
+   * center being taken at the center of its cell. The templates live in a FootprintModel, so caches that are
+   * given the same model share them.
+   */
+  class FootprintTemplateCache {
+    public:
+      /**
+       * @brief  Constructor for the FootprintTemplateCache
+       * @param costmap The costmap that should be used
+       * @param num_heading_bins Number of heading bins over a full turn, a multiple of 4 keeps the axis aligned headings exact
+       */
+      FootprintTemplateCache(const costmap_2d::Costmap2D& costmap, unsigned int num_heading_bins = 256);
+
+      /**
+       * @brief  Sets the footprint of the robot, the templates are only rebuilt when it or the costmap resolution changed
+       * @param footprint_spec The footprint of the robot in the robot frame
+       * @return True if the templates were rebuilt
+       */
+      bool setFootprint(const std::vector<geometry_msgs::Point>& footprint_spec);
+
+      /**
+       * @brief  Uses the templates of a shared footprint model. They are only rebuilt when the model was rasterized
+       * for another resolution or number of bins
+       * @return True if the footprint model changed
+       */
+      bool setFootprintModel(const FootprintModelConstPtr& model);
+
+      /**
+       * @brief  The footprint model in use, empty until a footprint is set
+       */
+      const FootprintModelConstPtr& getFootprintModel() const { return model_; }
+
+      /**
+       * @brief  Checks the footprint of the robot at a pose. Safe to call concurrently as long as setFootprint is not called
+       * @param x The x position of the robot in world coordinates
+       * @param y The y position of the robot in world coordinates
+       * @param theta The orientation of the robot
+       * @return A positive cost for a legal footprint... negative otherwise
+       */
+      double footprintCost(double x, double y, double theta) const;
+
+      /**
+       * @brief  A footprint with at least 3 points has been set
+       */
+      bool hasFootprint() const { return model_ && model_->hasFootprint(); }
+
+      unsigned int numHeadingBins() const { return num_heading_bins_; }
+
+    private:
+      const costmap_2d::Costmap2D& costmap_; ///< @brief Allows access of costmap obstacle information
+      mutable CostmapModel exact_model_; ///< @brief Used when the footprint gets close to the map bounds
+      unsigned int num_heading_bins_;
+      FootprintModelConstPtr model_;
+  };
+};
+#endif
@@ -43,6 +43,7 @@
 #include <base_local_planner/map_cell.h>
 #include <costmap_2d/costmap_2d.h>
 #include <geometry_msgs/PoseStamped.h>
+#include <base_local_planner/compact_plan.h>
 
 namespace base_local_planner{
   /**
@@ -159,9 +160,11 @@ namespace base_local_planner{
        * @param global_plan_in input
        * @param global_plan_output output
        * @param resolution desired distance between waypoints
+       * The poses overload goes through a CompactPlan, so its output poses have the frame and stamp of the plan and no z
        */
       static void adjustPlanResolution(const std::vector<geometry_msgs::PoseStamped>& global_plan_in,
             std::vector<geometry_msgs::PoseStamped>& global_plan_out, double resolution);
+      static void adjustPlanResolution(const CompactPlan& global_plan_in, CompactPlan& global_plan_out, double resolution);
 
       /**
        * @brief  Compute the distance from each cell in the local map grid to the planned path
@@ -179,12 +182,14 @@ namespace base_local_planner{
        * @brief Update what cells are considered path based on the global plan 
        */
       void setTargetCells(const costmap_2d::Costmap2D& costmap, const std::vector<geometry_msgs::PoseStamped>& global_plan);
+      void setTargetCells(const costmap_2d::Costmap2D& costmap, const CompactPlan& global_plan);
 
       /**
        * @brief Update what cell is considered the next local goal
        */
       void setLocalGoal(const costmap_2d::Costmap2D& costmap,
             const std::vector<geometry_msgs::PoseStamped>& global_plan);
+      void setLocalGoal(const costmap_2d::Costmap2D& costmap, const CompactPlan& global_plan);
 
       double goal_x_, goal_y_; /**< @brief The goal distance was last computed from */
 
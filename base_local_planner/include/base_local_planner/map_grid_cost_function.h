@@ -85,7 +85,8 @@ public:
   /**
    * set line segments on the grid with distance 0, resets the grid
    */
-  void setTargetPoses(std::vector<geometry_msgs::PoseStamped> target_poses);
+  void setTargetPoses(const std::vector<geometry_msgs::PoseStamped>& target_poses);
+  void setTargetPoses(const CompactPlan& target_poses);
 
   void setXShift(double xshift) {xshift_ = xshift;}
   void setYShift(double yshift) {yshift_ = yshift;}
@@ -122,7 +123,7 @@ public:
   double getCellCosts(unsigned int cx, unsigned int cy);
 
 private:
-  std::vector<geometry_msgs::PoseStamped> target_poses_;
+  CompactPlan target_poses_;
   costmap_2d::Costmap2D* costmap_;
 
   base_local_planner::MapGrid map_;
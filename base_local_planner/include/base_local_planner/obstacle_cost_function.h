@@ -41,6 +41,7 @@
 #include <base_local_planner/trajectory_cost_function.h>
 
 #include <base_local_planner/costmap_model.h>
+#include <base_local_planner/footprint_template_cache.h>
 #include <costmap_2d/costmap_2d.h>
 
 namespace base_local_planner {
@@ -62,7 +63,7 @@ public:
   void setSumScores(bool score_sums){ sum_scores_=score_sums; }
 
   void setParams(double max_trans_vel, double max_scaling_factor, double scaling_speed);
-  void setFootprint(std::vector<geometry_msgs::Point> footprint_spec);
+  void setFootprint(const std::vector<geometry_msgs::Point>& footprint_spec);
 
   // helper functions, made static for easy unit testing
   static double getScalingFactor(Trajectory &traj, double scaling_speed, double max_trans_vel, double max_scaling_factor);
@@ -71,14 +72,16 @@ public:
       const double& y,
       const double& th,
       double scale,
-      std::vector<geometry_msgs::Point> footprint_spec,
+      const std::vector<geometry_msgs::Point>& footprint_spec,
       costmap_2d::Costmap2D* costmap,
-      base_local_planner::WorldModel* world_model);
+      base_local_planner::WorldModel* world_model,
+      const base_local_planner::FootprintTemplateCache* footprint_cache = NULL);
 
 private:
   costmap_2d::Costmap2D* costmap_;
   std::vector<geometry_msgs::Point> footprint_spec_;
   base_local_planner::WorldModel* world_model_;
+  base_local_planner::FootprintTemplateCache* footprint_cache_; // holds footprint_spec_ rasterized per heading
   double max_trans_vel_;
   bool sum_scores_;
   //footprint scaling with velocity;
@@ -0,0 +1,97 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#ifndef PLAN_PROGRESS_INDEX_H_
+#define PLAN_PROGRESS_INDEX_H_
+
+#include <vector>
+#include <utility>
+#include <base_local_planner/compact_plan.h>
+
+namespace base_local_planner {
+  /**
+   * @class PlanProgressIndex
+   * @brief Finds the pose of a plan closest to the robot without scanning the whole plan. Closest poses are looked up in a
+   * spatial hash of the poses, and the progress of the robot along the plan is followed with a cursor that only searches
+   * a window ahead of the pose found before.
+   */
+  class PlanProgressIndex {
+    public:
+      /**
+       * @param cell_size Side of the square cells the poses are hashed in
+       * @param lookahead Distance along the plan after the cursor searched by advance
+       * @param relocalize_distance If the pose found by advance is farther than this from the robot, the whole plan is searched
+       */
+      PlanProgressIndex(double cell_size = 0.5, double lookahead = 1.0, double relocalize_distance = 0.5);
+
+      /**
+       * @brief  Indexes a copy of plan and puts the cursor at its first pose
+       */
+      void setPlan(const CompactPlan& plan);
+
+      /**
+       * @brief  Whether plan is the one indexed, i.e. a copy of it with no poses changed since
+       */
+      bool indexes(const CompactPlan& plan) const { return revision_ != 0 && plan.revision() == revision_; }
+
+      const CompactPlan& plan() const { return plan_; }
+
+      /**
+       * @brief  Index of the pose closest to (x, y) in the whole plan, the last one on ties. 0 for an empty plan
+       */
+      size_t closest(double x, double y) const;
+
+      /**
+       * @brief  Moves the cursor to the pose closest to (x, y) within lookahead after it, or in the whole plan when that pose
+       * is farther than relocalize_distance. 0 for an empty plan
+       */
+      size_t advance(double x, double y);
+
+      size_t cursor() const { return cursor_; }
+
+    private:
+      long long cellKey(long cx, long cy) const;
+      double distanceSq(size_t i, double x, double y) const { double dx = plan_.x(i) - x, dy = plan_.y(i) - y; return dx * dx + dy * dy; }
+
+      double cell_size_, lookahead_, relocalize_distance_;
+      CompactPlan plan_;
+      unsigned long revision_;
+      std::vector<std::pair<long long, size_t> > cells_;    // (cell key, pose index), sorted
+      long min_cx_, min_cy_, max_cx_, max_cy_;              // Cells spanned by the poses
+      size_t cursor_;
+  };
+};
+#endif
@@ -46,7 +46,9 @@
 #include <base_local_planner/footprint_helper.h>
 
 #include <base_local_planner/world_model.h>
+#include <base_local_planner/footprint_template_cache.h>
 #include <base_local_planner/trajectory.h>
+#include <base_local_planner/plan_progress_index.h>
 #include <base_local_planner/Position2DInt.h>
 #include <base_local_planner/BaseLocalPlannerConfig.h>
 
@@ -205,7 +207,11 @@ namespace base_local_planner {
       bool getCellCosts(int cx, int cy, float &path_cost, float &goal_cost, float &occ_cost, float &total_cost);
 
       /** @brief Set the footprint specification of the robot. */
-      void setFootprint( std::vector<geometry_msgs::Point> footprint ) { footprint_spec_ = footprint; }
+      void setFootprint( std::vector<geometry_msgs::Point> footprint ) {
+        footprint_spec_ = footprint;
+        if(footprint_cache_ != NULL)
+          footprint_cache_->setFootprint(footprint_spec_);
+      }
 
       /** @brief Return the footprint specification of the robot. */
       geometry_msgs::Polygon getFootprintPolygon() const { return costmap_2d::toPolygon(footprint_spec_); }
@@ -264,10 +270,12 @@ namespace base_local_planner {
       MapGrid goal_map_; ///< @brief The local map grid where we propagate goal distance
       const costmap_2d::Costmap2D& costmap_; ///< @brief Provides access to cost map information
       WorldModel& world_model_; ///< @brief The world model that the controller uses for collision detection
+      FootprintTemplateCache* footprint_cache_; ///< @brief Rasterized footprint per heading, only used with a CostmapModel world model
 
       std::vector<geometry_msgs::Point> footprint_spec_; ///< @brief The footprint specification of the robot
 
       std::vector<geometry_msgs::PoseStamped> global_plan_; ///< @brief The global path for the robot to follow
+      PlanProgressIndex plan_index_; ///< @brief The global path as a CompactPlan, indexed for the closest pose lookups of headingDiff
 
       bool stuck_left, stuck_right; ///< @brief Booleans to keep the robot from oscillating during rotation
       bool rotating_left, rotating_right; ///< @brief Booleans to keep track of the direction of rotation for the robot
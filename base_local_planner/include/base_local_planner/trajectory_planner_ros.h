@@ -44,6 +44,7 @@
 #include <base_local_planner/world_model.h>
 #include <base_local_planner/point_grid.h>
 #include <base_local_planner/costmap_model.h>
+#include <base_local_planner/distance_field_model.h>
 #include <base_local_planner/voxel_grid_model.h>
 #include <base_local_planner/trajectory_planner.h>
 #include <base_local_planner/map_grid_visualizer.h>
@@ -194,6 +195,7 @@ namespace base_local_planner {
       }
 
       WorldModel* world_model_; ///< @brief The world model that the controller will use
+      DistanceFieldModel* distance_field_model_; ///< @brief Same object as world_model_ when the distance_field world model is used, NULL otherwise
       TrajectoryPlanner* tc_; ///< @brief The trajectory controller
 
       costmap_2d::Costmap2DROS* costmap_ros_; ///< @brief The ROS wrapper for the costmap the controller will use
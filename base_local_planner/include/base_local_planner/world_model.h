@@ -42,6 +42,7 @@
 #include <costmap_2d/footprint.h>
 #include <geometry_msgs/Point.h>
 #include <base_local_planner/planar_laser_scan.h>
+#include <base_local_planner/footprint_model.h>
 
 namespace base_local_planner {
   /**
@@ -85,6 +86,13 @@ namespace base_local_planner {
         return footprintCost(robot_position, oriented_footprint, inscribed_radius, circumscribed_radius);
       }
 
+      /**
+       * @brief  Checks the footprint of a model at a given position and orientation, with the radii precomputed in the model
+       */
+      double footprintCost(double x, double y, double theta, const FootprintModel& footprint_model){
+        return footprintCost(x, y, theta, footprint_model.getFootprint(), footprint_model.inscribedRadius(), footprint_model.circumscribedRadius());
+      }
+
       /**
        * @brief  Checks if any obstacles in the costmap lie inside a convex footprint that is rasterized into the grid
        * @param  position The position of the robot in world coordinates
@@ -0,0 +1,164 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#include <base_local_planner/compact_plan.h>
+#include <tf/transform_datatypes.h>
+#include <boost/atomic.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace base_local_planner {
+  namespace {
+    boost::atomic<unsigned long> last_revision(0);
+  }
+
+  CompactPlan::CompactPlan() : revision_(0) {}
+
+  CompactPlan::CompactPlan(const std::vector<geometry_msgs::PoseStamped>& poses) : revision_(0){
+    fromPoses(poses);
+  }
+
+  void CompactPlan::clear(){
+    revision_ = 0;
+    x_.clear();
+    y_.clear();
+    yaw_.clear();
+    arc_length_.clear();
+  }
+
+  void CompactPlan::reserve(size_t num_poses){
+    x_.reserve(num_poses);
+    y_.reserve(num_poses);
+    yaw_.reserve(num_poses);
+    arc_length_.reserve(num_poses);
+  }
+
+  void CompactPlan::push_back(double x, double y, double yaw){
+    revision_ = 0;
+    if(x_.empty())
+      arc_length_.push_back(0.0);
+    else
+      arc_length_.push_back(arc_length_.back() + hypot(x - x_.back(), y - y_.back()));
+    x_.push_back(x);
+    y_.push_back(y);
+    yaw_.push_back(yaw);
+  }
+
+  void CompactPlan::append(const CompactPlan& other, size_t begin, size_t end){
+    end = std::min(end, other.size());
+    if(begin >= end)
+      return;
+    revision_ = 0;
+    reserve(size() + end - begin);
+    // The arc length of the appended poses is the one in the other plan, shifted to continue this one
+    double offset = 0.0;
+    if(!x_.empty())
+      offset = arc_length_.back() + hypot(other.x_[begin] - x_.back(), other.y_[begin] - y_.back());
+    offset -= other.arc_length_[begin];
+    x_.insert(x_.end(), other.x_.begin() + begin, other.x_.begin() + end);
+    y_.insert(y_.end(), other.y_.begin() + begin, other.y_.begin() + end);
+    yaw_.insert(yaw_.end(), other.yaw_.begin() + begin, other.yaw_.begin() + end);
+    for(size_t i = begin; i < end; ++i)
+      arc_length_.push_back(other.arc_length_[i] + offset);
+  }
+
+  void CompactPlan::append(const CompactPlan& other){
+    append(other, 0, other.size());
+  }
+
+  void CompactPlan::truncate(size_t num_poses){
+    if(num_poses >= size())
+      return;
+    revision_ = 0;
+    x_.resize(num_poses);
+    y_.resize(num_poses);
+    yaw_.resize(num_poses);
+    arc_length_.resize(num_poses);
+  }
+
+  void CompactPlan::swap(CompactPlan& other){
+    x_.swap(other.x_);
+    y_.swap(other.y_);
+    yaw_.swap(other.yaw_);
+    arc_length_.swap(other.arc_length_);
+    std::swap(revision_, other.revision_);
+    frame_id_.swap(other.frame_id_);
+    std::swap(stamp_, other.stamp_);
+  }
+
+  size_t CompactPlan::indexAtArcLength(double s) const{
+    return std::lower_bound(arc_length_.begin(), arc_length_.end(), s) - arc_length_.begin();
+  }
+
+  unsigned long CompactPlan::revision() const{
+    if(revision_ == 0)
+      revision_ = ++last_revision;
+    return revision_;
+  }
+
+  geometry_msgs::PoseStamped CompactPlan::pose(size_t i) const{
+    geometry_msgs::PoseStamped pose;
+    pose.header.frame_id = frame_id_;
+    pose.header.stamp = stamp_;
+    pose.pose.position.x = x_[i];
+    pose.pose.position.y = y_[i];
+    pose.pose.orientation = tf::createQuaternionMsgFromYaw(yaw_[i]);
+    return pose;
+  }
+
+  void CompactPlan::fromPoses(const std::vector<geometry_msgs::PoseStamped>& poses){
+    clear();
+    if(!poses.empty()){
+      frame_id_ = poses[0].header.frame_id;
+      stamp_ = poses[0].header.stamp;
+    }
+    reserve(poses.size());
+    for(size_t i = 0; i < poses.size(); ++i)
+      push_back(poses[i].pose.position.x, poses[i].pose.position.y, tf::getYaw(poses[i].pose.orientation));
+  }
+
+  void CompactPlan::toPoses(std::vector<geometry_msgs::PoseStamped>& poses) const{
+    poses.resize(size());
+    for(size_t i = 0; i < size(); ++i)
+      poses[i] = pose(i);
+  }
+
+  void CompactPlan::toPath(nav_msgs::Path& path) const{
+    path.header.frame_id = frame_id_;
+    path.header.stamp = stamp_;
+    toPoses(path.poses);
+  }
+};
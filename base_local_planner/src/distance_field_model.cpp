@@ -0,0 +1,367 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#include <base_local_planner/distance_field_model.h>
+#include <costmap_2d/cost_values.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+using namespace costmap_2d;
+
+namespace base_local_planner {
+  const int DistanceFieldModel::NO_OBSTACLE;
+  const int DistanceFieldModel::MAX_SQ_DIST;
+
+  DistanceFieldModel::DistanceFieldModel(const Costmap2D& costmap, double max_cover_overshoot) :
+    costmap_(costmap), costmap_model_(costmap), max_cover_overshoot_(max_cover_overshoot), has_cover_(false),
+    size_x_(0), size_y_(0), resolution_(0.0), origin_x_(0.0), origin_y_(0.0)
+  {
+    update();
+  }
+
+  bool DistanceFieldModel::isObstacleCost(unsigned char cost) const {
+    //same cells as CostmapModel::pointCost
+    return cost == LETHAL_OBSTACLE || cost == NO_INFORMATION;
+  }
+
+  bool DistanceFieldModel::makeCover(const std::vector<geometry_msgs::Point>& rectangle, RectangleCover& cover) const {
+    //only rectangles are covered with circles
+    if(rectangle.size() != 4)
+      return false;
+    cover.x0 = rectangle[0].x;
+    cover.y0 = rectangle[0].y;
+    cover.ax = rectangle[1].x - rectangle[0].x;
+    cover.ay = rectangle[1].y - rectangle[0].y;
+    cover.bx = rectangle[2].x - rectangle[1].x;
+    cover.by = rectangle[2].y - rectangle[1].y;
+    double la = hypot(cover.ax, cover.ay), lb = hypot(cover.bx, cover.by);
+    double diag_x = rectangle[0].x + rectangle[2].x - rectangle[1].x - rectangle[3].x;
+    double diag_y = rectangle[0].y + rectangle[2].y - rectangle[1].y - rectangle[3].y;
+    if(la <= 0.0 || lb <= 0.0 || std::abs(cover.ax * cover.bx + cover.ay * cover.by) > 1e-6 * la * lb || hypot(diag_x, diag_y) > 1e-6 * (la + lb))
+      return false;
+
+    //a grid of equal circles, each circumscribing one of n_a x n_b tiles. The tiles are refined
+    //until no circle sticks out of its tile by more than the overshoot
+    double overshoot = max_cover_overshoot_ > 0.0 ? max_cover_overshoot_ : resolution_;
+    double max_tile = 2.0 * overshoot / (M_SQRT2 - 1.0);
+    cover.n_a = std::max(1, (int) ceil(la / max_tile));
+    cover.n_b = std::max(1, (int) ceil(lb / max_tile));
+    double tile_a = la / cover.n_a, tile_b = lb / cover.n_b;
+    while(hypot(tile_a, tile_b) > std::min(tile_a, tile_b) + 2.0 * overshoot){
+      if(tile_a > tile_b)
+        tile_a = la / ++cover.n_a;
+      else
+        tile_b = lb / ++cover.n_b;
+    }
+    cover.radius = 0.5 * hypot(tile_a, tile_b);
+    cover.inscribed_radius = 0.5 * std::min(la, lb);
+    cover.circumscribed_radius = 0.5 * hypot(la, lb);
+    return true;
+  }
+
+  void DistanceFieldModel::distanceBounds(double wx, double wy, double& lower, double& upper) const {
+    //the distance at the cell of a point is off by at most the distance to the cell center,
+    //and an obstacle cell reaches half a diagonal closer than its center
+    int mx = (int) floor((wx - origin_x_) / resolution_);
+    int my = (int) floor((wy - origin_y_) / resolution_);
+    double dist = sqrt((double) sq_dist_[my * size_x_ + mx]) * resolution_;
+    double slack = hypot(wx - (origin_x_ + (mx + 0.5) * resolution_), wy - (origin_y_ + (my + 0.5) * resolution_))
+                   + resolution_ * M_SQRT1_2;
+    lower = dist - slack;
+    upper = dist + slack;
+  }
+
+  double DistanceFieldModel::coverCost(const RectangleCover& cover, double x, double y, double cos_th, double sin_th) const {
+    //like the costmap model, a footprint that leaves the map is illegal. Then the whole rectangle is inside
+    double corners[4][2] = {{0.0, 0.0}, {cover.ax, cover.ay}, {cover.ax + cover.bx, cover.ay + cover.by}, {cover.bx, cover.by}};
+    for(int i = 0; i < 4; ++i){
+      double px = cover.x0 + corners[i][0], py = cover.y0 + corners[i][1];
+      int mx = (int) floor((x + px * cos_th - py * sin_th - origin_x_) / resolution_);
+      int my = (int) floor((y + px * sin_th + py * cos_th - origin_y_) / resolution_);
+      if(mx < 0 || my < 0 || mx >= (int) size_x_ || my >= (int) size_y_)
+        return -1.0;
+    }
+
+    //most poses are far from obstacles, one lookup with the circumscribed circle
+    double lower, upper;
+    double px = cover.x0 + 0.5 * (cover.ax + cover.bx), py = cover.y0 + 0.5 * (cover.ay + cover.by);
+    distanceBounds(x + px * cos_th - py * sin_th, y + px * sin_th + py * cos_th, lower, upper);
+    if(lower >= cover.circumscribed_radius)
+      return 0.0;
+    //an obstacle cell entirely inside the inscribed circle
+    if(upper < cover.inscribed_radius)
+      return -1.0;
+
+    for(int i = 0; i < cover.n_a; ++i){
+      double fa = (i + 0.5) / cover.n_a;
+      for(int j = 0; j < cover.n_b; ++j){
+        double fb = (j + 0.5) / cover.n_b;
+        px = cover.x0 + fa * cover.ax + fb * cover.bx;
+        py = cover.y0 + fa * cover.ay + fb * cover.by;
+        distanceBounds(x + px * cos_th - py * sin_th, y + px * sin_th + py * cos_th, lower, upper);
+        if(lower < cover.radius)
+          return -1.0;
+      }
+    }
+    return 0.0;
+  }
+
+  bool DistanceFieldModel::geometryMatchesCostmap() const {
+    //update has not been called after a resize
+    return size_x_ == costmap_.getSizeInCellsX() && size_y_ == costmap_.getSizeInCellsY() && resolution_ == costmap_.getResolution();
+  }
+
+  double DistanceFieldModel::footprintCost(const geometry_msgs::Point& position, const std::vector<geometry_msgs::Point>& footprint,
+      double inscribed_radius, double circumscribed_radius){
+    RectangleCover cover;
+    if(!geometryMatchesCostmap() || !makeCover(footprint, cover))
+      return costmap_model_.footprintCost(position, footprint, inscribed_radius, circumscribed_radius);
+    return coverCost(cover, 0.0, 0.0, 1.0, 0.0);
+  }
+
+  bool DistanceFieldModel::setFootprint(const std::vector<geometry_msgs::Point>& footprint_spec){
+    bool same_footprint = footprint_spec.size() == footprint_spec_.size();
+    for(unsigned int i = 0; same_footprint && i < footprint_spec.size(); ++i)
+      same_footprint = footprint_spec[i].x == footprint_spec_[i].x && footprint_spec[i].y == footprint_spec_[i].y;
+    if(same_footprint)
+      return false;
+
+    footprint_spec_ = footprint_spec;
+    has_cover_ = makeCover(footprint_spec_, cover_);
+    return true;
+  }
+
+  double DistanceFieldModel::footprintCost(double x, double y, double theta) const {
+    if(!has_cover_ || !geometryMatchesCostmap())
+      return costmap_model_.footprintCost(x, y, theta, footprint_spec_);
+    return coverCost(cover_, x, y, cos(theta), sin(theta));
+  }
+
+  double DistanceFieldModel::distance(unsigned int x, unsigned int y) const {
+    unsigned int index = y * size_x_ + x;
+    if(x >= size_x_ || y >= size_y_ || closest_obstacle_[index] == NO_OBSTACLE)
+      return -1.0;
+    return sqrt((double) sq_dist_[index]) * resolution_;
+  }
+
+  double DistanceFieldModel::clearance(double x, double y) const {
+    if(!geometryMatchesCostmap())
+      return 0.0;
+    //the map bounds count as obstacles, the costmap model rejects footprints that leave the map
+    double border = std::min(std::min(x - origin_x_, origin_x_ + size_x_ * resolution_ - x),
+                             std::min(y - origin_y_, origin_y_ + size_y_ * resolution_ - y));
+    if(border <= 0.0)
+      return border;
+    double lower, upper;
+    distanceBounds(x, y, lower, upper);
+    return std::min(border, lower);
+  }
+
+  bool DistanceFieldModel::update(){
+    bool compare_all = true;
+    if(size_x_ != costmap_.getSizeInCellsX() || size_y_ != costmap_.getSizeInCellsY() || resolution_ != costmap_.getResolution())
+      reset();
+    else if(origin_x_ != costmap_.getOriginX() || origin_y_ != costmap_.getOriginY()){
+      //a rolling window costmap moves by whole cells
+      double dx = (costmap_.getOriginX() - origin_x_) / resolution_;
+      double dy = (costmap_.getOriginY() - origin_y_) / resolution_;
+      int cells_dx = (int) floor(dx + 0.5), cells_dy = (int) floor(dy + 0.5);
+      if(std::abs(dx - cells_dx) > 1e-3 || std::abs(dy - cells_dy) > 1e-3)
+        reset();
+      else
+        shift(cells_dx, cells_dy);
+    }
+    else
+      compare_all = false;
+
+    //rows equal to the last update are skipped with a memcmp
+    bool changed = false;
+    const unsigned char* charmap = costmap_.getCharMap();
+    for(unsigned int y = 0; y < size_y_; ++y){
+      const unsigned char* row = charmap + y * size_x_;
+      unsigned char* last_row = &last_costs_[y * size_x_];
+      if(!compare_all && memcmp(row, last_row, size_x_) == 0)
+        continue;
+      for(unsigned int x = 0; x < size_x_; ++x){
+        unsigned int index = y * size_x_ + x;
+        unsigned char occupied = isObstacleCost(row[x]) ? 1 : 0;
+        if(occupied == occupied_[index])
+          continue;
+        occupied_[index] = occupied;
+        if(occupied)
+          setObstacle(index);
+        else
+          removeObstacle(index);
+        changed = true;
+      }
+      memcpy(last_row, row, size_x_);
+    }
+    propagate();
+    return changed;
+  }
+
+  void DistanceFieldModel::reset(){
+    size_x_ = costmap_.getSizeInCellsX();
+    size_y_ = costmap_.getSizeInCellsY();
+    resolution_ = costmap_.getResolution();
+    origin_x_ = costmap_.getOriginX();
+    origin_y_ = costmap_.getOriginY();
+    unsigned int num_cells = size_x_ * size_y_;
+    occupied_.assign(num_cells, 0);
+    last_costs_.assign(num_cells, FREE_SPACE);
+    sq_dist_.assign(num_cells, MAX_SQ_DIST);
+    closest_obstacle_.assign(num_cells, NO_OBSTACLE);
+    to_raise_.assign(num_cells, 0);
+    open_ = std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> >();
+    //the circles depend on the resolution
+    has_cover_ = makeCover(footprint_spec_, cover_);
+  }
+
+  void DistanceFieldModel::shift(int dx, int dy){
+    //cell (x, y) of the moved costmap is cell (x + dx, y + dy) of the old one
+    std::vector<unsigned char> occupied(size_x_ * size_y_, 0);
+    std::vector<int> sq_dist(size_x_ * size_y_, MAX_SQ_DIST);
+    std::vector<int> closest_obstacle(size_x_ * size_y_, NO_OBSTACLE);
+    int cells_x = (int) size_x_, cells_y = (int) size_y_;
+    int min_x = std::max(0, -dx), max_x = std::min(cells_x, cells_x - dx);
+    int min_y = std::max(0, -dy), max_y = std::min(cells_y, cells_y - dy);
+
+    origin_x_ = costmap_.getOriginX();
+    origin_y_ = costmap_.getOriginY();
+    for(int y = min_y; y < max_y; ++y){
+      for(int x = min_x; x < max_x; ++x){
+        unsigned int old_index = (y + dy) * size_x_ + (x + dx);
+        unsigned int index = y * size_x_ + x;
+        occupied[index] = occupied_[old_index];
+        if(closest_obstacle_[old_index] == NO_OBSTACLE)
+          continue;
+        int obstacle_x = closest_obstacle_[old_index] % cells_x - dx;
+        int obstacle_y = closest_obstacle_[old_index] / cells_x - dy;
+        sq_dist[index] = sq_dist_[old_index];
+        if(obstacle_x >= 0 && obstacle_y >= 0 && obstacle_x < cells_x && obstacle_y < cells_y)
+          closest_obstacle[index] = obstacle_y * cells_x + obstacle_x;
+      }
+    }
+    occupied_.swap(occupied);
+    sq_dist_.swap(sq_dist);
+    closest_obstacle_.swap(closest_obstacle);
+
+    for(int y = min_y; y < max_y; ++y){
+      for(int x = min_x; x < max_x; ++x){
+        unsigned int index = y * size_x_ + x;
+        if(closest_obstacle_[index] == NO_OBSTACLE){
+          //the closest obstacle left the costmap, clear the cell like for a removed obstacle
+          if(sq_dist_[index] != MAX_SQ_DIST){
+            open_.push(QueueEntry(sq_dist_[index], index));
+            to_raise_[index] = 1;
+            sq_dist_[index] = MAX_SQ_DIST;
+          }
+        }
+        else if(x == min_x || x == max_x - 1 || y == min_y || y == max_y - 1){
+          //the border of the kept cells propagates into the uncovered ones
+          open_.push(QueueEntry(sq_dist_[index], index));
+        }
+      }
+    }
+  }
+
+  void DistanceFieldModel::setObstacle(unsigned int index){
+    sq_dist_[index] = 0;
+    closest_obstacle_[index] = index;
+    to_raise_[index] = 0;
+    open_.push(QueueEntry(0, index));
+  }
+
+  void DistanceFieldModel::removeObstacle(unsigned int index){
+    sq_dist_[index] = MAX_SQ_DIST;
+    closest_obstacle_[index] = NO_OBSTACLE;
+    to_raise_[index] = 1;
+    open_.push(QueueEntry(0, index));
+  }
+
+  void DistanceFieldModel::propagate(){
+    //dynamic brushfire: raise waves clear the cells whose closest obstacle was removed, lower waves
+    //hand the closest obstacle on to the neighbors, both in order of increasing distance
+    while(!open_.empty()){
+      QueueEntry entry = open_.top();
+      open_.pop();
+      unsigned int index = entry.second;
+      if(to_raise_[index])
+        raise(index);
+      else if(closest_obstacle_[index] != NO_OBSTACLE && occupied_[closest_obstacle_[index]] && entry.first == sq_dist_[index])
+        lower(index);
+    }
+  }
+
+  void DistanceFieldModel::raise(unsigned int index){
+    int x = index % size_x_, y = index / size_x_;
+    for(int ny = std::max(0, y - 1); ny <= std::min((int) size_y_ - 1, y + 1); ++ny){
+      for(int nx = std::max(0, x - 1); nx <= std::min((int) size_x_ - 1, x + 1); ++nx){
+        unsigned int n = ny * size_x_ + nx;
+        if(closest_obstacle_[n] == NO_OBSTACLE || to_raise_[n])
+          continue;
+        open_.push(QueueEntry(sq_dist_[n], n));
+        if(!occupied_[closest_obstacle_[n]]){
+          to_raise_[n] = 1;
+          closest_obstacle_[n] = NO_OBSTACLE;
+          sq_dist_[n] = MAX_SQ_DIST;
+        }
+      }
+    }
+    to_raise_[index] = 0;
+  }
+
+  void DistanceFieldModel::lower(unsigned int index){
+    int x = index % size_x_, y = index / size_x_;
+    int obstacle = closest_obstacle_[index];
+    int obstacle_x = obstacle % size_x_, obstacle_y = obstacle / size_x_;
+    for(int ny = std::max(0, y - 1); ny <= std::min((int) size_y_ - 1, y + 1); ++ny){
+      for(int nx = std::max(0, x - 1); nx <= std::min((int) size_x_ - 1, x + 1); ++nx){
+        unsigned int n = ny * size_x_ + nx;
+        if(to_raise_[n])
+          continue;
+        int sq_dist = (nx - obstacle_x) * (nx - obstacle_x) + (ny - obstacle_y) * (ny - obstacle_y);
+        if(sq_dist < sq_dist_[n]){
+          sq_dist_[n] = sq_dist;
+          closest_obstacle_[n] = obstacle;
+          open_.push(QueueEntry(sq_dist, n));
+        }
+      }
+    }
+  }
+};
@@ -0,0 +1,164 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#include <base_local_planner/footprint_model.h>
+#include <base_local_planner/line_iterator.h>
+#include <costmap_2d/footprint.h>
+#include <boost/atomic.hpp>
+#include <algorithm>
+
+namespace base_local_planner {
+  namespace {
+    boost::atomic<unsigned long> last_model_version(0);
+  }
+
+  FootprintModel::FootprintModel(const std::vector<geometry_msgs::Point>& footprint_spec, double resolution, unsigned int num_heading_bins)
+    : footprint_spec_(footprint_spec), inscribed_radius_(0.0), circumscribed_radius_(0.0),
+      version_(last_model_version.fetch_add(1, boost::memory_order_relaxed) + 1), four_corners_(false),
+      resolution_(resolution), num_heading_bins_(std::max(num_heading_bins, 1u)) {
+    if(!footprint_spec_.empty())
+      costmap_2d::calculateMinAndMaxDistances(footprint_spec_, inscribed_radius_, circumscribed_radius_);
+
+    //one point in each quadrant, the heading of the robot is towards the x axis
+    if(footprint_spec_.size() == 4){
+      bool front_left = false, front_right = false, rear_left = false, rear_right = false;
+      for(unsigned int i = 0; i < footprint_spec_.size(); ++i){
+        const geometry_msgs::Point& pt = footprint_spec_[i];
+        if(pt.x > 0 && pt.y > 0){
+          front_left = true;
+          front_left_ = pt;
+        }
+        else if(pt.x > 0 && pt.y < 0){
+          front_right = true;
+          front_right_ = pt;
+        }
+        else if(pt.x < 0 && pt.y < 0){
+          rear_right = true;
+          rear_right_ = pt;
+        }
+        else if(pt.x < 0 && pt.y > 0){
+          rear_left = true;
+          rear_left_ = pt;
+        }
+      }
+      four_corners_ = front_left && front_right && rear_left && rear_right;
+    }
+
+    if(resolution_ <= 0.0 || !hasFootprint())
+      return;
+
+    templates_.resize(num_heading_bins_);
+    for(unsigned int i = 0; i < num_heading_bins_; ++i)
+      buildTemplate(2.0 * M_PI * i / num_heading_bins_, templates_[i]);
+  }
+
+  bool FootprintModel::sameFootprint(const std::vector<geometry_msgs::Point>& footprint_spec) const {
+    if(footprint_spec.size() != footprint_spec_.size())
+      return false;
+    for(unsigned int i = 0; i < footprint_spec.size(); ++i)
+      if(footprint_spec[i].x != footprint_spec_[i].x || footprint_spec[i].y != footprint_spec_[i].y)
+        return false;
+    return true;
+  }
+
+  bool FootprintModel::hasTemplates(double resolution, unsigned int num_heading_bins) const {
+    return !templates_.empty() && resolution_ == resolution && num_heading_bins_ == num_heading_bins;
+  }
+
+  void FootprintModel::buildTemplate(double theta, HeadingTemplate& heading_template) const {
+    double cos_th = cos(theta);
+    double sin_th = sin(theta);
+
+    //the corners are placed relative to the center of the cell holding the robot center
+    std::vector<CellOffset> corners(footprint_spec_.size());
+    for(unsigned int i = 0; i < footprint_spec_.size(); ++i){
+      double x = footprint_spec_[i].x * cos_th - footprint_spec_[i].y * sin_th;
+      double y = footprint_spec_[i].x * sin_th + footprint_spec_[i].y * cos_th;
+      corners[i].dx = (int) floor(0.5 + x / resolution_);
+      corners[i].dy = (int) floor(0.5 + y / resolution_);
+    }
+
+    //rasterize each line in the footprint, including the one from the last point back to the first
+    std::vector<CellOffset>& cells = heading_template.cells;
+    cells.clear();
+    for(unsigned int i = 0; i < corners.size(); ++i){
+      const CellOffset& c0 = corners[i];
+      const CellOffset& c1 = corners[(i + 1) % corners.size()];
+      for(LineIterator line(c0.dx, c0.dy, c1.dx, c1.dy); line.isValid(); line.advance()){
+        CellOffset cell;
+        cell.dx = line.getX();
+        cell.dy = line.getY();
+        cells.push_back(cell);
+      }
+    }
+
+    //sorted by row so the gather walks the char array forward
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+    heading_template.min_dx = heading_template.max_dx = cells.front().dx;
+    heading_template.min_dy = cells.front().dy;
+    heading_template.max_dy = cells.back().dy;
+    for(unsigned int i = 1; i < cells.size(); ++i){
+      heading_template.min_dx = std::min(heading_template.min_dx, cells[i].dx);
+      heading_template.max_dx = std::max(heading_template.max_dx, cells[i].dx);
+    }
+  }
+
+  SharedFootprintModel::SharedFootprintModel(unsigned int num_heading_bins) : num_heading_bins_(num_heading_bins) {}
+
+  FootprintModelConstPtr SharedFootprintModel::get() const {
+    boost::mutex::scoped_lock lock(mutex_);
+    return model_;
+  }
+
+  bool SharedFootprintModel::set(const std::vector<geometry_msgs::Point>& footprint_spec, double resolution){
+    FootprintModelConstPtr current = get();
+    if(current && current->sameFootprint(footprint_spec) && current->resolution() == resolution &&
+       current->numHeadingBins() == std::max(num_heading_bins_, 1u))
+      return false;
+
+    //built outside the lock, readers keep using the current model meanwhile
+    FootprintModelConstPtr model(new FootprintModel(footprint_spec, resolution, num_heading_bins_));
+    set(model);
+    return true;
+  }
+
+  void SharedFootprintModel::set(const FootprintModelConstPtr& model){
+    boost::mutex::scoped_lock lock(mutex_);
+    model_ = model;
+  }
+};
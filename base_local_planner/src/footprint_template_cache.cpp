@@ -0,0 +1,103 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#include <base_local_planner/footprint_template_cache.h>
+#include <costmap_2d/cost_values.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace costmap_2d;
+
+namespace base_local_planner {
+  FootprintTemplateCache::FootprintTemplateCache(const costmap_2d::Costmap2D& costmap, unsigned int num_heading_bins)
+    : costmap_(costmap), exact_model_(costmap), num_heading_bins_(std::max(num_heading_bins, 1u)) {}
+
+  bool FootprintTemplateCache::setFootprint(const std::vector<geometry_msgs::Point>& footprint_spec){
+    if(model_ && model_->sameFootprint(footprint_spec) && model_->resolution() == costmap_.getResolution())
+      return false;
+
+    model_.reset(new FootprintModel(footprint_spec, costmap_.getResolution(), num_heading_bins_));
+    return true;
+  }
+
+  bool FootprintTemplateCache::setFootprintModel(const FootprintModelConstPtr& model){
+    if(!model)
+      return setFootprint(std::vector<geometry_msgs::Point>());
+
+    //a model for another grid is rebuilt for this one, the same footprint on the same grid is not rebuilt either
+    if(!model->hasTemplates(costmap_.getResolution(), num_heading_bins_) && model->hasFootprint())
+      return setFootprint(model->getFootprint());
+
+    if(model_ == model)
+      return false;
+    model_ = model;
+    return true;
+  }
+
+  double FootprintTemplateCache::footprintCost(double x, double y, double theta) const {
+    //get the cell coord of the center point of the robot
+    unsigned int cell_x, cell_y;
+    if(!costmap_.worldToMap(x, y, cell_x, cell_y))
+      return -1.0;
+
+    //the circular robot case is left to the costmap model
+    if(!hasFootprint())
+      return exact_model_.footprintCost(x, y, theta, model_ ? model_->getFootprint() : std::vector<geometry_msgs::Point>());
+
+    const FootprintModel::HeadingTemplate& heading_template = model_->headingTemplate(theta);
+    int size_x = costmap_.getSizeInCellsX();
+    int size_y = costmap_.getSizeInCellsY();
+
+    //near the map bounds the exact check tells which corners fall off the map
+    if((int) cell_x + heading_template.min_dx < 0 || (int) cell_x + heading_template.max_dx >= size_x ||
+       (int) cell_y + heading_template.min_dy < 0 || (int) cell_y + heading_template.max_dy >= size_y)
+      return exact_model_.footprintCost(x, y, theta, model_->getFootprint(), model_->inscribedRadius(), model_->circumscribedRadius());
+
+    const unsigned char* charmap = costmap_.getCharMap();
+    int center_index = costmap_.getIndex(cell_x, cell_y);
+    double footprint_cost = 0.0;
+    for(std::vector<FootprintModel::CellOffset>::const_iterator cell = heading_template.cells.begin(); cell != heading_template.cells.end(); ++cell){
+      unsigned char cost = charmap[center_index + cell->dy * size_x + cell->dx];
+      if(cost == LETHAL_OBSTACLE || cost == NO_INFORMATION)
+        return -1.0;
+
+      if(footprint_cost < cost)
+        footprint_cost = cost;
+    }
+
+    return footprint_cost;
+  }
+};
@@ -135,16 +135,31 @@ namespace base_local_planner{
     if (global_plan_in.size() == 0) {
       return;
     }
-    double last_x = global_plan_in[0].pose.position.x;
-    double last_y = global_plan_in[0].pose.position.y;
-    global_plan_out.push_back(global_plan_in[0]);
+    //the poses are densified as a compact plan, they come back with its frame and stamp
+    CompactPlan adjusted_plan;
+    adjustPlanResolution(CompactPlan(global_plan_in), adjusted_plan, resolution);
+    std::vector<geometry_msgs::PoseStamped> adjusted_poses;
+    adjusted_plan.toPoses(adjusted_poses);
+    global_plan_out.insert(global_plan_out.end(), adjusted_poses.begin(), adjusted_poses.end());
+  }
+
+  void MapGrid::adjustPlanResolution(const CompactPlan& global_plan_in, CompactPlan& global_plan_out, double resolution) {
+    if (global_plan_in.size() == 0) {
+      return;
+    }
+    double last_x = global_plan_in.x(0);
+    double last_y = global_plan_in.y(0);
+    global_plan_out.setFrameId(global_plan_in.frameId());
+    global_plan_out.setStamp(global_plan_in.stamp());
+    global_plan_out.reserve(global_plan_out.size() + global_plan_in.size());
+    global_plan_out.push_back(last_x, last_y, global_plan_in.yaw(0));
 
     // we can take "holes" in the plan smaller than 2 grid cells (squared = 4)
     double min_sq_resolution = resolution * resolution * 4;
 
     for (unsigned int i = 1; i < global_plan_in.size(); ++i) {
-      double loop_x = global_plan_in[i].pose.position.x;
-      double loop_y = global_plan_in[i].pose.position.y;
+      double loop_x = global_plan_in.x(i);
+      double loop_y = global_plan_in.y(i);
       double sqdist = (loop_x - last_x) * (loop_x - last_x) + (loop_y - last_y) * (loop_y - last_y);
       if (sqdist > min_sq_resolution) {
         int steps = ((sqrt(sqdist) - sqrt(min_sq_resolution)) / resolution) - 1;
@@ -153,31 +168,35 @@ namespace base_local_planner{
         double deltay = (loop_y - last_y) / steps;
         // TODO: Interpolate orientation
         for (int j = 1; j < steps; ++j) {
-          geometry_msgs::PoseStamped pose;
-          pose.pose.position.x = last_x + j * deltax;
-          pose.pose.position.y = last_y + j * deltay;
-          pose.pose.position.z = global_plan_in[i].pose.position.z;
-          pose.pose.orientation = global_plan_in[i].pose.orientation;
-          pose.header = global_plan_in[i].header;
-          global_plan_out.push_back(pose);
+          global_plan_out.push_back(last_x + j * deltax, last_y + j * deltay, global_plan_in.yaw(i));
         }
       }
-      global_plan_out.push_back(global_plan_in[i]);
+      global_plan_out.push_back(loop_x, loop_y, global_plan_in.yaw(i));
       last_x = loop_x;
       last_y = loop_y;
     }
   }
 
-  //update what map cells are considered path based on the global_plan
   void MapGrid::setTargetCells(const costmap_2d::Costmap2D& costmap,
       const std::vector<geometry_msgs::PoseStamped>& global_plan) {
+    setTargetCells(costmap, CompactPlan(global_plan));
+  }
+
+  void MapGrid::setLocalGoal(const costmap_2d::Costmap2D& costmap,
+      const std::vector<geometry_msgs::PoseStamped>& global_plan) {
+    setLocalGoal(costmap, CompactPlan(global_plan));
+  }
+
+  //update what map cells are considered path based on the global_plan
+  void MapGrid::setTargetCells(const costmap_2d::Costmap2D& costmap,
+      const CompactPlan& global_plan) {
     sizeCheck(costmap.getSizeInCellsX(), costmap.getSizeInCellsY());
 
     bool started_path = false;
 
     queue<MapCell*> path_dist_queue;
 
-    std::vector<geometry_msgs::PoseStamped> adjusted_global_plan;
+    CompactPlan adjusted_global_plan;
     adjustPlanResolution(global_plan, adjusted_global_plan, costmap.getResolution());
     if (adjusted_global_plan.size() != global_plan.size()) {
       ROS_DEBUG("Adjusted global plan resolution, added %zu points", adjusted_global_plan.size() - global_plan.size());
@@ -185,8 +204,8 @@ namespace base_local_planner{
     unsigned int i;
     // put global path points into local map until we reach the border of the local map
     for (i = 0; i < adjusted_global_plan.size(); ++i) {
-      double g_x = adjusted_global_plan[i].pose.position.x;
-      double g_y = adjusted_global_plan[i].pose.position.y;
+      double g_x = adjusted_global_plan.x(i);
+      double g_y = adjusted_global_plan.y(i);
       unsigned int map_x, map_y;
       if (costmap.worldToMap(g_x, g_y, map_x, map_y) && costmap.getCost(map_x, map_y) != costmap_2d::NO_INFORMATION) {
         MapCell& current = getCell(map_x, map_y);
@@ -209,20 +228,20 @@ namespace base_local_planner{
 
   //mark the point of the costmap as local goal where global_plan first leaves the area (or its last point)
   void MapGrid::setLocalGoal(const costmap_2d::Costmap2D& costmap,
-      const std::vector<geometry_msgs::PoseStamped>& global_plan) {
+      const CompactPlan& global_plan) {
     sizeCheck(costmap.getSizeInCellsX(), costmap.getSizeInCellsY());
 
     int local_goal_x = -1;
     int local_goal_y = -1;
     bool started_path = false;
 
-    std::vector<geometry_msgs::PoseStamped> adjusted_global_plan;
+    CompactPlan adjusted_global_plan;
     adjustPlanResolution(global_plan, adjusted_global_plan, costmap.getResolution());
 
     // skip global path points until we reach the border of the local map
     for (unsigned int i = 0; i < adjusted_global_plan.size(); ++i) {
-      double g_x = adjusted_global_plan[i].pose.position.x;
-      double g_y = adjusted_global_plan[i].pose.position.y;
+      double g_x = adjusted_global_plan.x(i);
+      double g_y = adjusted_global_plan.y(i);
       unsigned int map_x, map_y;
       if (costmap.worldToMap(g_x, g_y, map_x, map_y) && costmap.getCost(map_x, map_y) != costmap_2d::NO_INFORMATION) {
         local_goal_x = map_x;
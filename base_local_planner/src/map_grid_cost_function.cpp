@@ -54,7 +54,11 @@ MapGridCostFunction::MapGridCostFunction(costmap_2d::Costmap2D* costmap,
     stop_on_failure_(true),
     path_distance_max_(path_distance_max) {}
 
-void MapGridCostFunction::setTargetPoses(std::vector<geometry_msgs::PoseStamped> target_poses) {
+void MapGridCostFunction::setTargetPoses(const std::vector<geometry_msgs::PoseStamped>& target_poses) {
+  target_poses_.fromPoses(target_poses);
+}
+
+void MapGridCostFunction::setTargetPoses(const CompactPlan& target_poses) {
   target_poses_ = target_poses;
 }
 
@@ -43,9 +43,10 @@
 namespace base_local_planner {
 
 ObstacleCostFunction::ObstacleCostFunction(costmap_2d::Costmap2D* costmap) 
-    : costmap_(costmap), sum_scores_(false) {
+    : costmap_(costmap), footprint_cache_(NULL), sum_scores_(false) {
   if (costmap != NULL) {
     world_model_ = new base_local_planner::CostmapModel(*costmap_);
+    footprint_cache_ = new base_local_planner::FootprintTemplateCache(*costmap_);
   }
 }
 
@@ -53,6 +54,7 @@ ObstacleCostFunction::~ObstacleCostFunction() {
   if (world_model_ != NULL) {
     delete world_model_;
   }
+  delete footprint_cache_;
 }
 
 
@@ -63,8 +65,12 @@ void ObstacleCostFunction::setParams(double max_trans_vel, double max_scaling_fa
   scaling_speed_ = scaling_speed;
 }
 
-void ObstacleCostFunction::setFootprint(std::vector<geometry_msgs::Point> footprint_spec) {
+void ObstacleCostFunction::setFootprint(const std::vector<geometry_msgs::Point>& footprint_spec) {
   footprint_spec_ = footprint_spec;
+  //only rebuilds the templates when the footprint changed
+  if (footprint_cache_ != NULL) {
+    footprint_cache_->setFootprint(footprint_spec_);
+  }
 }
 
 bool ObstacleCostFunction::prepare() {
@@ -85,7 +91,7 @@ double ObstacleCostFunction::scoreTrajectory(Trajectory &traj) {
     traj.getPoint(i, px, py, pth);
     double f_cost = footprintCost(px, py, pth,
         scale, footprint_spec_,
-        costmap_, world_model_);
+        costmap_, world_model_, footprint_cache_);
 
     if(f_cost < 0){
         return f_cost;
@@ -118,13 +124,19 @@ double ObstacleCostFunction::footprintCost (
     const double& y,
     const double& th,
     double scale,
-    std::vector<geometry_msgs::Point> footprint_spec,
+    const std::vector<geometry_msgs::Point>& footprint_spec,
     costmap_2d::Costmap2D* costmap,
-    base_local_planner::WorldModel* world_model) {
+    base_local_planner::WorldModel* world_model,
+    const base_local_planner::FootprintTemplateCache* footprint_cache) {
 
   //check if the footprint is legal
   // TODO: Cache inscribed radius
-  double footprint_cost = world_model->footprintCost(x, y, th, footprint_spec);
+  double footprint_cost;
+  if (footprint_cache != NULL && footprint_cache->hasFootprint()) {
+    footprint_cost = footprint_cache->footprintCost(x, y, th);
+  } else {
+    footprint_cost = world_model->footprintCost(x, y, th, footprint_spec);
+  }
 
   if (footprint_cost < 0) {
     return -6.0;
@@ -0,0 +1,129 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#include <base_local_planner/plan_progress_index.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace base_local_planner {
+  PlanProgressIndex::PlanProgressIndex(double cell_size, double lookahead, double relocalize_distance)
+    : cell_size_(cell_size), lookahead_(lookahead), relocalize_distance_(relocalize_distance), revision_(0),
+      min_cx_(0), min_cy_(0), max_cx_(0), max_cy_(0), cursor_(0) {}
+
+  long long PlanProgressIndex::cellKey(long cx, long cy) const{
+    return (long long)(((unsigned long long)(unsigned int)cx << 32) | (unsigned int)cy);
+  }
+
+  void PlanProgressIndex::setPlan(const CompactPlan& plan){
+    revision_ = plan.revision();
+    plan_ = plan;
+    cursor_ = 0;
+
+    cells_.clear();
+    cells_.reserve(plan_.size());
+    for(size_t i = 0; i < plan_.size(); ++i){
+      long cx = (long)floor(plan_.x(i) / cell_size_);
+      long cy = (long)floor(plan_.y(i) / cell_size_);
+      if(i == 0 || cx < min_cx_) min_cx_ = cx;
+      if(i == 0 || cy < min_cy_) min_cy_ = cy;
+      if(i == 0 || cx > max_cx_) max_cx_ = cx;
+      if(i == 0 || cy > max_cy_) max_cy_ = cy;
+      cells_.push_back(std::make_pair(cellKey(cx, cy), i));
+    }
+    std::sort(cells_.begin(), cells_.end());
+  }
+
+  size_t PlanProgressIndex::closest(double x, double y) const{
+    if(plan_.empty())
+      return 0;
+
+    long cx = (long)floor(x / cell_size_);
+    long cy = (long)floor(y / cell_size_);
+    //rings of cells around the one of (x, y), beyond this one there are no poses
+    long max_ring = std::max(std::max(std::abs(cx - min_cx_), std::abs(max_cx_ - cx)),
+                             std::max(std::abs(cy - min_cy_), std::abs(max_cy_ - cy)));
+
+    size_t best = 0;
+    double best_dist_sq = std::numeric_limits<double>::infinity();
+    for(long ring = 0; ring <= max_ring; ++ring){
+      //every pose in this ring is at least (ring - 1) cells away
+      double ring_dist = std::max(ring - 1, 0L) * cell_size_;
+      if(best_dist_sq < ring_dist * ring_dist)
+        break;
+      for(long dy = -ring; dy <= ring; ++dy){
+        //the whole row on the top and bottom of the ring, only its ends in between
+        long step = (dy == -ring || dy == ring) ? 1 : std::max(2 * ring, 1L);
+        for(long dx = -ring; dx <= ring; dx += step){
+          long long key = cellKey(cx + dx, cy + dy);
+          std::vector<std::pair<long long, size_t> >::const_iterator it =
+            std::lower_bound(cells_.begin(), cells_.end(), std::make_pair(key, (size_t)0));
+          for(; it != cells_.end() && it->first == key; ++it){
+            double dist_sq = distanceSq(it->second, x, y);
+            if(dist_sq < best_dist_sq || (dist_sq == best_dist_sq && it->second > best)){
+              best_dist_sq = dist_sq;
+              best = it->second;
+            }
+          }
+        }
+      }
+    }
+    return best;
+  }
+
+  size_t PlanProgressIndex::advance(double x, double y){
+    if(plan_.empty())
+      return 0;
+
+    size_t best = cursor_;
+    double best_dist_sq = distanceSq(cursor_, x, y);
+    double end_arc_length = plan_.arcLength(cursor_) + lookahead_;
+    for(size_t i = cursor_ + 1; i < plan_.size() && plan_.arcLength(i) <= end_arc_length; ++i){
+      double dist_sq = distanceSq(i, x, y);
+      if(dist_sq < best_dist_sq){
+        best_dist_sq = dist_sq;
+        best = i;
+      }
+    }
+
+    //the robot left the window, e.g. after a jump of its localization
+    if(best_dist_sq > relocalize_distance_ * relocalize_distance_)
+      best = closest(x, y);
+
+    cursor_ = best;
+    return best;
+  }
+};
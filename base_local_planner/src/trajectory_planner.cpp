@@ -186,9 +186,18 @@ namespace base_local_planner{
 
 
     costmap_2d::calculateMinAndMaxDistances(footprint_spec_, inscribed_radius_, circumscribed_radius_);
+
+    //a costmap world model checks the footprint the same way as the rasterized templates, only faster
+    footprint_cache_ = NULL;
+    if(dynamic_cast<CostmapModel*>(&world_model_) != NULL){
+      footprint_cache_ = new FootprintTemplateCache(costmap_);
+      footprint_cache_->setFootprint(footprint_spec_);
+    }
   }
 
-  TrajectoryPlanner::~TrajectoryPlanner(){}
+  TrajectoryPlanner::~TrajectoryPlanner(){
+    delete footprint_cache_;
+  }
 
   bool TrajectoryPlanner::getCellCosts(int cx, int cy, float &path_cost, float &goal_cost, float &occ_cost, float &total_cost) {
     MapCell cell = path_map_(cx, cy);
@@ -384,32 +393,9 @@ namespace base_local_planner{
   }
 
   double TrajectoryPlanner::headingDiff(int cell_x, int cell_y, double x, double y, double heading){
-    unsigned int goal_cell_x, goal_cell_y;
-
     // find closest current position to global plan and take the heading from there
-    double dist_to_path_min = 1e3;
-    double dist_to_path;
-    tf::Pose pose_temp;
-    tf::Quaternion quat_temp;
-    int look_ahead_samples  = 5;
-    int index_plan;
-    int i_curr_loc = 0;;
-    double yaw, pitch, roll;
-    for (int i = global_plan_.size() - 1; i >=0; --i) {
-        dist_to_path = hypot(global_plan_[i].pose.position.x-x,global_plan_[i].pose.position.y-y);
-        if(dist_to_path < dist_to_path_min){
-            dist_to_path_min = dist_to_path;
-             i_curr_loc = i;
-        }
-    }
-
-    index_plan = std::min<int>(i_curr_loc + look_ahead_samples, global_plan_.size() - 1);
-    quat_temp.setW(global_plan_[i_curr_loc].pose.orientation.w);
-    quat_temp.setX(global_plan_[i_curr_loc].pose.orientation.x);
-    quat_temp.setY(global_plan_[i_curr_loc].pose.orientation.y);
-    quat_temp.setZ(global_plan_[i_curr_loc].pose.orientation.z);
-    pose_temp.setRotation(quat_temp);
-    pose_temp.getBasis().getEulerYPR(yaw, pitch, roll);
+    int i_curr_loc = plan_index_.closest(x, y);
+    double yaw = plan_index_.plan().yaw(i_curr_loc);
 
     //ROS_INFO("READ HEADING: %f, %f %d, %d\n", heading, yaw, global_plan_.size(), i_curr_loc);
     return fabs(AngleDifference(heading, yaw) );
@@ -525,6 +511,7 @@ double TrajectoryPlanner::AngleDifference( double angle1, double angle2 )
     for(unsigned int i = 0; i < new_plan.size(); ++i){
       global_plan_[i] = new_plan[i];
     }
+    plan_index_.setPlan(CompactPlan(global_plan_));
 
     if( global_plan_.size() > 0 ){
       geometry_msgs::PoseStamped& final_goal_pose = global_plan_[ global_plan_.size() - 1 ];
@@ -541,8 +528,8 @@ double TrajectoryPlanner::AngleDifference( double angle1, double angle2 )
       goal_map_.resetPathDist();
 
       //make sure that we update our path based on the global plan and compute costs
-      path_map_.setTargetCells(costmap_, global_plan_);
-      goal_map_.setLocalGoal(costmap_, global_plan_);
+      path_map_.setTargetCells(costmap_, plan_index_.plan());
+      goal_map_.setLocalGoal(costmap_, plan_index_.plan());
       ROS_DEBUG("Path/Goal distance computed");
     }
   }
@@ -992,8 +979,8 @@ double TrajectoryPlanner::AngleDifference( double angle1, double angle2 )
     }
 
     //make sure that we update our path based on the global plan and compute costs
-    path_map_.setTargetCells(costmap_, global_plan_);
-    goal_map_.setLocalGoal(costmap_, global_plan_);
+    path_map_.setTargetCells(costmap_, plan_index_.plan());
+    goal_map_.setLocalGoal(costmap_, plan_index_.plan());
     ROS_DEBUG("Path/Goal distance computed");
 
     //rollout trajectories and find the minimum cost one
@@ -1049,6 +1036,8 @@ double TrajectoryPlanner::AngleDifference( double angle1, double angle2 )
   //we need to take the footprint of the robot into account when we calculate cost to obstacles
   double TrajectoryPlanner::footprintCost(double x_i, double y_i, double theta_i){
     //check if the footprint is legal
+    if(footprint_cache_ != NULL && footprint_cache_->hasFootprint())
+      return footprint_cache_->footprintCost(x_i, y_i, theta_i);
     return world_model_.footprintCost(x_i, y_i, theta_i, footprint_spec_, inscribed_radius_, circumscribed_radius_);
   }
 
@@ -72,10 +72,10 @@ namespace base_local_planner {
   }
 
   TrajectoryPlannerROS::TrajectoryPlannerROS() :
-      world_model_(NULL), tc_(NULL), costmap_ros_(NULL), tf_(NULL), setup_(false), initialized_(false), odom_helper_("odom") {}
+      world_model_(NULL), distance_field_model_(NULL), tc_(NULL), costmap_ros_(NULL), tf_(NULL), setup_(false), initialized_(false), odom_helper_("odom") {}
 
   TrajectoryPlannerROS::TrajectoryPlannerROS(std::string name, tf::TransformListener* tf, costmap_2d::Costmap2DROS* costmap_ros) :
-      world_model_(NULL), tc_(NULL), costmap_ros_(NULL), tf_(NULL), setup_(false), initialized_(false), odom_helper_("odom") {
+      world_model_(NULL), distance_field_model_(NULL), tc_(NULL), costmap_ros_(NULL), tf_(NULL), setup_(false), initialized_(false), odom_helper_("odom") {
 
       //initialize the planner
       initialize(name, tf, costmap_ros);
@@ -224,8 +224,14 @@ namespace base_local_planner {
       private_nh.param("point_grid/max_obstacle_height", max_obstacle_height, 2.0);
       private_nh.param("point_grid/grid_resolution", grid_resolution, 0.2);
 
-      ROS_ASSERT_MSG(world_model_type == "costmap", "At this time, only costmap world models are supported by this controller");
-      world_model_ = new CostmapModel(*costmap_);
+      ROS_ASSERT_MSG(world_model_type == "costmap" || world_model_type == "distance_field",
+          "At this time, only costmap and distance_field world models are supported by this controller");
+      if(world_model_type == "distance_field"){
+        distance_field_model_ = new DistanceFieldModel(*costmap_);
+        world_model_ = distance_field_model_;
+      }
+      else
+        world_model_ = new CostmapModel(*costmap_);
       std::vector<double> y_vels = loadYVels(private_nh);
 
       footprint_spec_ = costmap_ros_->getRobotFootprint();
@@ -386,6 +392,10 @@ namespace base_local_planner {
       return false;
     }
 
+    //only the cells that changed since the last cycle are propagated
+    if(distance_field_model_ != NULL)
+      distance_field_model_->update();
+
     std::vector<geometry_msgs::PoseStamped> transformed_plan;
     //get the global plan in our frame
     if (!transformGlobalPlan(*tf_, global_plan_, global_pose, *costmap_, global_frame_, transformed_plan)) {
@@ -541,6 +551,8 @@ namespace base_local_planner {
         tf::poseStampedTFToMsg(global_pose, pose_msg);
         plan.push_back(pose_msg);
         tc_->updatePlan(plan, true);
+        if(distance_field_model_ != NULL)
+          distance_field_model_->update();
       }
 
       //copy over the odometry information
@@ -573,6 +585,8 @@ namespace base_local_planner {
         tf::poseStampedTFToMsg(global_pose, pose_msg);
         plan.push_back(pose_msg);
         tc_->updatePlan(plan, true);
+        if(distance_field_model_ != NULL)
+          distance_field_model_->update();
       }
 
       //copy over the odometry information
@@ -0,0 +1,119 @@
+/*
+ * compact_plan_test.cpp
+ *
+ *  Created on: Oct 23, 2018
+ *      Author: Cesar Lopez
+ */
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <base_local_planner/compact_plan.h>
+#include <tf/transform_datatypes.h>
+
+namespace base_local_planner {
+
+static CompactPlan straightPlan(double x0, double y0, double yaw, unsigned int num_poses, double step) {
+  CompactPlan plan;
+  for (unsigned int i = 0; i < num_poses; ++i) {
+    plan.push_back(x0 + i * step * cos(yaw), y0 + i * step * sin(yaw), yaw);
+  }
+  return plan;
+}
+
+TEST(CompactPlanTest, arcLengthAccumulates){
+  CompactPlan plan = straightPlan(1.0, 2.0, M_PI / 4, 11, 0.1);
+  ASSERT_EQ(11u, plan.size());
+  EXPECT_DOUBLE_EQ(0.0, plan.arcLength(0));
+  EXPECT_NEAR(0.5, plan.arcLength(5), 1e-12);
+  EXPECT_NEAR(1.0, plan.length(), 1e-12);
+  EXPECT_EQ(0u, plan.indexAtArcLength(0.0));
+  EXPECT_EQ(3u, plan.indexAtArcLength(0.25));
+  EXPECT_EQ(11u, plan.indexAtArcLength(2.0));
+
+  plan.truncate(4);
+  EXPECT_EQ(4u, plan.size());
+  EXPECT_NEAR(0.3, plan.length(), 1e-12);
+  EXPECT_DOUBLE_EQ(0.0, CompactPlan().length());
+}
+
+TEST(CompactPlanTest, appendContinuesArcLength){
+  CompactPlan first = straightPlan(0.0, 0.0, 0.0, 6, 0.2);
+  CompactPlan second = straightPlan(0.0, 1.0, M_PI / 2, 6, 0.2);
+
+  //a part of the second plan, joined to the end of the first one
+  CompactPlan joined = first;
+  joined.append(second, 2, 5);
+  ASSERT_EQ(9u, joined.size());
+  EXPECT_NEAR(0.0, joined.x(6), 1e-12);
+  EXPECT_NEAR(1.4, joined.y(6), 1e-12);
+  double join_length = 1.0 + hypot(1.0, 1.4);
+  EXPECT_NEAR(join_length, joined.arcLength(6), 1e-12);
+  EXPECT_NEAR(join_length + 0.4, joined.length(), 1e-12);
+
+  //appending to an empty plan starts at 0
+  CompactPlan part;
+  part.append(second, 3, 100);
+  ASSERT_EQ(3u, part.size());
+  EXPECT_DOUBLE_EQ(0.0, part.arcLength(0));
+  EXPECT_NEAR(0.4, part.length(), 1e-12);
+}
+
+TEST(CompactPlanTest, posesRoundTrip){
+  std::vector<geometry_msgs::PoseStamped> poses;
+  for (int i = 0; i < 5; ++i) {
+    geometry_msgs::PoseStamped pose;
+    pose.header.frame_id = "map";
+    pose.header.stamp = ros::Time(12.5);
+    pose.pose.position.x = 0.5 * i;
+    pose.pose.position.y = -0.25 * i;
+    pose.pose.orientation = tf::createQuaternionMsgFromYaw(-3.0 + 1.4 * i);
+    poses.push_back(pose);
+  }
+
+  CompactPlan plan(poses);
+  ASSERT_EQ(poses.size(), plan.size());
+  EXPECT_EQ("map", plan.frameId());
+  EXPECT_DOUBLE_EQ(12.5, plan.stamp().toSec());
+  EXPECT_NEAR(1.2, plan.yaw(3), 1e-9);
+
+  std::vector<geometry_msgs::PoseStamped> out;
+  plan.toPoses(out);
+  ASSERT_EQ(poses.size(), out.size());
+  for (unsigned int i = 0; i < out.size(); ++i) {
+    EXPECT_EQ("map", out[i].header.frame_id);
+    EXPECT_DOUBLE_EQ(poses[i].pose.position.x, out[i].pose.position.x);
+    EXPECT_DOUBLE_EQ(poses[i].pose.position.y, out[i].pose.position.y);
+    EXPECT_NEAR(tf::getYaw(poses[i].pose.orientation), tf::getYaw(out[i].pose.orientation), 1e-9);
+  }
+
+  nav_msgs::Path path;
+  plan.toPath(path);
+  EXPECT_EQ("map", path.header.frame_id);
+  EXPECT_EQ(poses.size(), path.poses.size());
+}
+
+TEST(CompactPlanTest, revisionChangesWithPoses){
+  CompactPlan plan = straightPlan(0.0, 0.0, 0.0, 5, 0.1);
+  unsigned long revision = plan.revision();
+  EXPECT_NE(0u, revision);
+  EXPECT_EQ(revision, plan.revision());
+
+  //copies share the revision until their poses change
+  CompactPlan copy = plan;
+  EXPECT_EQ(revision, copy.revision());
+  copy.setFrameId("map");
+  EXPECT_EQ(revision, copy.revision());
+  copy.push_back(1.0, 0.0, 0.0);
+  EXPECT_NE(revision, copy.revision());
+
+  CompactPlan other = straightPlan(0.0, 0.0, 0.0, 5, 0.1);
+  EXPECT_NE(revision, other.revision());
+  other.swap(plan);
+  EXPECT_EQ(revision, other.revision());
+  other.truncate(2);
+  EXPECT_NE(revision, other.revision());
+}
+
+}
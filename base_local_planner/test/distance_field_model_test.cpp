@@ -0,0 +1,169 @@
+/*
+ * distance_field_model_test.cpp
+ *
+ *  Created on: Oct 16, 2018
+ *      Author: Cesar Lopez
+ */
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <base_local_planner/distance_field_model.h>
+#include <base_local_planner/costmap_model.h>
+#include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/cost_values.h>
+
+namespace base_local_planner {
+
+static std::vector<geometry_msgs::Point> frontRectangle(double min_x, double max_x, double width) {
+  std::vector<geometry_msgs::Point> footprint_spec;
+  geometry_msgs::Point pt;
+  pt.x = max_x;
+  pt.y = width / 2;
+  footprint_spec.push_back(pt);
+  pt.y = -width / 2;
+  footprint_spec.push_back(pt);
+  pt.x = min_x;
+  footprint_spec.push_back(pt);
+  pt.y = width / 2;
+  footprint_spec.push_back(pt);
+  return footprint_spec;
+}
+
+//distance to the closest lethal or unknown cell by brute force
+static void expectBruteForceDistances(const costmap_2d::Costmap2D& costmap, const DistanceFieldModel& model) {
+  unsigned int mismatches = 0;
+  for (unsigned int x = 0; x < costmap.getSizeInCellsX(); ++x) {
+    for (unsigned int y = 0; y < costmap.getSizeInCellsY(); ++y) {
+      double best = -1.0;
+      for (unsigned int ox = 0; ox < costmap.getSizeInCellsX(); ++ox) {
+        for (unsigned int oy = 0; oy < costmap.getSizeInCellsY(); ++oy) {
+          unsigned char cost = costmap.getCost(ox, oy);
+          if (cost != costmap_2d::LETHAL_OBSTACLE && cost != costmap_2d::NO_INFORMATION)
+            continue;
+          double dist = hypot((double) ox - x, (double) oy - y) * costmap.getResolution();
+          if (best < 0.0 || dist < best)
+            best = dist;
+        }
+      }
+      if (std::abs(model.distance(x, y) - best) > 1e-9)
+        ++mismatches;
+    }
+  }
+  EXPECT_EQ(0u, mismatches);
+}
+
+TEST(DistanceFieldModelTest, incrementalUpdatesMatchBruteForce){
+  costmap_2d::Costmap2D costmap(40, 30, 0.1, 0.0, 0.0);
+  DistanceFieldModel model(costmap);
+  EXPECT_EQ(-1.0, model.distance(5, 5));
+
+  srand(42);
+  for (int round = 0; round < 6; ++round) {
+    //add and remove a few obstacles, then check the propagated distances
+    for (int i = 0; i < 12; ++i) {
+      unsigned int x = rand() % 40, y = rand() % 30;
+      if (costmap.getCost(x, y) == costmap_2d::FREE_SPACE)
+        costmap.setCost(x, y, round % 3 == 2 ? costmap_2d::NO_INFORMATION : costmap_2d::LETHAL_OBSTACLE);
+      else
+        costmap.setCost(x, y, costmap_2d::FREE_SPACE);
+    }
+    EXPECT_TRUE(model.update());
+    expectBruteForceDistances(costmap, model);
+  }
+  EXPECT_FALSE(model.update());
+}
+
+TEST(DistanceFieldModelTest, movedCostmapMatchesBruteForce){
+  costmap_2d::Costmap2D costmap(40, 30, 0.1, 0.0, 0.0);
+  srand(7);
+  for (int i = 0; i < 30; ++i)
+    costmap.setCost(rand() % 40, rand() % 30, costmap_2d::LETHAL_OBSTACLE);
+  DistanceFieldModel model(costmap);
+  expectBruteForceDistances(costmap, model);
+
+  //a rolling window moving with the robot: shifted cells keep their distances, the obstacles
+  //that left the window no longer count and the uncovered cells are filled in
+  double moves[4][2] = {{0.3, 0.0}, {-0.5, 0.2}, {0.0, -0.7}, {2.2, 1.1}};
+  for (int m = 0; m < 4; ++m) {
+    costmap.updateOrigin(costmap.getOriginX() + moves[m][0], costmap.getOriginY() + moves[m][1]);
+    costmap.setCost(rand() % 40, rand() % 30, costmap_2d::LETHAL_OBSTACLE);
+    model.update();
+    expectBruteForceDistances(costmap, model);
+  }
+}
+
+TEST(DistanceFieldModelTest, footprintCheckIsConservative){
+  costmap_2d::Costmap2D costmap(60, 60, 0.05, 0.0, 0.0);
+  srand(3);
+  for (int i = 0; i < 40; ++i)
+    costmap.setCost(rand() % 60, rand() % 60, costmap_2d::LETHAL_OBSTACLE);
+  DistanceFieldModel model(costmap);
+  CostmapModel costmap_model(costmap);
+
+  std::vector<geometry_msgs::Point> footprints[2] = {frontRectangle(-0.33, 0.33, 0.66), frontRectangle(-0.1, 1.3, 0.72)};
+  unsigned int free_poses = 0;
+  for (int f = 0; f < 2; ++f) {
+    model.setFootprint(footprints[f]);
+    for (int i = 0; i < 2000; ++i) {
+      double x = 3.0 * rand() / RAND_MAX, y = 3.0 * rand() / RAND_MAX, theta = 2.0 * M_PI * rand() / RAND_MAX;
+      double cost = model.footprintCost(x, y, theta, footprints[f]);
+      EXPECT_EQ(cost, model.footprintCost(x, y, theta));
+      //a pose accepted by the circle cover is accepted by the perimeter check as well
+      if (cost >= 0.0) {
+        EXPECT_LE(0.0, costmap_model.footprintCost(x, y, theta, footprints[f]));
+        ++free_poses;
+      }
+    }
+  }
+  EXPECT_LT(0u, free_poses);
+}
+
+TEST(DistanceFieldModelTest, obstacleInsideFootprint){
+  costmap_2d::Costmap2D costmap(60, 60, 0.05, 0.0, 0.0);
+  DistanceFieldModel model(costmap);
+  std::vector<geometry_msgs::Point> footprint_spec = frontRectangle(-0.1, 1.3, 0.72);
+  EXPECT_EQ(0.0, model.footprintCost(1.0, 1.5, 0.0, footprint_spec));
+  EXPECT_EQ(-1.0, model.footprintCost(0.05, 1.5, 0.0, footprint_spec));
+
+  //missed by the perimeter check, but not by the circle cover
+  costmap.setCost(31, 30, costmap_2d::LETHAL_OBSTACLE);
+  model.update();
+  CostmapModel costmap_model(costmap);
+  EXPECT_LE(0.0, costmap_model.footprintCost(1.0, 1.5, 0.0, footprint_spec));
+  EXPECT_EQ(-1.0, model.footprintCost(1.0, 1.5, 0.0, footprint_spec));
+  EXPECT_EQ(0.0, model.footprintCost(1.0, 1.5 + 0.6, 0.0, footprint_spec));
+
+  //other shapes use the costmap model
+  footprint_spec.pop_back();
+  EXPECT_EQ(costmap_model.footprintCost(1.0, 1.5, 0.0, footprint_spec), model.footprintCost(1.0, 1.5, 0.0, footprint_spec));
+}
+
+TEST(DistanceFieldModelTest, clearanceIsALowerBound){
+  costmap_2d::Costmap2D costmap(60, 60, 0.05, 0.0, 0.0);
+  srand(11);
+  for (int i = 0; i < 20; ++i)
+    costmap.setCost(rand() % 60, rand() % 60, costmap_2d::LETHAL_OBSTACLE);
+  DistanceFieldModel model(costmap);
+
+  for (int i = 0; i < 2000; ++i) {
+    double x = 3.0 * rand() / RAND_MAX, y = 3.0 * rand() / RAND_MAX;
+    double clearance = model.clearance(x, y);
+    EXPECT_LE(clearance, std::min(std::min(x, 3.0 - x), std::min(y, 3.0 - y)));
+    //no point of an obstacle cell lies inside the circle
+    for (unsigned int ox = 0; ox < 60; ++ox) {
+      for (unsigned int oy = 0; oy < 60; ++oy) {
+        if (costmap.getCost(ox, oy) != costmap_2d::LETHAL_OBSTACLE)
+          continue;
+        double dx = std::max(0.0, std::max(ox * 0.05 - x, x - (ox + 1) * 0.05));
+        double dy = std::max(0.0, std::max(oy * 0.05 - y, y - (oy + 1) * 0.05));
+        EXPECT_LE(clearance, hypot(dx, dy) + 1e-9);
+      }
+    }
+  }
+  EXPECT_GE(0.0, model.clearance(-0.1, 1.0));
+}
+
+}
@@ -0,0 +1,92 @@
+/*
+ * footprint_model_test.cpp
+ *
+ *  Created on: Oct 16, 2018
+ *      Author: Cesar Lopez
+ */
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <base_local_planner/footprint_model.h>
+#include <base_local_planner/footprint_template_cache.h>
+#include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/cost_values.h>
+
+namespace base_local_planner {
+
+static std::vector<geometry_msgs::Point> boxFootprint(double min_x, double max_x, double width) {
+  std::vector<geometry_msgs::Point> footprint_spec;
+  geometry_msgs::Point pt;
+  pt.x = max_x;
+  pt.y = width / 2;
+  footprint_spec.push_back(pt);
+  pt.y = -width / 2;
+  footprint_spec.push_back(pt);
+  pt.x = min_x;
+  footprint_spec.push_back(pt);
+  pt.y = width / 2;
+  footprint_spec.push_back(pt);
+  return footprint_spec;
+}
+
+TEST(FootprintModelTest, radiiAndCorners){
+  //the ropod footprint with a load attached, the center of rotation close to the rear
+  FootprintModel model(boxFootprint(-0.1, 1.3, 0.72));
+  EXPECT_TRUE(model.hasFootprint());
+  EXPECT_NEAR(0.1, model.inscribedRadius(), 1e-9);
+  EXPECT_NEAR(hypot(1.3, 0.36), model.circumscribedRadius(), 1e-9);
+
+  ASSERT_TRUE(model.hasFourCorners());
+  EXPECT_EQ(1.3, model.frontLeftCorner().x);
+  EXPECT_EQ(0.36, model.frontLeftCorner().y);
+  EXPECT_EQ(-0.36, model.frontRightCorner().y);
+  EXPECT_EQ(-0.1, model.rearLeftCorner().x);
+  EXPECT_EQ(-0.36, model.rearRightCorner().y);
+
+  //the center of rotation outside the footprint
+  EXPECT_FALSE(FootprintModel(boxFootprint(0.1, 1.3, 0.72)).hasFourCorners());
+  EXPECT_FALSE(FootprintModel(std::vector<geometry_msgs::Point>()).hasFootprint());
+}
+
+TEST(FootprintModelTest, sharedModelSwap){
+  SharedFootprintModel shared(64);
+  EXPECT_FALSE(shared.get());
+  EXPECT_TRUE(shared.set(boxFootprint(-0.36, 0.36, 0.72), 0.1));
+  FootprintModelConstPtr ropod = shared.get();
+  EXPECT_TRUE(ropod->hasTemplates(0.1, 64));
+
+  //the same footprint keeps the model, a new one gets a new version while the old one stays valid
+  EXPECT_FALSE(shared.set(boxFootprint(-0.36, 0.36, 0.72), 0.1));
+  EXPECT_EQ(ropod, shared.get());
+  EXPECT_TRUE(shared.set(boxFootprint(-0.1, 1.3, 0.72), 0.1));
+  EXPECT_LT(ropod->version(), shared.get()->version());
+  EXPECT_TRUE(ropod->sameFootprint(boxFootprint(-0.36, 0.36, 0.72)));
+}
+
+TEST(FootprintModelTest, templateCacheSharesModel){
+  costmap_2d::Costmap2D costmap(40, 40, 0.1, 0.0, 0.0);
+  costmap.setCost(28, 24, costmap_2d::LETHAL_OBSTACLE);
+
+  SharedFootprintModel shared(64);
+  shared.set(boxFootprint(-0.36, 0.36, 0.72), 0.1);
+  FootprintTemplateCache cache(costmap, 64);
+  EXPECT_TRUE(cache.setFootprintModel(shared.get()));
+  EXPECT_FALSE(cache.setFootprintModel(shared.get()));
+  EXPECT_EQ(shared.get(), cache.getFootprintModel());
+  EXPECT_EQ(0.0, cache.footprintCost(2.05, 2.05, 0.0));
+
+  //a load attached reaches the obstacle in front
+  shared.set(boxFootprint(-0.1, 1.3, 0.72), 0.1);
+  EXPECT_TRUE(cache.setFootprintModel(shared.get()));
+  EXPECT_EQ(-1.0, cache.footprintCost(2.05, 2.05, 0.0));
+
+  //a model rasterized for another resolution is rebuilt by the cache
+  shared.set(boxFootprint(-0.36, 0.36, 0.72), 0.05);
+  EXPECT_TRUE(cache.setFootprintModel(shared.get()));
+  EXPECT_NE(shared.get(), cache.getFootprintModel());
+  EXPECT_TRUE(cache.getFootprintModel()->hasTemplates(0.1, 64));
+}
+
+}
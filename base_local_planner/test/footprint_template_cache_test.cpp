@@ -0,0 +1,80 @@
+/*
+ * footprint_template_cache_test.cpp
+ *
+ *  Created on: Oct 16, 2018
+ *      Author: Cesar Lopez
+ */
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <base_local_planner/footprint_template_cache.h>
+#include <base_local_planner/costmap_model.h>
+#include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/cost_values.h>
+
+namespace base_local_planner {
+
+std::vector<geometry_msgs::Point> rectangleFootprint(double length, double width) {
+  std::vector<geometry_msgs::Point> footprint_spec;
+  geometry_msgs::Point pt;
+  pt.x = length / 2;
+  pt.y = width / 2;
+  footprint_spec.push_back(pt);
+  pt.y = -width / 2;
+  footprint_spec.push_back(pt);
+  pt.x = -length / 2;
+  footprint_spec.push_back(pt);
+  pt.y = width / 2;
+  footprint_spec.push_back(pt);
+  return footprint_spec;
+}
+
+TEST(FootprintTemplateCacheTest, matchesCostmapModelOnBinHeadings){
+  costmap_2d::Costmap2D costmap(40, 40, 0.1, 0.0, 0.0);
+  for (unsigned int i = 0; i < 40; ++i) {
+    costmap.setCost(i, 20, 100);
+    costmap.setCost(25, i, costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+  }
+  costmap.setCost(10, 30, costmap_2d::LETHAL_OBSTACLE);
+  costmap.setCost(30, 8, costmap_2d::NO_INFORMATION);
+
+  std::vector<geometry_msgs::Point> footprint_spec = rectangleFootprint(0.73, 0.46);
+  CostmapModel costmap_model(costmap);
+  FootprintTemplateCache cache(costmap, 64);
+  EXPECT_TRUE(cache.setFootprint(footprint_spec));
+
+  //on cell centers and bin headings the templates are the exact rasterization
+  for (unsigned int cx = 0; cx < 40; cx += 3) {
+    for (unsigned int cy = 0; cy < 40; cy += 3) {
+      for (unsigned int bin = 0; bin < 64; bin += 5) {
+        double x = (cx + 0.5) * 0.1;
+        double y = (cy + 0.5) * 0.1;
+        double theta = -M_PI + 2.0 * M_PI * bin / 64;
+        EXPECT_EQ(costmap_model.footprintCost(x, y, theta, footprint_spec), cache.footprintCost(x, y, theta));
+      }
+    }
+  }
+}
+
+TEST(FootprintTemplateCacheTest, offMapAndFootprintChange){
+  costmap_2d::Costmap2D costmap(40, 40, 0.1, 0.0, 0.0);
+  costmap.setCost(20, 26, costmap_2d::LETHAL_OBSTACLE);
+
+  FootprintTemplateCache cache(costmap);
+  EXPECT_FALSE(cache.hasFootprint());
+  EXPECT_TRUE(cache.setFootprint(rectangleFootprint(0.8, 0.5)));
+  EXPECT_FALSE(cache.setFootprint(rectangleFootprint(0.8, 0.5)));
+
+  EXPECT_EQ(-1.0, cache.footprintCost(-1.0, 2.0, 0.0));
+  EXPECT_EQ(-1.0, cache.footprintCost(0.1, 2.0, 0.0));
+  EXPECT_EQ(0.0, cache.footprintCost(2.05, 2.05, 0.0));
+
+  //a larger footprint, e.g. with a load attached, reaches the obstacle
+  EXPECT_TRUE(cache.setFootprint(rectangleFootprint(0.8, 1.2)));
+  EXPECT_EQ(-1.0, cache.footprintCost(2.05, 2.05, 0.0));
+  EXPECT_EQ(0.0, cache.footprintCost(2.05, 2.05, M_PI_2));
+}
+
+}
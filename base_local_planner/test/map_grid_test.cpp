@@ -134,6 +134,35 @@ TEST(MapGridTest, adjustPlan){
   EXPECT_EQ(5, global_plan_out[2].pose.position.x);
 }
 
+TEST(MapGridTest, adjustCompactPlan){
+  MapGrid mg(10, 10);
+  CompactPlan global_plan_in;
+  global_plan_in.setFrameId("map");
+  global_plan_in.push_back(0, 0, 0);
+  global_plan_in.push_back(6, 0, 0.5);
+  CompactPlan global_plan_out;
+  mg.adjustPlanResolution(global_plan_in, global_plan_out, 1);
+  ASSERT_EQ(4, global_plan_out.size());
+  EXPECT_EQ("map", global_plan_out.frameId());
+
+  //the added poses take the orientation of the pose they lead to
+  for(unsigned int i = 0; i < global_plan_out.size(); ++i){
+    EXPECT_DOUBLE_EQ(2.0 * i, global_plan_out.x(i));
+    EXPECT_DOUBLE_EQ(0.0, global_plan_out.y(i));
+    EXPECT_DOUBLE_EQ(i == 0 ? 0.0 : 0.5, global_plan_out.yaw(i));
+  }
+
+  //the poses overload is the same densification
+  std::vector<geometry_msgs::PoseStamped> poses_in, poses_out;
+  global_plan_in.toPoses(poses_in);
+  mg.adjustPlanResolution(poses_in, poses_out, 1);
+  ASSERT_EQ(global_plan_out.size(), poses_out.size());
+  for(unsigned int i = 0; i < poses_out.size(); ++i){
+    EXPECT_DOUBLE_EQ(global_plan_out.x(i), poses_out[i].pose.position.x);
+    EXPECT_DOUBLE_EQ(global_plan_out.y(i), poses_out[i].pose.position.y);
+  }
+}
+
 TEST(MapGridTest, distancePropagation){
   MapGrid mg(10, 10);
 
@@ -0,0 +1,105 @@
+/*
+ * plan_progress_index_test.cpp
+ *
+ *  Created on: Nov 6, 2018
+ *      Author: Cesar Lopez
+ */
+#include <cmath>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+#include <base_local_planner/plan_progress_index.h>
+
+namespace base_local_planner {
+
+//index of the closest pose by scanning the whole plan, the last one on ties
+static size_t closestByScan(const CompactPlan& plan, double x, double y) {
+  size_t best = 0;
+  double best_dist = std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < plan.size(); ++i) {
+    double dist = hypot(plan.x(i) - x, plan.y(i) - y);
+    if (dist <= best_dist) {
+      best_dist = dist;
+      best = i;
+    }
+  }
+  return best;
+}
+
+//a U turn, going out along y = 0 and back along y = 1
+static CompactPlan uTurnPlan() {
+  CompactPlan plan;
+  for (int i = 0; i <= 40; ++i)
+    plan.push_back(-1.0 + 0.1 * i, 0.0, 0.0);
+  for (int i = 1; i < 10; ++i)
+    plan.push_back(3.0 + 0.5 * sin(M_PI * i / 10), 0.5 - 0.5 * cos(M_PI * i / 10), M_PI * i / 10);
+  for (int i = 0; i <= 40; ++i)
+    plan.push_back(3.0 - 0.1 * i, 1.0, M_PI);
+  return plan;
+}
+
+TEST(PlanProgressIndexTest, closestMatchesScan){
+  CompactPlan plan = uTurnPlan();
+  PlanProgressIndex index(0.3);
+  index.setPlan(plan);
+
+  for (int i = -30; i <= 60; ++i) {
+    for (int j = -20; j <= 30; ++j) {
+      double x = 0.1 * i + 0.013, y = 0.1 * j - 0.007;
+      size_t expected = closestByScan(plan, x, y);
+      size_t found = index.closest(x, y);
+      EXPECT_NEAR(hypot(plan.x(expected) - x, plan.y(expected) - y), hypot(plan.x(found) - x, plan.y(found) - y), 1e-12);
+    }
+  }
+  //far from the plan
+  EXPECT_EQ(closestByScan(plan, 20.0, -15.0), index.closest(20.0, -15.0));
+  EXPECT_EQ(0u, PlanProgressIndex().closest(1.0, 1.0));
+}
+
+TEST(PlanProgressIndexTest, advanceFollowsTheRobot){
+  CompactPlan plan = uTurnPlan();
+  PlanProgressIndex index(0.5, 1.0, 0.6);
+  index.setPlan(plan);
+
+  //driving back at y = 0.45 the poses going out along y = 0 are closer, but they were passed already
+  for (size_t i = 0; i < plan.size(); i += 3) {
+    double y = i < 50 ? plan.y(i) : 0.45;
+    EXPECT_EQ(i, index.advance(plan.x(i), y));
+    EXPECT_EQ(i, index.cursor());
+  }
+  EXPECT_GT(50u, index.closest(plan.x(60), 0.45));
+}
+
+TEST(PlanProgressIndexTest, advanceRelocalizes){
+  CompactPlan plan = uTurnPlan();
+  PlanProgressIndex index(0.5, 1.0, 0.5);
+  index.setPlan(plan);
+
+  EXPECT_EQ(0u, index.advance(-1.0, 0.0));
+  //a jump far along the plan is out of the lookahead window
+  EXPECT_EQ(closestByScan(plan, 1.0, 1.05), index.advance(1.0, 1.05));
+  //and a jump back as well
+  EXPECT_EQ(10u, index.advance(0.0, -0.1));
+}
+
+TEST(PlanProgressIndexTest, indexesFollowsRevision){
+  CompactPlan plan = uTurnPlan();
+  PlanProgressIndex index;
+  EXPECT_FALSE(index.indexes(plan));
+  index.setPlan(plan);
+  EXPECT_TRUE(index.indexes(plan));
+
+  CompactPlan copy = plan;
+  EXPECT_TRUE(index.indexes(copy));
+  copy.push_back(0.0, 2.0, 0.0);
+  EXPECT_FALSE(index.indexes(copy));
+  EXPECT_TRUE(index.indexes(plan));
+  plan.truncate(10);
+  EXPECT_FALSE(index.indexes(plan));
+  index.setPlan(plan);
+  EXPECT_EQ(0u, index.cursor());
+  EXPECT_EQ(6u, index.advance(-0.4, 0.0));
+}
+
+}
@@ -253,11 +253,14 @@ namespace dwa_local_planner {
       global_plan_[i] = new_plan[i];
     }
 
+    // the cost functions share one compact copy of the plan
+    base_local_planner::CompactPlan target_plan(global_plan_);
+
     // costs for going away from path
-    path_costs_.setTargetPoses(global_plan_);
+    path_costs_.setTargetPoses(target_plan);
 
     // costs for not going towards the local goal as much as possible
-    goal_costs_.setTargetPoses(global_plan_);
+    goal_costs_.setTargetPoses(target_plan);
 
     // alignment costs
     geometry_msgs::PoseStamped goal_pose = global_plan_.back();
@@ -272,12 +275,13 @@ namespace dwa_local_planner {
     // path for the robot center. Choosing the final position after
     // turning towards goal orientation causes instability when the
     // robot needs to make a 180 degree turn at the end
-    std::vector<geometry_msgs::PoseStamped> front_global_plan = global_plan_;
+    base_local_planner::CompactPlan front_global_plan = target_plan;
     double angle_to_goal = atan2(goal_pose.pose.position.y - pos[1], goal_pose.pose.position.x - pos[0]);
-    front_global_plan.back().pose.position.x = front_global_plan.back().pose.position.x +
-      forward_point_distance_ * cos(angle_to_goal);
-    front_global_plan.back().pose.position.y = front_global_plan.back().pose.position.y + forward_point_distance_ *
-      sin(angle_to_goal);
+    size_t last_pose = front_global_plan.size() - 1;
+    double goal_yaw = front_global_plan.yaw(last_pose);
+    front_global_plan.truncate(last_pose);
+    front_global_plan.push_back(goal_pose.pose.position.x + forward_point_distance_ * cos(angle_to_goal),
+      goal_pose.pose.position.y + forward_point_distance_ * sin(angle_to_goal), goal_yaw);
 
     goal_front_costs_.setTargetPoses(front_global_plan);
     
@@ -286,7 +290,7 @@ namespace dwa_local_planner {
       double resolution = planner_util_->getCostmap()->getResolution();
       alignment_costs_.setScale(resolution * pdist_scale_ * 0.5);
       // costs for robot being aligned with path (nose on path, not ju
-      alignment_costs_.setTargetPoses(global_plan_);
+      alignment_costs_.setTargetPoses(target_plan);
     } else {
       // once we are close to goal, trying to keep the nose close to anything destabilizes behavior.
       alignment_costs_.setScale(0.0);
@@ -0,0 +1,95 @@
+#ifndef COMMAND_MAILBOX_HH
+#define COMMAND_MAILBOX_HH
+
+#include <ros/ros.h>
+#include <algorithm>
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace mn {
+
+/**
+ * @brief Wakes the node loop when a command is posted by a callback. Commands are passed through CommandSlots without locks,
+ * the mutex is only held to sleep and to wake up
+ */
+class CommandMailbox
+{
+public:
+    CommandMailbox() : signaled_(false) {}
+
+    void notify()
+    {
+        {
+            boost::lock_guard<boost::mutex> lock(mutex_);
+            signaled_ = true;
+        }
+        cond_.notify_one();
+    }
+
+    /**
+     * @brief Sleeps until a command is posted or until deadline on the ROS clock, which is the simulated one under use_sim_time
+     * @return True if woken by a command
+     */
+    bool waitUntil(const ros::Time& deadline)
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        while( !signaled_ && !ros::isShuttingDown() )
+        {
+            ros::Duration remaining = deadline - ros::Time::now();
+            if( remaining <= ros::Duration(0.0) )
+                break;
+            // Simulated time can run at any rate, so it is polled like ros::Time::sleepUntil does
+            if( ros::Time::isSimTime() )
+                remaining = std::min(remaining, ros::Duration(0.001));
+            cond_.timed_wait(lock, boost::posix_time::microseconds(remaining.toNSec()/1000));
+        }
+        bool signaled = signaled_;
+        signaled_ = false;
+        return signaled;
+    }
+
+private:
+    boost::mutex mutex_;
+    boost::condition_variable cond_;
+    bool signaled_;
+};
+
+/**
+ * @brief Latest command of one kind, a command not yet taken is replaced by a newer one. Any number of threads can post,
+ * one thread takes
+ */
+template <typename T>
+class CommandSlot
+{
+public:
+    CommandSlot(CommandMailbox& mailbox) : mailbox_(mailbox), command_(NULL) {}
+    ~CommandSlot() { delete command_.exchange(NULL); }
+
+    void post(const T& command)
+    {
+        delete command_.exchange(new T(command), boost::memory_order_acq_rel);
+        mailbox_.notify();
+    }
+
+    bool take(T& command)
+    {
+        T* posted = command_.exchange(NULL, boost::memory_order_acq_rel);
+        if( !posted )
+            return false;
+        command = *posted;
+        delete posted;
+        return true;
+    }
+
+private:
+    CommandSlot(const CommandSlot&);
+    CommandSlot& operator=(const CommandSlot&);
+
+    CommandMailbox& mailbox_;
+    boost::atomic<T*> command_;
+};
+
+}
+
+#endif
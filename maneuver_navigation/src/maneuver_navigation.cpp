@@ -3,18 +3,53 @@
 namespace mn
 {
 ManeuverNavigation::ManeuverNavigation(tf::TransformListener& tf, ros::NodeHandle& nh) :
-tf_(tf), nh_(nh), blp_loader_("nav_core", "nav_core::BaseLocalPlanner")
+tf_(tf), nh_(nh), blp_loader_("nav_core", "nav_core::BaseLocalPlanner"), costmap_changes_(8)
 {    
     
     initialized_ = false;
     timeout_duration_ = ros::Duration(5.0);
     timer_running_ = false;
+    publish_planner_statistics_ = false;
+    incremental_feasibility_check_ = true;
+    pose_checks_footprint_version_ = 0;
+    plan_next_maneuver_ = false;
+    next_maneuver_.goal_free = false;
+    next_maneuver_.footprint_version = 0;
+    next_maneuver_.generation = 0;
+    next_maneuver_.requested = false;
+    next_maneuver_.planning = false;
+    next_maneuver_.ready = false;
+    next_maneuver_.shutdown = false;
+    replan_.use_line_planner = false;
+    replan_.goal_free = false;
+    replan_.dist_before_obs = 0.0;
+    replan_.version = 0;
+    replan_.requested = false;
+    replan_.planning = false;
+    replan_.ready = false;
+    replan_.shutdown = false;
+    replan_reason_ = REPLAN_INIT;
 };
 
 
 ManeuverNavigation::~ManeuverNavigation() 
 {
+    {
+        boost::unique_lock<boost::mutex> lock(next_maneuver_mutex_);
+        next_maneuver_.shutdown = true;
+    }
+    next_maneuver_cond_.notify_all();
+    if( next_maneuver_thread_.joinable() )
+        next_maneuver_thread_.join();
+    {
+        boost::unique_lock<boost::mutex> lock(replan_mutex_);
+        replan_.shutdown = true;
+    }
+    replan_cond_.notify_all();
+    if( replan_thread_.joinable() )
+        replan_thread_.join();
     local_planner_.reset();
+    profiles_.clear();
 };
 
 void ManeuverNavigation::init() 
@@ -29,7 +64,10 @@ void ManeuverNavigation::init()
     costmap_ = costmap_ros_->getCostmap();
     
     world_model_ = new base_local_planner::CostmapModel(*costmap_);
-    maneuver_planner = maneuver_planner::ManeuverPlanner("maneuver_planner",costmap_ros_);
+    footprint_cache_ = new base_local_planner::FootprintTemplateCache(*costmap_);
+    footprint_model_.reset(new base_local_planner::SharedFootprintModel(footprint_cache_->numHeadingBins()));
+    footprint_model_->set(costmap_ros_->getRobotFootprint(), costmap_->getResolution());
+    initReplanPlanner();
 //     try{
 //         local_planner.initialize("TrajectoryPlannerROS", &tf_, local_costmap_ros);
 //     } catch(...) {
@@ -69,10 +107,27 @@ void ManeuverNavigation::init()
     
     pub_navigation_fb_ =   nh_.advertise<geometry_msgs::PoseStamped> ( "/maneuver_navigation/feedback", 1 );
     
+    nh_.param("publish_planner_statistics", publish_planner_statistics_, false);
+    if( publish_planner_statistics_ )
+        pub_planner_statistics_ = nh_.advertise<maneuver_navigation::PlannerStatistics> ( "/maneuver_navigation/planner_statistics", 1 );
+    
     last_goal_as_start_ = false;
     last_goal_valid_ =  false;
     
+    // Check again only the plan poses under costmap cells that changed since they were found free
+    nh_.param("incremental_feasibility_check", incremental_feasibility_check_, true);
+    
+    // Plan the upcoming route goal in the background, so there is no planning at waypoint transitions
+    nh_.param("plan_next_maneuver", plan_next_maneuver_, false);
+    nh_.param("next_maneuver_start_tolerance", next_maneuver_start_tolerance_, 0.5);
+    if( plan_next_maneuver_ )
+    {
+        initNextManeuverPlanner();
+        next_maneuver_thread_ = boost::thread(boost::bind(&ManeuverNavigation::nextManeuverLoop, this));
+    }
+    
     plan.clear();
+    replan_thread_ = boost::thread(boost::bind(&ManeuverNavigation::replanLoop, this));
     
     initialized_ = true;
 
@@ -82,8 +137,21 @@ void ManeuverNavigation::reinitPlanner(const geometry_msgs::Polygon& new_footpri
 {      
     costmap_ros_->setUnpaddedRobotFootprintPolygon(new_footprint);   
     costmap_ros_->resetLayers();
-    // initialize maneuver planner
-    maneuver_planner = maneuver_planner::ManeuverPlanner("maneuver_planner",costmap_ros_);
+    // The new footprint model replaces the old one for all the footprint checks at once
+    footprint_model_->set(costmap_ros_->getRobotFootprint(), costmap_->getResolution());
+    {   // initialize maneuver planner, once the plan being made is done. A requested plan is made by the new planner
+        boost::unique_lock<boost::mutex> lock(replan_mutex_);
+        waitReplanIdle(lock);
+        initReplanPlanner();
+    }
+    if( plan_next_maneuver_ )
+    {   // The background planner is replaced once it is idle, a prepared plan was checked with the old footprint
+        boost::unique_lock<boost::mutex> lock(next_maneuver_mutex_);
+        while( next_maneuver_.planning )
+            next_maneuver_cond_.wait(lock);
+        initNextManeuverPlanner();
+        next_maneuver_.ready = false;
+    }
     // Initializelocal planner
     std::string local_planner_str;
 //     nh_.param("base_local_planner", local_planner_str, std::string("base_local_planner/TrajectoryPlannerROS"));
@@ -106,6 +174,106 @@ void ManeuverNavigation::reinitPlanner(const geometry_msgs::Polygon& new_footpri
 
 }
 
+bool ManeuverNavigation::loadProfile(const std::string& name)
+{
+    std::string profile_ns = "footprint_profiles/" + name;
+    XmlRpc::XmlRpcValue footprint_xmlrpc;
+    if( !nh_.getParam(profile_ns + "/local_costmap/footprint", footprint_xmlrpc) )
+    {
+        ROS_ERROR("No footprint in %s", profile_ns.c_str());
+        return false;
+    }
+    Profile profile;
+    profile.name = name;
+    // 0.01 is to avoid infeseability
+    std::vector<geometry_msgs::Point> footprint_spec = costmap_2d::makeFootprintFromXMLRPC(footprint_xmlrpc, profile_ns + "/local_costmap/footprint");
+    costmap_2d::padFootprint(footprint_spec, -0.01);
+    profile.footprint = costmap_2d::toPolygon(footprint_spec);
+    
+    // The model of the footprint the costmap will have, with the templates rasterized now instead of at the switch
+    double footprint_padding;
+    ros::NodeHandle(nh_, "local_costmap").param("footprint_padding", footprint_padding, 0.01);
+    std::vector<geometry_msgs::Point> padded_footprint = footprint_spec;
+    costmap_2d::padFootprint(padded_footprint, footprint_padding);
+    profile.footprint_model.reset(new base_local_planner::FootprintModel(padded_footprint, costmap_->getResolution(), footprint_cache_->numHeadingBins()));
+    
+    // A local planner of its own, with the parameters of the profile. It takes the footprint of the costmap when initialized
+    std::string local_planner_str;
+    nh_.param("base_local_planner", local_planner_str, std::string("teb_local_planner/TebLocalPlannerROS"));
+    std::string local_planner_name = profile_ns + "/" + blp_loader_.getName(local_planner_str);
+    if( !nh_.hasParam(local_planner_name) )
+    {   // A profile may configure only the footprint, its local planner then gets a copy of the parameters of the node
+        XmlRpc::XmlRpcValue local_planner_params;
+        if( nh_.getParam(blp_loader_.getName(local_planner_str), local_planner_params) )
+            nh_.setParam(local_planner_name, local_planner_params);
+        ROS_WARN("No %s parameters in %s, the ones of the node are used", blp_loader_.getName(local_planner_str).c_str(), profile_ns.c_str());
+    }
+    std::vector<geometry_msgs::Point> current_footprint = local_costmap_ros->getUnpaddedRobotFootprint();
+    local_costmap_ros->setUnpaddedRobotFootprint(footprint_spec);
+    try {      
+      profile.local_planner = blp_loader_.createInstance(local_planner_str);
+      profile.local_planner->initialize(local_planner_name, &tf_, local_costmap_ros);
+    } catch (const pluginlib::PluginlibException& ex) {
+        ROS_ERROR("Failed to create the local planner of %s", profile_ns.c_str());
+        profile.local_planner.reset();
+    }
+    local_costmap_ros->setUnpaddedRobotFootprint(current_footprint);
+    if( !profile.local_planner )
+        return false;
+    
+    nh_.param(local_planner_name+"/xy_goal_tolerance", profile.xy_goal_tolerance, xy_goal_tolerance_);
+    nh_.param(local_planner_name+"/yaw_goal_tolerance", profile.yaw_goal_tolerance, yaw_goal_tolerance_);
+    
+    ROS_INFO("Footprint profile %s loaded", name.c_str());
+    for( size_t i = 0; i < profiles_.size(); i++ )
+    {
+        if( profiles_[i].name == name )
+        {
+            profiles_[i] = profile;
+            return true;
+        }
+    }
+    profiles_.push_back(profile);
+    return true;
+}
+
+bool ManeuverNavigation::setProfile(const std::string& name)
+{
+    for( size_t i = 0; i < profiles_.size(); i++ )
+    {
+        if( profiles_[i].name != name )
+            continue;
+        
+        const Profile& profile = profiles_[i];
+        costmap_ros_->setUnpaddedRobotFootprintPolygon(profile.footprint);
+        // The prepared model replaces the old one for all the footprint checks at once, the maneuver planners take it with their next plan
+        footprint_model_->set(profile.footprint_model);
+        local_planner_ = profile.local_planner;
+        xy_goal_tolerance_ = profile.xy_goal_tolerance;
+        yaw_goal_tolerance_ = profile.yaw_goal_tolerance;
+        // The plan being executed is handed to the local planner of the profile
+        if( local_nav_state_ == LOC_NAV_BUSY )
+        {
+            if( manv_nav_state_ == MANV_NAV_WAIT_PLAN && replan_prefix_.size() > 1 )
+            {   // The free part of the old plan, driven while the new plan is made
+                std::vector<geometry_msgs::PoseStamped> prefix_poses;
+                replan_prefix_.toPoses(prefix_poses);
+                if( !local_planner_->setPlan(prefix_poses) )
+                {
+                    publishZeroVelocity();
+                    local_nav_state_ = LOC_NAV_IDLE;
+                }
+            }
+            else
+                local_nav_state_ = LOC_NAV_SET_PLAN;
+        }
+        ROS_INFO("Footprint profile %s in use", name.c_str());
+        return true;
+    }
+    ROS_ERROR("Footprint profile %s is not loaded", name.c_str());
+    return false;
+}
+
   void ManeuverNavigation::publishZeroVelocity(){
     geometry_msgs::Twist cmd_vel;
     cmd_vel.linear.x = 0.0;
@@ -159,10 +327,141 @@ void ManeuverNavigation:: cancel()
    publishZeroVelocity();        
    local_nav_state_ = LOC_NAV_IDLE;
    manv_nav_state_   = MANV_NAV_IDLE;
+   {   // The route is dropped, and so is its upcoming goal
+       boost::unique_lock<boost::mutex> lock(next_maneuver_mutex_);
+       next_maneuver_.generation++;
+       next_maneuver_.requested = false;
+       next_maneuver_.ready = false;
+   }
+   {   // A plan being made is dropped
+       boost::unique_lock<boost::mutex> lock(replan_mutex_);
+       replan_.version++;
+       replan_.requested = false;
+       replan_.ready = false;
+   }
    return;
 
 };
 
+void ManeuverNavigation::prepareNextGoal(const maneuver_navigation::Goal& goal)
+{
+    if( !plan_next_maneuver_ )
+        return;
+    boost::unique_lock<boost::mutex> lock(next_maneuver_mutex_);
+    next_maneuver_.goal = goal;
+    // Without a start the next maneuver starts where the current one ends
+    next_maneuver_.start = goal.start.header.frame_id.empty() ? goal_ : goal.start;
+    next_maneuver_.generation++;
+    next_maneuver_.requested = true;
+    next_maneuver_.ready = false;
+    next_maneuver_cond_.notify_all();
+}
+
+void ManeuverNavigation::nextManeuverLoop()
+{
+    boost::unique_lock<boost::mutex> lock(next_maneuver_mutex_);
+    while( true )
+    {
+        while( !next_maneuver_.requested && !next_maneuver_.shutdown )
+            next_maneuver_cond_.wait(lock);
+        if( next_maneuver_.shutdown )
+            return;
+        
+        maneuver_navigation::Goal goal = next_maneuver_.goal;
+        geometry_msgs::PoseStamped start = next_maneuver_.start;
+        unsigned long generation = next_maneuver_.generation;
+        next_maneuver_.requested = false;
+        next_maneuver_.planning = true;
+        lock.unlock();
+        
+        {   // Like the replanning thread, the background planner never reads the costmap while it is updated
+            costmap_2d::Costmap2D* costmap = costmap_ros_->getCostmap();
+            boost::unique_lock<costmap_2d::Costmap2D::mutex_t> costmap_lock(*(costmap->getMutex()));
+            next_maneuver_costmap_ = *costmap;
+        }
+        // The plan is tagged with the version of the footprint it is checked with
+        base_local_planner::FootprintModelConstPtr footprint = footprint_model_->get();
+        next_maneuver_footprint_->set(footprint);
+        unsigned long footprint_version = footprint->version();
+        base_local_planner::CompactPlan next_plan;
+        double dist_before_obs;
+        bool goal_free = next_maneuver_planner_.makePlan(start, goal.goal, next_plan, dist_before_obs, goal.conf.use_line_planner);
+        
+        lock.lock();
+        next_maneuver_.planning = false;
+        if( generation == next_maneuver_.generation )
+        {
+            next_maneuver_.plan.swap(next_plan);
+            next_maneuver_.goal_free = goal_free;
+            next_maneuver_.footprint_version = footprint_version;
+            next_maneuver_.ready = true;
+        }
+        next_maneuver_cond_.notify_all();
+    }
+}
+
+void ManeuverNavigation::initNextManeuverPlanner()
+{
+    {   // The planner keeps pointing at the snapshot, which is taken again for every plan
+        costmap_2d::Costmap2D* costmap = costmap_ros_->getCostmap();
+        boost::unique_lock<costmap_2d::Costmap2D::mutex_t> costmap_lock(*(costmap->getMutex()));
+        next_maneuver_costmap_ = *costmap;
+    }
+    next_maneuver_footprint_.reset(new base_local_planner::SharedFootprintModel(footprint_cache_->numHeadingBins()));
+    next_maneuver_footprint_->set(footprint_model_->get());
+    next_maneuver_planner_ = maneuver_planner::ManeuverPlanner();
+    next_maneuver_planner_.initialize("maneuver_planner", &next_maneuver_costmap_, costmap_ros_->getRobotFootprint(), costmap_ros_->getGlobalFrameID());
+    next_maneuver_planner_.setFootprintModel(next_maneuver_footprint_);
+}
+
+bool ManeuverNavigation::takeNextManeuver(const maneuver_navigation::Goal& goal, base_local_planner::CompactPlan& next_plan)
+{
+    {
+        boost::unique_lock<boost::mutex> lock(next_maneuver_mutex_);
+        const maneuver_navigation::Goal& next_goal = next_maneuver_.goal;
+        if( !next_maneuver_.ready || !next_maneuver_.goal_free || next_maneuver_.plan.empty() ||
+            next_goal.goal.header.frame_id != goal.goal.header.frame_id ||
+            next_goal.goal.pose.position.x != goal.goal.pose.position.x || next_goal.goal.pose.position.y != goal.goal.pose.position.y ||
+            tf::getYaw(next_goal.goal.pose.orientation) != tf::getYaw(goal.goal.pose.orientation) ||
+            next_goal.conf.use_line_planner != goal.conf.use_line_planner )
+            return false;
+        if( next_maneuver_.footprint_version != footprint_model_->get()->version() )
+        {
+            next_maneuver_.ready = false;
+            return false;
+        }
+        next_plan.swap(next_maneuver_.plan);
+        next_maneuver_.ready = false;
+    }
+    
+    // The plan has to start where the robot is, or where the plan it is appended to ends
+    double start_x, start_y;
+    if( append_new_maneuver_ && plan.size() > 0 )
+    {
+        start_x = plan.x(plan.size()-1);
+        start_y = plan.y(plan.size()-1);
+    }
+    else
+    {
+        tf::Stamped<tf::Pose> global_pose;
+        if( !getRobotPose(global_pose) )
+            return false;
+        start_x = global_pose.getOrigin().getX();
+        start_y = global_pose.getOrigin().getY();
+    }
+    if( hypot(next_plan.x(0) - start_x, next_plan.y(0) - start_y) > next_maneuver_start_tolerance_ )
+        return false;
+    
+    // Revalidated pose by pose against the current costmap, without searching
+    footprint_cache_->setFootprintModel(footprint_model_->get());
+    for (size_t i = 0; i < next_plan.size(); i++)
+    {
+        if( footprintCost(next_plan.x(i), next_plan.y(i), next_plan.yaw(i)) < 0 )
+            return false;
+    }
+    return true;
+}
+
 bool ManeuverNavigation::isGoalReachable() 
 {
     return true; // TODO: implement
@@ -179,75 +478,107 @@ double ManeuverNavigation::footprintCost(double x_i, double y_i, double theta_i)
         return -1.0;
     }
 
-    std::vector<geometry_msgs::Point> footprint = costmap_ros_->getRobotFootprint();
-
     //if we have no footprint... do nothing
-    if(footprint.size() < 3)
+    if(!footprint_cache_->hasFootprint())
         return -1.0;
 
-    //check if the footprint is legal
-    double footprint_cost = world_model_->footprintCost(x_i, y_i, theta_i, footprint);
+    //check if the footprint is legal, the footprint templates are updated in checkFootprintOnGlobalPlan
+    double footprint_cost = footprint_cache_->footprintCost(x_i, y_i, theta_i);
     
     return footprint_cost;
 }
 
 
-bool ManeuverNavigation::checkFootprintOnGlobalPlan(const std::vector<geometry_msgs::PoseStamped>& plan, const double& max_ahead_dist, double& dist_before_obs, int &index_closest_to_pose, int &index_before_obs )
+bool ManeuverNavigation::isPlanPoseFree(const base_local_planner::CompactPlan& plan, size_t index, const base_local_planner::FootprintModel& footprint)
+{
+    double x = plan.x(index), y = plan.y(index), yaw = plan.yaw(index);
+    if( !incremental_feasibility_check_ )
+        return footprintCost(x, y, yaw) >= 0;
+    
+    if( pose_checks_.size() != plan.size() )
+        pose_checks_.resize(plan.size());
+    PoseCheck& check = pose_checks_[index];
+    if( check.revision != 0 && check.x == x && check.y == y && check.yaw == yaw &&
+        !costmap_changes_.changedSince(check.revision, check.min_x, check.min_y, check.max_x, check.max_y) )
+        return true;
+    
+    if( footprintCost(x, y, yaw) < 0 )
+    {
+        check.revision = 0;
+        return false;
+    }
+    // Grown by a cell for the rasterization of the footprint
+    double cos_yaw = cos(yaw), sin_yaw = sin(yaw);
+    double margin = costmap_->getResolution();
+    check.x = x;
+    check.y = y;
+    check.yaw = yaw;
+    check.revision = costmap_changes_.revision();
+    check.min_x = check.max_x = x;
+    check.min_y = check.max_y = y;
+    const std::vector<geometry_msgs::Point>& points = footprint.getFootprint();
+    for (size_t k = 0; k < points.size(); k++)
+    {
+        double px = x + cos_yaw*points[k].x - sin_yaw*points[k].y;
+        double py = y + sin_yaw*points[k].x + cos_yaw*points[k].y;
+        check.min_x = std::min(check.min_x, px);
+        check.max_x = std::max(check.max_x, px);
+        check.min_y = std::min(check.min_y, py);
+        check.max_y = std::max(check.max_y, py);
+    }
+    check.min_x -= margin;
+    check.min_y -= margin;
+    check.max_x += margin;
+    check.max_y += margin;
+    return true;
+}
+
+bool ManeuverNavigation::checkFootprintOnGlobalPlan(const base_local_planner::CompactPlan& plan, const double& max_ahead_dist, double& dist_before_obs, int &index_closest_to_pose, int &index_before_obs )
 {
     tf::Stamped<tf::Pose> global_pose;
     if( !getRobotPose(global_pose) )
         return false;    
-    // First find the closes point from the robot pose to the path   
-    double dist_to_path_min = 1e3;
-    double dist_to_path; 
-    tf::Pose pose_temp;
-    tf::Quaternion quat_temp;
-    int index_pose;
-    double yaw, pitch, roll;
-    double x = global_pose.getOrigin().getX();
-    double y = global_pose.getOrigin().getY();
-    int i;
-
-    for (i =0; i < plan.size(); i++) 
+    // Takes the templates of the shared footprint model, they change only in reinitPlanner and setProfile
+    base_local_planner::FootprintModelConstPtr footprint = footprint_model_->get();
+    footprint_cache_->setFootprintModel(footprint);
+    if( incremental_feasibility_check_ )
     {
-        dist_to_path = hypot(plan[i].pose.position.x-x,plan[i].pose.position.y-y);
-        if(dist_to_path < dist_to_path_min)
-        {
-            dist_to_path_min = dist_to_path;
-            index_pose = i; // TODO: Do this in a smarter way, remebering last index. Index needs to be resseted when there is a replan
-        }
-        else
+        boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+        costmap_changes_.update(*costmap_);
+        if( footprint->version() != pose_checks_footprint_version_ )
         {
-            break;
+            pose_checks_.clear();
+            pose_checks_footprint_version_ = footprint->version();
         }
-    }    
+    }
+    // First find the closes point from the robot pose to the path, searched ahead of the one found by the previous check
+    // of the same plan. A new plan is indexed again
+    double x = global_pose.getOrigin().getX();
+    double y = global_pose.getOrigin().getY();
+    int i;
+    if( !plan_progress_.indexes(plan) )
+        plan_progress_.setPlan(plan);
+    int index_pose = plan_progress_.advance(x, y);
     // Now start checking poses in the future up to the desired distance
     double total_ahead_distance = 0.0;
     index_closest_to_pose = index_pose;
     index_before_obs = plan.size()-1;
-    double dist_next_point;
-    double footprint_cost;
     bool is_traj_free = true;
-    tf::Stamped<tf::Pose> pose_from_plan;
+    
+    if (plan.frameId().empty()){
+        // Non valid plan
+        ROS_ERROR("NON VALID PLAN!!!");
+        is_traj_free = false;
+    }
     
     for (i = index_pose; i < plan.size()-2; i++) 
     {
-        dist_next_point = hypot(plan[i].pose.position.x-plan[i+1].pose.position.x,plan[i].pose.position.y-plan[i+1].pose.position.y);
-        total_ahead_distance += dist_next_point;
+        total_ahead_distance = plan.arcLength(i+1) - plan.arcLength(index_pose);
         if( total_ahead_distance < max_ahead_dist)
         {
-            if (plan[i+1].header.frame_id.empty()){
-                // Non valid plan
-                ROS_ERROR("NON VALID PLAN!!!");
-                is_traj_free = false;
-                
-            }
-            tf::poseStampedMsgToTF(plan[i+1],pose_from_plan);             
-            pose_from_plan.getBasis().getEulerYPR(yaw, pitch, roll);
-            footprint_cost = footprintCost(pose_from_plan.getOrigin().getX(), pose_from_plan.getOrigin().getY(), yaw);
-            if( footprint_cost < 0 )
+            if( !isPlanPoseFree(plan, i+1, *footprint) )
             {
-                printf("footprint_cost %f",footprint_cost);
+                ROS_DEBUG("footprint in collision at pose %d", i+1);
                 is_traj_free = false;                
                 index_before_obs = i;
                 break;
@@ -269,6 +600,7 @@ void ManeuverNavigation::callLocalNavigationStateMachine()
     geometry_msgs::Twist cmd_vel;
     tf::Stamped<tf::Pose> global_pose;
     geometry_msgs::PoseStamped feedback_pose;    
+    std::vector<geometry_msgs::PoseStamped> plan_poses;
     
     if( getRobotPose(global_pose) )
     {
@@ -281,7 +613,8 @@ void ManeuverNavigation::callLocalNavigationStateMachine()
             break;
         case LOC_NAV_SET_PLAN:
             
-            if (!local_planner_->setPlan(plan))
+            plan.toPoses(plan_poses);
+            if (!local_planner_->setPlan(plan_poses))
             {
                 ROS_ERROR("Plan not set");
                 local_nav_state_  = LOC_NAV_IDLE;
@@ -297,6 +630,11 @@ void ManeuverNavigation::callLocalNavigationStateMachine()
             {
                 printf("local planner, partial Goal reached!");
                 local_nav_state_ = LOC_NAV_IDLE;
+                if( manv_nav_state_ == MANV_NAV_WAIT_PLAN )
+                {   // End of the part of the old plan driven while the new plan is made
+                    publishZeroVelocity();
+                    break;
+                }
                 tf::Stamped<tf::Pose> goal_pose;
                 tf::poseStampedMsgToTF(goal_,goal_pose);
                 tf::Pose diff_pose;
@@ -328,7 +666,8 @@ void ManeuverNavigation::callLocalNavigationStateMachine()
                 
 //                 publishZeroVelocity();        
                 local_nav_state_ = LOC_NAV_IDLE;
-                manv_nav_state_   = MANV_NAV_MAKE_INIT_PLAN;
+                if( manv_nav_state_ != MANV_NAV_WAIT_PLAN )
+                    manv_nav_state_   = MANV_NAV_MAKE_INIT_PLAN;
             }
             
                   
@@ -354,12 +693,208 @@ bool ManeuverNavigation::getRobotPose(tf::Stamped<tf::Pose> & global_pose)
     return true;
 };
 
+void ManeuverNavigation::spliceAfter(const base_local_planner::CompactPlan& old_plan, base_local_planner::CompactPlan& new_plan)
+{
+    // The new plan keeps its frame and stamp
+    base_local_planner::CompactPlan spliced_plan = old_plan;
+    spliced_plan.append(new_plan);
+    spliced_plan.setFrameId(new_plan.frameId());
+    spliced_plan.setStamp(new_plan.stamp());
+    new_plan.swap(spliced_plan);
+}
+
+bool ManeuverNavigation::makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& new_plan,
+                                  double& dist_before_obs, bool use_line_planner)
+{
+    if( !publish_planner_statistics_ )
+        return maneuver_planner.makePlan(start, goal, new_plan, dist_before_obs, use_line_planner);
+    
+    maneuver_planner::PlanningStatistics statistics;
+    bool plan_free = maneuver_planner.makePlan(start, goal, new_plan, dist_before_obs, use_line_planner, statistics);
+    
+    maneuver_navigation::PlannerStatistics statistics_msg;
+    statistics_msg.header.stamp = ros::Time::now();
+    statistics_msg.header.frame_id = goal.header.frame_id;
+    statistics_msg.maneuver_type = statistics.maneuver_type;
+    statistics_msg.fallback = statistics.fallback;
+    statistics_msg.plan_free = statistics.plan_free;
+    statistics_msg.search_complete = statistics.search_complete;
+    statistics_msg.reference_points = statistics.reference_points;
+    statistics_msg.radius_candidates = statistics.radius_candidates;
+    statistics_msg.midway_candidates = statistics.midway_candidates;
+    statistics_msg.footprint_checks = statistics.footprint_checks;
+    statistics_msg.determine_maneuver_time = statistics.determine_maneuver_time;
+    statistics_msg.generation_time = statistics.generation_time;
+    statistics_msg.collision_check_time = statistics.collision_check_time;
+    statistics_msg.fallback_time = statistics.fallback_time;
+    statistics_msg.total_time = statistics.total_time;
+    pub_planner_statistics_.publish(statistics_msg);
+    return plan_free;
+}
+
+void ManeuverNavigation::setPlanReadyCallback(const boost::function<void()>& callback)
+{
+    boost::unique_lock<boost::mutex> lock(replan_mutex_);
+    plan_ready_callback_ = callback;
+}
+
+void ManeuverNavigation::initReplanPlanner()
+{
+    {   // The planner keeps pointing at the snapshot, which is taken again for every plan
+        costmap_2d::Costmap2D* costmap = costmap_ros_->getCostmap();
+        boost::unique_lock<costmap_2d::Costmap2D::mutex_t> costmap_lock(*(costmap->getMutex()));
+        replan_costmap_ = *costmap;
+    }
+    maneuver_planner = maneuver_planner::ManeuverPlanner();
+    maneuver_planner.initialize("maneuver_planner", &replan_costmap_, costmap_ros_->getRobotFootprint(), costmap_ros_->getGlobalFrameID());
+    maneuver_planner.setFootprintModel(footprint_model_);
+}
+
+void ManeuverNavigation::waitReplanIdle(boost::unique_lock<boost::mutex>& lock)
+{
+    while( replan_.planning )
+        replan_cond_.wait(lock);
+}
+
+void ManeuverNavigation::replanLoop()
+{
+    boost::unique_lock<boost::mutex> lock(replan_mutex_);
+    while( true )
+    {
+        while( !replan_.requested && !replan_.shutdown )
+            replan_cond_.wait(lock);
+        if( replan_.shutdown )
+            return;
+        
+        geometry_msgs::PoseStamped start = replan_.start;
+        geometry_msgs::PoseStamped goal = replan_.goal;
+        bool use_line_planner = replan_.use_line_planner;
+        unsigned long version = replan_.version;
+        replan_.requested = false;
+        replan_.planning = true;
+        lock.unlock();
+        
+        {   // The costmap is only locked for the copy, it keeps being updated while the plan is made
+            costmap_2d::Costmap2D* costmap = costmap_ros_->getCostmap();
+            boost::unique_lock<costmap_2d::Costmap2D::mutex_t> costmap_lock(*(costmap->getMutex()));
+            replan_costmap_ = *costmap;
+        }
+        base_local_planner::CompactPlan new_plan;
+        double dist_before_obs;
+        bool goal_free = makePlan(start, goal, new_plan, dist_before_obs, use_line_planner);
+        
+        lock.lock();
+        replan_.planning = false;
+        if( version == replan_.version )
+        {
+            replan_.plan.swap(new_plan);
+            replan_.goal_free = goal_free;
+            replan_.dist_before_obs = dist_before_obs;
+            replan_.ready = true;
+            if( plan_ready_callback_ )
+                plan_ready_callback_();
+        }
+        replan_cond_.notify_all();
+    }
+}
+
+void ManeuverNavigation::requestPlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal, bool use_line_planner, int reason,
+                                     const base_local_planner::CompactPlan& prefix)
+{
+    replan_reason_ = reason;
+    replan_prefix_ = prefix;
+    {
+        boost::unique_lock<boost::mutex> lock(replan_mutex_);
+        replan_.start = start;
+        replan_.goal = goal;
+        replan_.use_line_planner = use_line_planner;
+        replan_.version++;
+        replan_.requested = true;
+        replan_.ready = false;
+    }
+    replan_cond_.notify_all();
+    manv_nav_state_ = MANV_NAV_WAIT_PLAN;
+    
+    // Meanwhile the robot drives along the free part of the old plan, slowing down towards its end
+    if( prefix.size() > 1 )
+    {
+        std::vector<geometry_msgs::PoseStamped> prefix_poses;
+        prefix.toPoses(prefix_poses);
+        if( local_planner_->setPlan(prefix_poses) )
+        {
+            local_nav_state_ = LOC_NAV_BUSY;
+            return;
+        }
+    }
+    if( reason == REPLAN_OBSTACLE )
+    {
+        publishZeroVelocity();
+        local_nav_state_ = LOC_NAV_IDLE;
+    }
+}
+
+bool ManeuverNavigation::takePlan(double& dist_before_obs)
+{
+    {
+        boost::unique_lock<boost::mutex> lock(replan_mutex_);
+        if( !replan_.ready )
+            return false;
+        plan.swap(replan_.plan);
+        goal_free_ = replan_.goal_free;
+        dist_before_obs = replan_.dist_before_obs;
+        replan_.ready = false;
+    }
+    if( replan_prefix_.size() > 0 )
+        spliceAfter(replan_prefix_, plan);
+    return true;
+}
+
+void ManeuverNavigation::initialPlanMade(double dist_before_obs, maneuver_navigation::Feedback& feedback)
+{
+    std::cout << "Navigation: dist_before_obs " << dist_before_obs << std::endl; 
+    manv_nav_state_ = MANV_NAV_MAKE_INIT_PLAN;  // Planned again until the plan can be executed
+    if( dist_before_obs > MAX_AHEAD_DIST_BEFORE_REPLANNING || goal_free_ == true)
+    {
+        if( plan.size()>0 )
+        {
+            resetTimeoutTimer();
+            simple_goal_ = true; // the structured goal is only the first time is received and succesful                
+            local_nav_state_ = LOC_NAV_SET_PLAN;
+            manv_nav_state_  = MANV_NAV_BUSY;
+        }
+        else
+        {
+            ROS_ERROR("Empty plan");
+        }
+    }
+    else
+    {
+        std::cout <<  "Warning: maneuver_navigation cannot make a plan due to obstacles, inform and keep trying" << std::endl; 
+        publishZeroVelocity();  
+        if (!timer_running_)
+        {
+            startTimeoutTimer();
+        }
+        else if (isTimeoutReached())
+        {
+            resetTimeoutTimer();
+            ROS_ERROR("Maneuver navigation failed due to obstacles");
+            local_nav_state_ = LOC_NAV_IDLE;
+            manv_nav_state_ = MANV_NAV_IDLE;
+            feedback.status = maneuver_navigation::Feedback::FAILURE_OBSTACLES;
+        }
+      //  local_nav_state_ = LOC_NAV_IDLE;
+        // manv_nav_state_   = MANV_NAV_IDLE; 
+    }
+}
+
 maneuver_navigation::Feedback ManeuverNavigation::callManeuverNavigationStateMachine() 
 {
     double dist_before_obs;  
     int index_closest_to_pose;
     int index_before_obs;
-    std::vector<geometry_msgs::PoseStamped> old_plan;  
+    base_local_planner::CompactPlan old_plan;  
+    base_local_planner::CompactPlan next_plan;
     bool is_plan_free;
     maneuver_navigation::Feedback feedback;
     
@@ -392,75 +927,63 @@ maneuver_navigation::Feedback ManeuverNavigation::callManeuverNavigationStateMac
                 goal_ = mn_goal_.goal;
                 start = mn_goal_.start;
             }
-            if(append_new_maneuver_ && plan.size()>0)
-            {
-                // Find first current position on plan and then move certain disctance ahead to make the plan.
-                is_plan_free = checkFootprintOnGlobalPlan(plan, MAX_AHEAD_DIST_BEFORE_REPLANNING, dist_before_obs, index_closest_to_pose, index_before_obs);
-                old_plan.clear();
-                old_plan.insert(old_plan.begin(), plan.begin()+index_closest_to_pose, plan.begin()+index_before_obs);
-                start.pose.position = plan[index_before_obs].pose.position;
-                goal_free_ = maneuver_planner.makePlan(start,goal_, plan, dist_before_obs, mn_goal_.conf.use_line_planner);
-                plan.insert(plan.begin(),old_plan.begin(), old_plan.end());
-            }
-            else
-            {
-                goal_free_ = maneuver_planner.makePlan(start,goal_, plan, dist_before_obs, mn_goal_.conf.use_line_planner);
-            }
-            std::cout << "Navigation: dist_before_obs " << dist_before_obs << std::endl; 
-            if( dist_before_obs > MAX_AHEAD_DIST_BEFORE_REPLANNING || goal_free_ == true)
+            if( !simple_goal_ && takeNextManeuver(mn_goal_, next_plan) )
             {
-                if( plan.size()>0 )
+                // Planned while the previous maneuver was executed, only revalidated here
+                if(append_new_maneuver_ && plan.size()>0)
                 {
-                    resetTimeoutTimer();
-                    simple_goal_ = true; // the structured goal is only the first time is received and succesful                
-                    local_nav_state_ = LOC_NAV_SET_PLAN;
-                    manv_nav_state_  = MANV_NAV_BUSY;
+                    checkFootprintOnGlobalPlan(plan, MAX_AHEAD_DIST_BEFORE_REPLANNING, dist_before_obs, index_closest_to_pose, index_before_obs);
+                    old_plan.clear();
+                    old_plan.append(plan, index_closest_to_pose, plan.size()-1);
+                    plan.swap(next_plan);
+                    spliceAfter(old_plan, plan);
                 }
                 else
                 {
-                    ROS_ERROR("Empty plan");
+                    plan.swap(next_plan);
                 }
+                goal_free_ = true;
+                initialPlanMade(plan.length(), feedback);
+            }
+            else if(append_new_maneuver_ && plan.size()>0)
+            {
+                // Find first current position on plan and then move certain disctance ahead to make the plan.
+                is_plan_free = checkFootprintOnGlobalPlan(plan, MAX_AHEAD_DIST_BEFORE_REPLANNING, dist_before_obs, index_closest_to_pose, index_before_obs);
+                old_plan.clear();
+                old_plan.append(plan, index_closest_to_pose, index_before_obs);
+                start.pose.position.x = plan.x(index_before_obs);
+                start.pose.position.y = plan.y(index_before_obs);
+                requestPlan(start, goal_, mn_goal_.conf.use_line_planner, REPLAN_INIT, old_plan);
             }
             else
             {
-                std::cout <<  "Warning: maneuver_navigation cannot make a plan due to obstacles, inform and keep trying" << std::endl; 
-                publishZeroVelocity();  
-                if (!timer_running_)
-                {
-                    startTimeoutTimer();
-                }
-                else if (isTimeoutReached())
-                {
-                    resetTimeoutTimer();
-                    ROS_ERROR("Maneuver navigation failed due to obstacles");
-                    local_nav_state_ = LOC_NAV_IDLE;
-                    manv_nav_state_ = MANV_NAV_IDLE;
-                    feedback.status = maneuver_navigation::Feedback::FAILURE_OBSTACLES;
-                    return feedback;
-                }
-              //  local_nav_state_ = LOC_NAV_IDLE;
-                // manv_nav_state_   = MANV_NAV_IDLE; 
+                requestPlan(start, goal_, mn_goal_.conf.use_line_planner, REPLAN_INIT, old_plan);
             }
-            
             break;
-         case MANV_NAV_BUSY:
-             is_plan_free = checkFootprintOnGlobalPlan(plan, MAX_AHEAD_DIST_BEFORE_REPLANNING, dist_before_obs, index_closest_to_pose, index_before_obs);
-             if( !is_plan_free)
-             {
-                std::cout << "Navigation: Obstacle in front at " << dist_before_obs << ". Try to replan" << std::endl; 
-                publishZeroVelocity();  // TODO: Do this smarter by decreasing speed while computing new path    
+        case MANV_NAV_WAIT_PLAN:
+            // The local planner keeps running until the requested plan is ready, along the prefix or, without one, the old plan
+            if( local_nav_state_ == LOC_NAV_BUSY && ( replan_prefix_.size() > 1 || plan.size() > 1 ) &&
+                !checkFootprintOnGlobalPlan(replan_prefix_.size() > 1 ? replan_prefix_ : plan, MAX_AHEAD_DIST_BEFORE_REPLANNING,
+                                            dist_before_obs, index_closest_to_pose, index_before_obs) )
+            {   // The plan driven meanwhile got blocked, stop and plan again from where the robot is
+                ROS_WARN("Navigation: Obstacle in front at %f while waiting for the plan. Stop and replan", dist_before_obs);
+                publishZeroVelocity();
+                local_nav_state_ = LOC_NAV_IDLE;
                 if( !getRobotPose(global_pose) )
                     break;
-                tf::poseStampedTFToMsg(global_pose, start);     
-                
-                // Find first current position on plan and then move certain disctance ahead to make the plan.
-                // is_plan_free = checkFootprintOnGlobalPlan(plan, MAX_AHEAD_DIST_BEFORE_REPLANNING, dist_before_obs, index_closest_to_pose, index_before_obs);
-                old_plan.clear();
-                old_plan.insert(old_plan.begin(), plan.begin()+index_closest_to_pose, plan.begin()+index_before_obs);
-                start.pose.position = plan[index_before_obs].pose.position;
-                                         
-                goal_free_ = maneuver_planner.makePlan(start,goal_, plan);
-                plan.insert(plan.begin(),old_plan.begin(), old_plan.end());
+                tf::poseStampedTFToMsg(global_pose, start);
+                requestPlan(start, goal_, replan_reason_ == REPLAN_OBSTACLE ? false : mn_goal_.conf.use_line_planner, replan_reason_, old_plan);
+                break;
+            }
+            if( !takePlan(dist_before_obs) )
+                break;
+            if( replan_reason_ == REPLAN_INIT )
+            {
+                initialPlanMade(dist_before_obs, feedback);
+            }
+            else if( replan_reason_ == REPLAN_OBSTACLE )
+            {
+                manv_nav_state_ = MANV_NAV_BUSY;
                 if(goal_free_)
                 {
                     if( plan.size()>0 )
@@ -480,15 +1003,10 @@ maneuver_navigation::Feedback ManeuverNavigation::callManeuverNavigationStateMac
                    // local_nav_state_ = LOC_NAV_IDLE;
                     manv_nav_state_   = MANV_NAV_MAKE_INIT_PLAN;
                 }                                 
-             }
-             else if (goal_free_ == false && dist_before_obs < (MAX_AHEAD_DIST_BEFORE_REPLANNING)) // When the goal was not free and we are close to end of temporary plan, replan
-             {
-                if( !getRobotPose(global_pose) )
-                    break;
-                
-                tf::poseStampedTFToMsg(global_pose, start);       
-                 std::cout <<  "Aproaching to end of temporary plan, distance " << dist_before_obs <<" m. Make new plan" << std::endl; 
-                goal_free_ = maneuver_planner.makePlan(start,goal_, plan, dist_before_obs, mn_goal_.conf.use_line_planner);            
+            }
+            else
+            {
+                manv_nav_state_ = MANV_NAV_BUSY;
                 if( goal_free_ || dist_before_obs > MAX_AHEAD_DIST_BEFORE_REPLANNING )
                 {
                     if( plan.size()>0 )
@@ -501,6 +1019,33 @@ maneuver_navigation::Feedback ManeuverNavigation::callManeuverNavigationStateMac
                         std::cout << "Error: Empty plan" << std::endl;
                     }                    
                 }              
+            }
+            break;
+         case MANV_NAV_BUSY:
+             is_plan_free = checkFootprintOnGlobalPlan(plan, MAX_AHEAD_DIST_BEFORE_REPLANNING, dist_before_obs, index_closest_to_pose, index_before_obs);
+             if( !is_plan_free)
+             {
+                std::cout << "Navigation: Obstacle in front at " << dist_before_obs << ". Try to replan" << std::endl; 
+                if( !getRobotPose(global_pose) )
+                    break;
+                tf::poseStampedTFToMsg(global_pose, start);     
+                
+                // Find first current position on plan and then move certain disctance ahead to make the plan.
+                // The robot slows down along the free part of the plan while the new plan is made
+                old_plan.clear();
+                old_plan.append(plan, index_closest_to_pose, index_before_obs);
+                start.pose.position.x = plan.x(index_before_obs);
+                start.pose.position.y = plan.y(index_before_obs);
+                requestPlan(start, goal_, false, REPLAN_OBSTACLE, old_plan);
+             }
+             else if (goal_free_ == false && dist_before_obs < (MAX_AHEAD_DIST_BEFORE_REPLANNING)) // When the goal was not free and we are close to end of temporary plan, replan
+             {
+                if( !getRobotPose(global_pose) )
+                    break;
+                
+                tf::poseStampedTFToMsg(global_pose, start);       
+                 std::cout <<  "Aproaching to end of temporary plan, distance " << dist_before_obs <<" m. Make new plan" << std::endl; 
+                requestPlan(start, goal_, mn_goal_.conf.use_line_planner, REPLAN_END_OF_PLAN, old_plan);
              }
              
             break;
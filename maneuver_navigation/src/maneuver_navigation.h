@@ -12,19 +12,27 @@
 #include <costmap_2d/costmap_2d.h>
 #include <base_local_planner/world_model.h>
 #include <base_local_planner/costmap_model.h>
+#include <base_local_planner/footprint_template_cache.h>
+#include <base_local_planner/compact_plan.h>
+#include <base_local_planner/plan_progress_index.h>
 #include <nav_msgs/Path.h>
 
 // Global planner includes
 #include <maneuver_planner/maneuver_planner.h>
+#include <maneuver_planner/costmap_change_tracker.h>
 #include <maneuver_navigation/Goal.h>
 #include <maneuver_navigation/Feedback.h>
 #include <maneuver_navigation/Configuration.h>
+#include <maneuver_navigation/PlannerStatistics.h>
 
 
 
 #include <nav_core/base_local_planner.h>
 #include <pluginlib/class_loader.h>
 
+#include <boost/thread.hpp>
+#include <boost/function.hpp>
+
 
 namespace mn {
     
@@ -41,8 +49,15 @@ class ManeuverNavigation
     enum { MANV_NAV_IDLE = 0,
            MANV_NAV_MAKE_INIT_PLAN,
            MANV_NAV_BUSY,
-           MANV_NAV_DONE
+           MANV_NAV_DONE,
+           MANV_NAV_WAIT_PLAN
          };         
+         
+    // Why a plan was requested, which decides what is done with it when it is ready
+    enum { REPLAN_INIT = 0,
+           REPLAN_OBSTACLE,
+           REPLAN_END_OF_PLAN
+         };
 
 public:
 
@@ -54,26 +69,49 @@ public:
 
     void init();
     void reinitPlanner(const geometry_msgs::Polygon& new_footprint);
+    /**
+     * @brief Prepares the footprint model and the local planner of the robot configuration in the namespace footprint_profiles/<name>,
+     * with the footprint in local_costmap/footprint and the parameters of the local planner. Without the latter the parameters of
+     * the local planner of the node are copied to the profile. Meant to be called at startup
+     */
+    bool loadProfile(const std::string& name);
+    /**
+     * @brief Switches to a profile prepared by loadProfile, e.g. when a load is attached. Unlike reinitPlanner no parameters are
+     * loaded and no costmap layer or planner is reset, the plan being executed is handed to the local planner of the profile
+     */
+    bool setProfile(const std::string& name);
     bool isGoalReachable();
     void cancel() ;
     void publishZeroVelocity();
     
     double footprintCost(double x_i, double y_i, double theta_i);
-    bool   checkFootprintOnGlobalPlan(const std::vector<geometry_msgs::PoseStamped>& plan, const double& max_ahead_dist, double& dist_before_obs, int &index_closest_to_pose, int &index_before_obs);
+    bool   checkFootprintOnGlobalPlan(const base_local_planner::CompactPlan& plan, const double& max_ahead_dist, double& dist_before_obs, int &index_closest_to_pose, int &index_before_obs);
     bool gotoGoal(const geometry_msgs::PoseStamped& goal);
     bool gotoGoal(const maneuver_navigation::Goal& goal);
+    /**
+     * @brief Plans the maneuver of the upcoming route goal in the background while the current one is executed. When the goal
+     * is later sent with gotoGoal, the plan is only revalidated. A new call replaces the previous upcoming goal
+     */
+    void prepareNextGoal(const maneuver_navigation::Goal& goal);
     void callLocalNavigationStateMachine();
     maneuver_navigation::Feedback callManeuverNavigationStateMachine();
+    /**
+     * @brief Called from the planning thread when a plan is ready, so that callManeuverNavigationStateMachine can install it
+     * without waiting for its next period
+     */
+    void setPlanReadyCallback(const boost::function<void()>& callback);
     
     
-   maneuver_planner::ManeuverPlanner  maneuver_planner;   
+   maneuver_planner::ManeuverPlanner  maneuver_planner;   // Used only by the planning thread, on a snapshot of the local costmap
 //    base_local_planner::TrajectoryPlannerROS local_planner;
 //    teb_local_planner::TebLocalPlannerROS local_planner;
-   std::vector<geometry_msgs::PoseStamped> plan;        
+   base_local_planner::CompactPlan plan;     // Converted to poses only when handed to the local planner
    
    costmap_2d::Costmap2DROS* costmap_ros_, * local_costmap_ros;
    costmap_2d::Costmap2D* costmap_;
    base_local_planner::WorldModel* world_model_; ///< @brief The world model that the controller will use  
+   base_local_planner::FootprintTemplateCache* footprint_cache_; ///< @brief Rasterized footprint per heading, updated on every plan check
+   boost::shared_ptr<base_local_planner::SharedFootprintModel> footprint_model_; ///< @brief Footprint shared with the maneuver planner, replaced by reinitPlanner and setProfile
       
 private:      
    double MAX_AHEAD_DIST_BEFORE_REPLANNING;     // TODO: make static const?
@@ -93,11 +131,97 @@ private:
    double xy_goal_tolerance_, yaw_goal_tolerance_;
    ros::Publisher vel_pub_;
    ros::Publisher pub_navigation_fb_;
+   bool publish_planner_statistics_;
+   ros::Publisher pub_planner_statistics_;
    ros::NodeHandle& nh_;
    pluginlib::ClassLoader<nav_core::BaseLocalPlanner> blp_loader_;
    boost::shared_ptr<nav_core::BaseLocalPlanner> local_planner_;
+   // Footprint and local planner of a robot configuration, prepared by loadProfile so that switching is a swap
+   struct Profile
+   {
+       std::string name;
+       geometry_msgs::Polygon footprint;                             // Unpadded, for the local costmap
+       base_local_planner::FootprintModelConstPtr footprint_model;   // Padded like the footprint of the costmap, with its templates
+       boost::shared_ptr<nav_core::BaseLocalPlanner> local_planner;
+       double xy_goal_tolerance, yaw_goal_tolerance;
+   };
+   std::vector<Profile> profiles_;
    
    bool getRobotPose(tf::Stamped<tf::Pose> & global_pose);
+   // Plan poses found free by checkFootprintOnGlobalPlan, checked again only when a costmap cell under their footprint changes
+   struct PoseCheck
+   {
+       double x, y, yaw;
+       unsigned long revision;             // Costmap revision the pose was found free at, 0 when not known
+       double min_x, min_y, max_x, max_y;  // Bounding box of the footprint at the pose
+   };
+   bool incremental_feasibility_check_;
+   maneuver_planner::CostmapChangeTracker costmap_changes_;
+   std::vector<PoseCheck> pose_checks_;    // Indexed like the plan, entries of other poses are not used
+   unsigned long pose_checks_footprint_version_;
+   base_local_planner::PlanProgressIndex plan_progress_;  // Progress of the robot along the plan checked by checkFootprintOnGlobalPlan
+   // Footprint check of a plan pose, skipped when it was found free and nothing changed under it since
+   bool isPlanPoseFree(const base_local_planner::CompactPlan& plan, size_t index, const base_local_planner::FootprintModel& footprint);
+   // Plans from start to goal into new_plan, publishing the statistics of the planner when enabled
+   bool makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& new_plan,
+                 double& dist_before_obs, bool use_line_planner);
+   // Maneuver planning in a thread of its own, the local planner keeps running while a plan is made
+   struct Replan
+   {
+       geometry_msgs::PoseStamped start, goal;
+       bool use_line_planner;
+       base_local_planner::CompactPlan plan;
+       bool goal_free;
+       double dist_before_obs;
+       unsigned long version;              // Incremented by every request, a result is kept only for the latest one
+       bool requested, planning, ready, shutdown;
+   };
+   Replan replan_;
+   costmap_2d::Costmap2D replan_costmap_;  // Snapshot of the local costmap taken for every plan
+   boost::mutex replan_mutex_;
+   boost::condition_variable replan_cond_;
+   boost::thread replan_thread_;
+   boost::function<void()> plan_ready_callback_;
+   int replan_reason_;                                  // Of the plan the state machine waits for
+   base_local_planner::CompactPlan replan_prefix_;     // Part of the old plan the requested plan is appended to
+   void replanLoop();
+   void initReplanPlanner();
+   // Waits until the planning thread is idle, with replan_mutex_ held by lock
+   void waitReplanIdle(boost::unique_lock<boost::mutex>& lock);
+   // Requests a plan from start to goal, while it is made the robot drives along prefix, which the plan is appended to
+   void requestPlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal, bool use_line_planner, int reason,
+                    const base_local_planner::CompactPlan& prefix);
+   // Installs the requested plan if it is ready
+   bool takePlan(double& dist_before_obs);
+   // Starts executing a new initial plan, or keeps trying when the obstacles are too close
+   void initialPlanMade(double dist_before_obs, maneuver_navigation::Feedback& feedback);
+   // Prepends the part of the old plan still ahead of the robot to a new plan
+   void spliceAfter(const base_local_planner::CompactPlan& old_plan, base_local_planner::CompactPlan& new_plan);
+   // Background planning of the upcoming route goal
+   struct NextManeuver
+   {
+       maneuver_navigation::Goal goal;
+       geometry_msgs::PoseStamped start;
+       base_local_planner::CompactPlan plan;
+       bool goal_free;
+       unsigned long footprint_version;    // Footprint model the plan was checked with
+       unsigned long generation;           // Incremented by every request, a result is kept only for the latest one
+       bool requested, planning, ready, shutdown;
+   };
+   bool plan_next_maneuver_;
+   double next_maneuver_start_tolerance_;
+   maneuver_planner::ManeuverPlanner next_maneuver_planner_;   // Used only by next_maneuver_thread_
+   costmap_2d::Costmap2D next_maneuver_costmap_;               // Snapshot of the local costmap taken for every background plan
+   // Model of the footprint_model_ taken for every background plan, a switch while planning does not change the footprint of the plan
+   boost::shared_ptr<base_local_planner::SharedFootprintModel> next_maneuver_footprint_;
+   NextManeuver next_maneuver_;
+   boost::mutex next_maneuver_mutex_;
+   boost::condition_variable next_maneuver_cond_;
+   boost::thread next_maneuver_thread_;
+   void nextManeuverLoop();
+   void initNextManeuverPlanner();
+   // Takes the plan prepared for goal if there is one and it is still valid from the current robot pose or plan
+   bool takeNextManeuver(const maneuver_navigation::Goal& goal, base_local_planner::CompactPlan& next_plan);
    ros::Duration timeout_duration_;
    ros::Time timeout_timer_;
    bool timer_running_;
@@ -9,83 +9,117 @@
 
 
 #include "maneuver_navigation.h"
+#include "command_mailbox.h"
 
 #include <nav_msgs/Path.h>
 
 #include <std_msgs/Bool.h>
-#include <stdlib.h> 
+#include <nav_msgs/Odometry.h>
+#include <nav_msgs/OccupancyGrid.h>
+#include <map_msgs/OccupancyGridUpdate.h>
+#include <algorithm>
+#include <cmath>
 
 
 
 
 
-// std::vector<geometry_msgs::PoseStamped> global_path;
-bool simple_goal_received = false;
-geometry_msgs::PoseStamped simple_goal;
+// Callbacks run on the spinner threads and only post commands, the navigator is used by the main loop alone
+mn::CommandMailbox mailbox;
+
+mn::CommandSlot<geometry_msgs::PoseStamped> simple_goal_slot(mailbox);
 void simpleGoalCallback(const geometry_msgs::PoseStamped::ConstPtr& goal_msg)
 {
     ROS_INFO("new simple goal received");
-    simple_goal = *goal_msg;
-    simple_goal_received = true;
+    simple_goal_slot.post(*goal_msg);
 }
-bool goal_received = false;
-maneuver_navigation::Goal goal;
+
+mn::CommandSlot<maneuver_navigation::Goal> goal_slot(mailbox);
 void goalCallback(const maneuver_navigation::Goal::ConstPtr& goal_msg)
 {
     ROS_INFO("new goal received");
-    goal = *goal_msg;
-    goal_received = true;
+    goal_slot.post(*goal_msg);
+}
+
+mn::CommandSlot<maneuver_navigation::Goal> next_goal_slot(mailbox);
+void nextGoalCallback(const maneuver_navigation::Goal::ConstPtr& goal_msg)
+{
+    ROS_INFO("upcoming goal received");
+    next_goal_slot.post(*goal_msg);
 }
 
-bool cancel_nav = false;
+mn::CommandSlot<bool> cancel_slot(mailbox);
 void cancelCallback(const std_msgs::Bool::ConstPtr& cancel_msg)
 {
     ROS_INFO("Request to cancel navigation");
-    cancel_nav = cancel_msg->data;
+    cancel_slot.post(cancel_msg->data);
 }
 
-bool reinit_planner_withload = false;
-bool reinit_planner_noload = false;
+mn::CommandSlot<bool> load_attached_slot(mailbox);
 void loadAttachedCallback(const std_msgs::Bool::ConstPtr& load_attached_msg)
 {   
-    ROS_INFO("Reinit PLanner");
-    if( load_attached_msg->data == true )
-        reinit_planner_withload = true;
-    else
-        reinit_planner_noload = true;
+    ROS_INFO("Switch footprint profile");
+    load_attached_slot.post(load_attached_msg->data);
 }
 
+// Costmap changes and robot motion trigger the feasibility check of the plan ahead
+mn::CommandSlot<bool> costmap_updated_slot(mailbox);
+void costmapCallback(const nav_msgs::OccupancyGrid::ConstPtr& costmap_msg)
+{
+    costmap_updated_slot.post(true);
+}
+void costmapUpdateCallback(const map_msgs::OccupancyGridUpdate::ConstPtr& update_msg)
+{
+    costmap_updated_slot.post(true);
+}
+
+// Posted by the planning thread of the navigator
+mn::CommandSlot<bool> plan_ready_slot(mailbox);
+void planReadyCallback()
+{
+    plan_ready_slot.post(true);
+}
+
+mn::CommandSlot<geometry_msgs::Point> odom_slot(mailbox);
+void odomCallback(const nav_msgs::Odometry::ConstPtr& odom_msg)
+{
+    odom_slot.post(odom_msg->pose.pose.position);
+}
 
 int main(int argc, char** argv)
 {
     ros::init(argc, argv, "route_navigation");
     ros::NodeHandle n("~");    
+    ros::NodeHandle global_nh;
     
-    double prediction_feasibility_check_rate, prediction_feasibility_check_period, prediction_feasibility_check_cycle_time = 0.0;
+    double prediction_feasibility_check_rate, prediction_feasibility_check_period;
     double local_navigation_rate, local_navigation_period;    
-    
-    std::string default_ropod_navigation_param_file;
-    std::string default_ropod_load_navigation_param_file;
+    double feasibility_check_distance;
+    double min_feasibility_check_period;
+    int callback_threads;
 
 
     n.param<double>("prediction_feasibility_check_rate", prediction_feasibility_check_rate, 3.0);    
     n.param<double>("local_navigation_rate", local_navigation_rate, 10.0); // local_navigation_rate>prediction_feasibility_check_rate    
-    n.param<std::string>("default_ropod_navigation_param_file", default_ropod_navigation_param_file, 
-                         std::string("") ); 
-//                          std::string("~/ropod-project-software/catkin_workspace/src/functionalities/ros_structured_nav/maneuver_navigation/config/footprint_local_planner_params_ropod.yaml") ); 
-    n.param<std::string>("default_ropod_load_navigation_param_file", default_ropod_load_navigation_param_file, 
-                         std::string("") ); 
-//                          std::string("~/ropod-project-software/catkin_workspace/src/functionalities/ros_structured_nav/maneuver_navigation/config/footprint_local_planner_params_ropod_load.yaml") ); 
+    // Distance driven after which the plan ahead is checked again, without waiting for the next periodic check
+    n.param<double>("feasibility_check_distance", feasibility_check_distance, 0.1);
+    // Events only trigger the state machine this long after its previous run, so a failing plan is not retried at the costmap rate
+    n.param<double>("min_feasibility_check_period", min_feasibility_check_period, 0.1);
+    n.param<int>("callback_threads", callback_threads, 1);
     
     
-    ros::Rate rate(local_navigation_rate);
     prediction_feasibility_check_period = 1.0/prediction_feasibility_check_rate;
     local_navigation_period = 1.0/local_navigation_rate;
     
     ros::Subscriber goal_cmd_sub = n.subscribe<geometry_msgs::PoseStamped>("/route_navigation/simple_goal", 10, simpleGoalCallback);
     ros::Subscriber mn_sendGoal_pub_ = n.subscribe<maneuver_navigation::Goal> ("/route_navigation/goal", 10,goalCallback);
+    ros::Subscriber next_goal_sub = n.subscribe<maneuver_navigation::Goal> ("/route_navigation/next_goal", 10, nextGoalCallback);
     ros::Subscriber cancel_cmd_sub = n.subscribe<std_msgs::Bool>("/route_navigation/cancel", 10, cancelCallback);
     ros::Subscriber reinit_planner_sub = n.subscribe<std_msgs::Bool>("/route_navigation/set_load_attached", 10, loadAttachedCallback);
+    // Published by the local costmap when its publish_frequency is set
+    ros::Subscriber costmap_sub = n.subscribe<nav_msgs::OccupancyGrid>("local_costmap/costmap", 1, costmapCallback);
+    ros::Subscriber costmap_update_sub = n.subscribe<map_msgs::OccupancyGridUpdate>("local_costmap/costmap_updates", 1, costmapUpdateCallback);
+    ros::Subscriber odom_sub = global_nh.subscribe<nav_msgs::Odometry>("odom", 1, odomCallback);
    // ros::Publisher  reinit_localcostmap_footprint_sub = n.advertise<geometry_msgs::Polygon>("/maneuver_navigation/local_costmap/footprint", 1);
     ros::Publisher  goal_visualisation_pub_ = n.advertise<geometry_msgs::PoseStamped>("/maneuver_navigation/goal_rviz", 1);
     ros::Publisher feedback_pub_ = n.advertise<maneuver_navigation::Feedback>("/route_navigation/feedback", 1);
@@ -94,39 +128,87 @@ int main(int argc, char** argv)
     tf::TransformListener tf( ros::Duration(10) );
     mn::ManeuverNavigation maneuver_navigator(tf,n);
     maneuver_navigator.init();
+    maneuver_navigator.setPlanReadyCallback(planReadyCallback);
+    // Both robot configurations are ready before the first goal, attaching a load only swaps them
+    if( !maneuver_navigator.loadProfile("ropod") || !maneuver_navigator.loadProfile("ropod_load") )
+    {
+        ROS_FATAL("Failed to load the footprint profiles");
+        return 1;
+    }
 
-
-    nav_msgs::Path path_msg;
-    std::string load_param_str;
+    // Callbacks, also those of the costmap and the local planner, are served while the loop plans or sleeps
+    ros::AsyncSpinner spinner(std::max(callback_threads, 1));
+    spinner.start();
 
     ROS_INFO("Wait for goal");
     
+    geometry_msgs::PoseStamped simple_goal;
+    maneuver_navigation::Goal goal;
+    maneuver_navigation::Goal next_goal;
+    bool cancel_nav, load_attached, costmap_updated, plan_ready;
+    geometry_msgs::Point odom_position, checked_position;
+    bool checked_position_valid = false;
+    // All the deadlines are on the ROS clock, the simulated one under use_sim_time
+    ros::Time next_control_time = ros::Time::now();
+    ros::Time next_feasibility_check_time = next_control_time;
+    ros::Time last_feasibility_check_time;
+    bool check_feasibility = false;     // Kept until the check is run, when it was triggered too soon after the previous one
     while(n.ok())
     {
-        prediction_feasibility_check_cycle_time += local_navigation_period;
-        // Execute local navigation
-        maneuver_navigator.callLocalNavigationStateMachine();
-        // the local result is SUCCESS when maneuver_nav reaches the final goal (i.e. not just the local one)
-        if (simple_goal_received)
+        // Sleep until the next velocity command or the check waiting for the minimum period is due, or until a callback posts a command
+        ros::Time wake_time = std::min(next_control_time, ros::Time::now() + ros::Duration(local_navigation_period));
+        if( check_feasibility )
+            wake_time = std::min(wake_time, last_feasibility_check_time + ros::Duration(min_feasibility_check_period));
+        mailbox.waitUntil(wake_time);
+        
+        bool new_goal = false;
+        if (simple_goal_slot.take(simple_goal))
         {
-            simple_goal_received = false;             
             maneuver_navigator.gotoGoal(simple_goal);
             goal_visualisation_pub_.publish(simple_goal);
-            prediction_feasibility_check_cycle_time = prediction_feasibility_check_period;
+            new_goal = true;
         }   
         
-        if (goal_received)
+        if (goal_slot.take(goal))
         {
-            goal_received = false;             
             maneuver_navigator.gotoGoal(goal);
             goal_visualisation_pub_.publish(goal.goal);
-            prediction_feasibility_check_cycle_time = prediction_feasibility_check_period;
+            new_goal = true;
         }          
         
-        // Execute route navigation
-        if( prediction_feasibility_check_cycle_time > prediction_feasibility_check_period)
+        if (next_goal_slot.take(next_goal))
+            maneuver_navigator.prepareNextGoal(next_goal);
+        
+        if (load_attached_slot.take(load_attached))
+            maneuver_navigator.setProfile(load_attached ? "ropod_load" : "ropod");
+        
+        if (cancel_slot.take(cancel_nav) && cancel_nav)
+            maneuver_navigator.cancel();
+        
+        if (costmap_updated_slot.take(costmap_updated))
+            check_feasibility = true;
+        
+        // A plan requested by the state machine is installed right away
+        if (plan_ready_slot.take(plan_ready))
+            check_feasibility = true;
+        
+        if (odom_slot.take(odom_position))
         {
-            prediction_feasibility_check_cycle_time = 0.0;
+            if( !checked_position_valid || hypot(odom_position.x - checked_position.x, odom_position.y - checked_position.y) > feasibility_check_distance )
+                check_feasibility = true;
+        }
+        
+        // Execute route navigation, at the latest every prediction_feasibility_check_period. Only a new goal is handled
+        // before min_feasibility_check_period passed, the retries and the timeouts of the state machine keep that pace
+        ros::Time now = ros::Time::now();
+        bool min_period_passed = now >= last_feasibility_check_time + ros::Duration(min_feasibility_check_period);
+        if( new_goal || ( min_period_passed && ( check_feasibility || now >= next_feasibility_check_time ) ) )
+        {
+            check_feasibility = false;
+            last_feasibility_check_time = now;
+            next_feasibility_check_time = now + ros::Duration(prediction_feasibility_check_period);
+            checked_position = odom_position;
+            checked_position_valid = true;
             maneuver_navigation::Feedback feedback = maneuver_navigator.callManeuverNavigationStateMachine();
             if (feedback.status != maneuver_navigation::Feedback::BUSY &&
                 feedback.status != maneuver_navigation::Feedback::IDLE)
@@ -135,68 +217,21 @@ int main(int argc, char** argv)
             }
         }
         
-        
-        if(reinit_planner_withload)
+        // Execute local navigation, velocity commands keep the fixed period of local_navigation_rate
+        now = ros::Time::now();
+        if( now >= next_control_time )
         {
-            reinit_planner_withload = false;
-            // TODO:: Read load footprint from file and do it asynchronously for not interrupting the therad. 0.01 is to avoid infeseability
-            geometry_msgs::Polygon new_footprint;
-            geometry_msgs::Point32 point_footprint;
-            
-            load_param_str = "rosparam load "+ default_ropod_load_navigation_param_file +  " maneuver_navigation";
-            system(load_param_str.c_str());
-            std::vector<geometry_msgs::Point> new_footprint_vector;
-            XmlRpc::XmlRpcValue footprint_xmlrpc;
-            n.getParam("local_costmap/footprint", footprint_xmlrpc);                        
-            new_footprint_vector = costmap_2d::makeFootprintFromXMLRPC(footprint_xmlrpc, "TebLocalPlannerROS/footprint_model/vertices");
-            costmap_2d::padFootprint(new_footprint_vector,-0.01);
-            for (std::vector<geometry_msgs::Point>::iterator it = new_footprint_vector.begin(); it != new_footprint_vector.end(); it++)
+            maneuver_navigator.callLocalNavigationStateMachine();
+            next_control_time += ros::Duration(local_navigation_period);
+            if( next_control_time < now )
             {
-                point_footprint.x = (*it).x; point_footprint.y =  (*it).y; point_footprint.z = 0.0;            
-                new_footprint.points.push_back(point_footprint);        
-                ROS_INFO("Footprint %f, %f", point_footprint.x, point_footprint.y);
+                ROS_WARN("Control loop missed its desired rate of %.4fHz... the loop is %.4f seconds late", local_navigation_rate, (now - next_control_time).toSec());
+                next_control_time = now + ros::Duration(local_navigation_period);
             }
-            maneuver_navigator.reinitPlanner(new_footprint);  // Dynamic reconfigurationdid not work so we had to do it in two ways. The localcostmap
-            // was updated directly with functins, and the tebplanner by setting firts the parameters and then reloading the planner
-
-        }           
-        
-        if(reinit_planner_noload)
-        {
-            reinit_planner_noload = false;
-            geometry_msgs::Polygon new_footprint;
-            geometry_msgs::Point32 point_footprint;
-                    
-            load_param_str = "rosparam load "+ default_ropod_navigation_param_file +  " maneuver_navigation";
-            system(load_param_str.c_str());
-            std::vector<geometry_msgs::Point> new_footprint_vector;
-            XmlRpc::XmlRpcValue footprint_xmlrpc;
-            n.getParam("local_costmap/footprint", footprint_xmlrpc);            
-            new_footprint_vector = costmap_2d::makeFootprintFromXMLRPC(footprint_xmlrpc, "TebLocalPlannerROS/footprint_model/vertices");
-            costmap_2d::padFootprint(new_footprint_vector,-0.01);
-            for (std::vector<geometry_msgs::Point>::iterator it = new_footprint_vector.begin(); it != new_footprint_vector.end(); it++)
-            {
-                point_footprint.x = (*it).x; point_footprint.y =  (*it).y; point_footprint.z = 0.0;            
-                new_footprint.points.push_back(point_footprint);     
-            }
-            maneuver_navigator.reinitPlanner(new_footprint);  // Dynamic reconfigurationdid not work so we had to do it in two ways. The localcostmap
-            // was updated directly with functins, and the tebplanner by setting first the parameters and then reloading the planner            
-        }
-        
-        if(cancel_nav)
-        {
-            cancel_nav = false;
-            maneuver_navigator.cancel();
         }
-
-        ros::spinOnce();
-        rate.sleep();
-        if(rate.cycleTime() > ros::Duration(local_navigation_period) )
-            ROS_WARN("Control loop missed its desired rate of %.4fHz... the loop actually took %.4f seconds", local_navigation_rate, rate.cycleTime().toSec());
-
     }
 
-
+    spinner.stop();
 
     return 0;
 }
@@ -0,0 +1,134 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "../src/command_mailbox.h"
+
+namespace mn
+{
+
+TEST(CommandSlotTest, latestCommandWins)
+{
+    CommandMailbox mailbox;
+    CommandSlot<int> slot(mailbox);
+    int command = 0;
+    EXPECT_FALSE(slot.take(command));
+
+    slot.post(1);
+    slot.post(2);
+    slot.post(3);
+    ASSERT_TRUE(slot.take(command));
+    EXPECT_EQ(3, command);
+    // A command is taken once
+    EXPECT_FALSE(slot.take(command));
+}
+
+static const int NUM_POSTS = 20000;
+
+static void postSequence(CommandSlot<int>* slot, int producer)
+{
+    for( int i = 0; i < NUM_POSTS; ++i )
+        slot->post(producer * NUM_POSTS + i);
+}
+
+static void takeUntilDone(CommandSlot<int>* slot, boost::atomic<bool>* done, std::vector<int>* taken)
+{
+    int command;
+    while( !done->load() )
+    {
+        if( slot->take(command) )
+            taken->push_back(command);
+    }
+}
+
+TEST(CommandSlotTest, concurrentPostsNeverGoBack)
+{
+    const int num_producers = 4;
+    CommandMailbox mailbox;
+    CommandSlot<int> slot(mailbox);
+    boost::atomic<bool> done(false);
+    std::vector<int> taken;
+    boost::thread consumer(boost::bind(&takeUntilDone, &slot, &done, &taken));
+    boost::thread_group producers;
+    for( int producer = 0; producer < num_producers; ++producer )
+        producers.create_thread(boost::bind(&postSequence, &slot, producer));
+    producers.join_all();
+    done = true;
+    consumer.join();
+
+    // Commands of one producer are taken in the order they were posted, replaced ones are skipped
+    std::vector<int> last(num_producers, -1);
+    for( size_t i = 0; i < taken.size(); ++i )
+    {
+        int producer = taken[i] / NUM_POSTS;
+        ASSERT_GE(producer, 0);
+        ASSERT_LT(producer, num_producers);
+        EXPECT_GT(taken[i], last[producer]);
+        last[producer] = taken[i];
+    }
+
+    // What is left is the last command of one of the producers
+    int command;
+    if( slot.take(command) )
+        EXPECT_EQ(NUM_POSTS - 1, command % NUM_POSTS);
+    else
+        EXPECT_FALSE(taken.empty());
+    EXPECT_FALSE(slot.take(command));
+}
+
+TEST(CommandMailboxTest, notifiedBeforeWaiting)
+{
+    CommandMailbox mailbox;
+    mailbox.notify();
+    ros::Time start = ros::Time::now();
+    EXPECT_TRUE(mailbox.waitUntil(start + ros::Duration(5.0)));
+    EXPECT_LT((ros::Time::now() - start).toSec(), 1.0);
+
+    // The notification was consumed by the first wait
+    EXPECT_FALSE(mailbox.waitUntil(ros::Time::now() + ros::Duration(0.01)));
+}
+
+TEST(CommandMailboxTest, waitsUntilTheDeadline)
+{
+    CommandMailbox mailbox;
+    ros::Time deadline = ros::Time::now() + ros::Duration(0.05);
+    EXPECT_FALSE(mailbox.waitUntil(deadline));
+    EXPECT_GE(ros::Time::now().toSec(), deadline.toSec());
+
+    // A deadline in the past does not wait
+    EXPECT_FALSE(mailbox.waitUntil(ros::Time::now() - ros::Duration(1.0)));
+}
+
+static void postLater(CommandSlot<int>* slot, int command)
+{
+    boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+    slot->post(command);
+}
+
+TEST(CommandMailboxTest, postWakesTheWait)
+{
+    CommandMailbox mailbox;
+    CommandSlot<int> slot(mailbox);
+    ros::Time start = ros::Time::now();
+    boost::thread producer(boost::bind(&postLater, &slot, 7));
+    EXPECT_TRUE(mailbox.waitUntil(start + ros::Duration(5.0)));
+    EXPECT_LT((ros::Time::now() - start).toSec(), 1.0);
+    producer.join();
+
+    int command = 0;
+    ASSERT_TRUE(slot.take(command));
+    EXPECT_EQ(7, command);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    ros::Time::init();
+    return RUN_ALL_TESTS();
+}
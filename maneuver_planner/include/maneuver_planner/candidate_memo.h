@@ -0,0 +1,98 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#ifndef CANDIDATE_MEMO_H_
+#define CANDIDATE_MEMO_H_
+
+#include <map>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <costmap_2d/costmap_2d.h>
+#include <geometry_msgs/Point.h>
+#include <maneuver_planner/costmap_change_tracker.h>
+
+namespace maneuver_planner{
+  /**
+   * @brief Outcome of checking one trajectory segment
+   */
+  struct CandidateMemoEntry
+  {
+      bool traj_free;
+      int collision_pose;                    // Index in the segment of the first colliding pose, -1 when not known
+      double min_x, min_y, max_x, max_y;     // Bounding box of the swept footprint in world coordinates
+      unsigned long revision;                // Costmap revision the segment was checked at
+  };
+
+  /**
+   * @class CandidateMemo
+   * @brief Remembers the outcome of checked trajectory segments, keyed by their exact parameters: a segment that differs
+   * by any amount sweeps other cells, so its outcome is never taken from a neighbour.
+   * An entry is only returned while the costmap cells inside its bounding box stay unchanged.
+   */
+  class CandidateMemo{
+    public:
+      typedef std::vector<double> Key;
+
+      /**
+       * @brief  Constructor for the CandidateMemo
+       * @param max_entries The memo is emptied when it grows beyond this size
+       */
+      CandidateMemo(size_t max_entries);
+
+      /**
+       * @brief  Takes the changes of the costmap since the previous update. All entries are dropped when the footprint changed
+       */
+      void update(const costmap_2d::Costmap2D& costmap, const std::vector<geometry_msgs::Point>& footprint);
+
+      /**
+       * @brief  Finds the entry of a key, if the costmap inside its bounding box did not change since it was stored
+       */
+      bool lookup(const Key& key, CandidateMemoEntry& entry) const;
+
+      /**
+       * @brief  Stores an entry, stamped with the current costmap revision
+       */
+      void store(const Key& key, const CandidateMemoEntry& entry);
+
+    private:
+      size_t max_entries_;
+      CostmapChangeTracker change_tracker_;
+      std::vector<geometry_msgs::Point> footprint_;
+      std::map<Key, CandidateMemoEntry> entries_;
+      mutable boost::mutex mutex_;   // Candidates are checked concurrently in the parallel search
+  };
+};
+#endif
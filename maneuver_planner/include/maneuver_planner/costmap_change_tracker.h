@@ -0,0 +1,98 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#ifndef COSTMAP_CHANGE_TRACKER_H_
+#define COSTMAP_CHANGE_TRACKER_H_
+
+#include <vector>
+#include <costmap_2d/costmap_2d.h>
+
+namespace maneuver_planner{
+  /**
+   * @class CostmapChangeTracker
+   * @brief Keeps a revision number per square tile of the costmap, raised whenever a cell of the tile changes.
+   * Changes are found by comparing the costmap with a copy taken at the previous update. When a rolling window
+   * moves, only the cells that entered the map change.
+   */
+  class CostmapChangeTracker{
+    public:
+      /**
+       * @brief  Constructor for the CostmapChangeTracker
+       * @param tile_size Side of the tiles in cells
+       */
+      CostmapChangeTracker(unsigned int tile_size = 16);
+
+      /**
+       * @brief  Compares the costmap with the copy of the previous update. A change of size or resolution, or a move of the origin
+       * by a fraction of a cell, changes all the tiles
+       * @return The current revision
+       */
+      unsigned long update(const costmap_2d::Costmap2D& costmap);
+
+      unsigned long revision() const { return revision_; }
+
+      /**
+       * @brief  Revision of the last change of size, resolution or origin that changed every cell
+       */
+      unsigned long resetRevision() const { return reset_revision_; }
+
+      /**
+       * @brief  Whether a cell in the given range changed after a revision. The range is in cells and may exceed the map
+       */
+      bool changedSince(unsigned long revision, int min_x, int min_y, int max_x, int max_y) const;
+
+      /**
+       * @brief  Whether a cell in the given range changed after a revision. The range is in world coordinates
+       */
+      bool changedSince(unsigned long revision, double min_wx, double min_wy, double max_wx, double max_wy) const;
+
+    private:
+      /**
+       * @brief  Moves the snapshot and the tiles with an origin that moved by whole cells
+       */
+      void shift(int cells_x, int cells_y, const costmap_2d::Costmap2D& costmap);
+
+      unsigned int tile_size_;
+      unsigned int size_x_, size_y_;
+      unsigned int tiles_x_, tiles_y_;
+      double resolution_, origin_x_, origin_y_;
+      std::vector<unsigned char> snapshot_;
+      std::vector<unsigned long> tile_revision_;
+      unsigned long revision_;
+      unsigned long reset_revision_;   // Revision of the last change that changed every cell
+  };
+};
+#endif
@@ -0,0 +1,166 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#ifndef DUBLIN_TRAJECTORY_H_
+#define DUBLIN_TRAJECTORY_H_
+
+#include <math.h>
+#include <angles/angles.h>
+#include <maneuver_planner/se2.h>
+
+namespace maneuver_planner{
+  /**
+   * @brief Parameters of one straight-circle-straight segment of a reference point trajectory.
+   * The segment starts at offset, given in the start position of the reference point coordinate frame.
+   */
+  struct DublinSegment
+  {
+      double dist_before_steering;
+      double dist_after_steering;
+      double signed_turning_radius;
+      double theta_goal;
+      SE2 offset;
+      bool skip_first_pose;     // Used when chaining segments, the first pose coincides with the end of the previous one
+
+      DublinSegment() : dist_before_steering(0.0), dist_after_steering(0.0), signed_turning_radius(0.0), theta_goal(0.0),
+                        skip_first_pose(false) {}
+
+      /**
+       * @brief Length of the reference point trajectory
+       */
+      double length() const
+      {
+          return dist_before_steering + std::abs(signed_turning_radius*theta_goal) + dist_after_steering;
+      }
+
+      /**
+       * @brief Part of the segment covered after distance, between 0 and 1
+       */
+      double completedFraction(double distance) const
+      {
+          double total_length = length();
+          if( total_length <= 0.0 )
+              return 1.0;
+          return std::min(1.0, std::max(0.0, distance/total_length));
+      }
+  };
+
+  /**
+   * @class DublinTrajectoryGenerator
+   * @brief Produces the poses of a DublinSegment one at a time, every step_size, without storing them
+   */
+  class DublinTrajectoryGenerator{
+    public:
+      DublinTrajectoryGenerator(const DublinSegment& segment, double step_size) :
+          segment_(segment), step_size_(step_size), x_(0.0), y_(0.0), theta_traj_(0.0),
+          dist_bef_steer_(0.0), dist_af_steer_(0.0), first_pose_(true), on_arc_(false)
+      {
+          theta_traj_gridsz_ = step_size_/segment_.signed_turning_radius; // Gridsize of the trajectory angle
+          if(theta_traj_gridsz_ < 0)
+              theta_goal_internal_ = - std::abs(segment_.theta_goal);
+          else
+              theta_goal_internal_ = std::abs(segment_.theta_goal);
+      }
+
+      /**
+       * @brief  Computes the next pose of the segment
+       * @param x The x position of the reference point
+       * @param y The y position of the reference point
+       * @param theta The orientation of the reference point
+       * @return False when the segment is finished
+       */
+      bool next(double& x, double& y, double& theta)
+      {
+          if( !advance() )
+              return false;
+          if( first_pose_ && segment_.skip_first_pose )
+          {
+              first_pose_ = false;
+              if( !advance() )
+                  return false;
+          }
+          first_pose_ = false;
+          segment_.offset.transformPoint(x_, y_, x, y);
+          theta = angles::normalize_angle(segment_.offset.theta() + theta_traj_);
+          return true;
+      }
+
+      /**
+       * @brief  Whether the last pose returned by next lies on the circle
+       */
+      bool onArc() const { return on_arc_; }
+
+    private:
+      bool advance()
+      {
+          on_arc_ = false;
+          if( dist_bef_steer_ <  segment_.dist_before_steering)
+          {   // Move straight before steering
+              theta_traj_ = 0;
+              x_ += step_size_;
+              dist_bef_steer_ += step_size_;
+          }
+          else if(std::abs(theta_goal_internal_-theta_traj_) > std::abs(theta_traj_gridsz_/2.0))
+          {   // Turn with circle. This can be as well a clothoid!
+              theta_traj_ += theta_traj_gridsz_;
+              on_arc_ = true;
+              x_ = segment_.dist_before_steering + segment_.signed_turning_radius*std::sin(theta_traj_);
+              y_ = segment_.signed_turning_radius*(1.0 - std::cos(theta_traj_));
+          }
+          else if( dist_af_steer_ <  segment_.dist_after_steering)
+          {   // Move straight after steering
+              theta_traj_ = theta_goal_internal_;
+              x_ += step_size_*std::cos(theta_traj_);
+              y_ += step_size_*std::sin(theta_traj_);
+              dist_af_steer_ += step_size_;
+          }
+          else
+          {
+              return false;
+          }
+          return true;
+      }
+
+      DublinSegment segment_;
+      double step_size_;
+      double x_, y_, theta_traj_;
+      double theta_traj_gridsz_, theta_goal_internal_;
+      double dist_bef_steer_, dist_af_steer_;
+      bool first_pose_;
+      bool on_arc_;
+  };
+};
+#endif
@@ -49,8 +49,23 @@
 
 #include <base_local_planner/world_model.h>
 #include <base_local_planner/costmap_model.h>
+#include <base_local_planner/distance_field_model.h>
+#include <base_local_planner/footprint_model.h>
+#include <base_local_planner/footprint_template_cache.h>
+#include <base_local_planner/compact_plan.h>
 
 #include <maneuver_planner/parameter_generator.h>
+#include <maneuver_planner/worker_pool.h>
+#include <maneuver_planner/dublin_trajectory.h>
+#include <maneuver_planner/se2.h>
+#include <maneuver_planner/candidate_memo.h>
+#include <maneuver_planner/planning_statistics.h>
+#include <maneuver_planner/swept_area.h>
+#include <maneuver_planner/plan_record.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/tss.hpp>
 
 #include <math.h>
 #include <Eigen/Dense>
@@ -80,6 +95,16 @@ namespace maneuver_planner{
        */
       void initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros);
 
+      /**
+       * @brief  Initialization function for the ManeuverPlanner without a ROS wrapper of the costmap, e.g. for offline benchmarks
+       * @param  name The name of this planner
+       * @param  costmap The costmap to use for planning, it must outlive the planner
+       * @param  footprint_spec The footprint of the robot
+       * @param  global_frame The frame the start and goal poses are given in
+       */
+      void initialize(std::string name, costmap_2d::Costmap2D* costmap,
+                      const std::vector<geometry_msgs::Point>& footprint_spec, const std::string& global_frame);
+
       /**
        * @brief Given a goal pose in the world, compute a plan
        * @param start The start pose 
@@ -93,12 +118,87 @@ namespace maneuver_planner{
           const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles);
       bool makePlan(const geometry_msgs::PoseStamped& start, 
           const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles, bool uselinePlanner);    
+      /**
+       * @brief Given a goal pose in the world, compute a plan within a time budget. Candidates are explored in priority order,
+       * when the deadline passes the search stops and reports what it found so far, like a search that found no free plan does
+       * @param deadline Wall time at which the search stops, zero for no deadline
+       * @param search_complete Set to false when the search was stopped by the deadline
+       * @return True if a valid plan was found, false otherwise
+       */
+      bool makePlan(const geometry_msgs::PoseStamped& start, 
+          const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles,
+          const ros::WallTime& deadline, bool& search_complete);
+      /**
+       * @brief The makePlan variants for callers that keep the plan as a CompactPlan, with the frame and stamp of the goal
+       */
+      bool makePlan(const geometry_msgs::PoseStamped& start, 
+          const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& plan, double & dist_without_obstacles);
+      bool makePlan(const geometry_msgs::PoseStamped& start, 
+          const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& plan, double & dist_without_obstacles, bool uselinePlanner);
+      bool makePlan(const geometry_msgs::PoseStamped& start, 
+          const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& plan, double & dist_without_obstacles,
+          const ros::WallTime& deadline, bool& search_complete);
+      /**
+       * @brief The makePlan variants that also report how the plan was found. Statistics are only collected for these calls
+       * @param statistics Filled by the planner
+       */
+      bool makePlan(const geometry_msgs::PoseStamped& start, 
+          const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& plan, double & dist_without_obstacles, bool uselinePlanner,
+          PlanningStatistics& statistics);
+      bool makePlan(const geometry_msgs::PoseStamped& start, 
+          const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& plan, double & dist_without_obstacles,
+          const ros::WallTime& deadline, bool& search_complete, PlanningStatistics& statistics);
       
+      /**
+       * @brief Outcome of one goal of a batch query
+       */
+      struct GoalFeasibility
+      {
+          bool feasible;                  // A goal-free plan was found
+          double dist_without_obstacles;
+          bool search_complete;           // False when the search was stopped by max_planning_time
+          base_local_planner::CompactPlan plan;   // Only filled when the plans are requested
+      };
+      
+      /**
+       * @brief Plans from one start to each of several candidate goals, e.g. to rank alternative waypoints or lane offsets.
+       * The costmap, footprint and memo are updated once for all the goals
+       * @param results One result per goal, in the same order
+       * @param keep_plans When false only the feasibility and distances are reported
+       * @return True if all the goals are feasible
+       */
+      bool checkGoals(const geometry_msgs::PoseStamped& start, const std::vector<geometry_msgs::PoseStamped>& goals,
+                      std::vector<GoalFeasibility>& results, bool keep_plans = false);
+      /**
+       * @brief Like checkGoals, but for a chain of waypoints: every leg starts at the previous waypoint. Legs after an infeasible one are still checked
+       */
+      bool checkWaypoints(const geometry_msgs::PoseStamped& start, const std::vector<geometry_msgs::PoseStamped>& waypoints,
+                          std::vector<GoalFeasibility>& results, bool keep_plans = false);
+      
+      /**
+       * @brief  Number of footprint checks done by this planner and its copies since initialization
+       */
+      unsigned long getFootprintChecks() const;
+      
+      /**
+       * @brief  Plans with the footprint of a model shared with the caller instead of the footprint of the costmap.
+       * A footprint installed in the shared model is used from the next plan on
+       */
+      void setFootprintModel(const boost::shared_ptr<base_local_planner::SharedFootprintModel>& footprint_model);
+      const boost::shared_ptr<base_local_planner::SharedFootprintModel>& getFootprintModel() const { return shared_footprint_; }
+
       costmap_2d::Costmap2DROS* costmap_ros_;
     private:
       double step_size_, min_dist_from_robot_;
       costmap_2d::Costmap2D* costmap_;
+      boost::shared_ptr<base_local_planner::SharedFootprintModel> shared_footprint_;   // Current footprint of the robot
+      bool footprint_from_costmap_;   // Take the footprint of costmap_ros_ into shared_footprint_ before every plan, false once a model is shared with the caller
+      base_local_planner::FootprintModelConstPtr footprint_;   // Footprint of the current plan, taken once per plan by updateFootprint
+      std::string global_frame_;
+      boost::shared_ptr<boost::atomic<unsigned long> > footprint_checks_;
       base_local_planner::WorldModel* world_model_; ///< @brief The world model that the controller will use
+      base_local_planner::DistanceFieldModel* distance_field_model_; ///< @brief Same object as world_model_ for the distance_field world model, NULL otherwise
+      boost::shared_ptr<base_local_planner::FootprintTemplateCache> footprint_cache_; ///< @brief Rasterized footprint per heading, empty to use world_model_
       
       // Rectangular robot points
       Eigen::Vector2d topRightCorner_;
@@ -108,12 +208,6 @@ namespace maneuver_planner{
       // Extra reference points
       Eigen::Vector2d left_side_ref_point_;
       Eigen::Vector2d right_side_ref_point_;
-      // AUxiliary variables
-      Eigen::Vector2d motion_refpoint_localtraj_;
-      Eigen::Vector2d prev_motion_refpoint_localtraj_;
-       
-      Eigen::Vector3d center_pose_loctrajframe_;
-            
       
       // Maneuver parameters
       double turning_radius_;
@@ -121,7 +215,6 @@ namespace maneuver_planner{
       
       // internal variables
       geometry_msgs::PoseStamped last_goal_;
-      geometry_msgs::PoseStamped start_;
       bool valid_last_goal_;
       
       // ParameterSearch
@@ -129,6 +222,78 @@ namespace maneuver_planner{
       parameter_generator::ParameterGenerator midway_scale_lr_search_;     
       parameter_generator::ParameterGenerator midway_side_ovt_search_;  // search distance on the side when overtaking
       
+      // Parallel evaluation of maneuver candidates
+      bool parallel_candidate_evaluation_;
+      boost::shared_ptr<WorkerPool> worker_pool_; // shared, since the planner is copied by value
+      bool speculative_fallbacks_;   // Run the fallbacks on the pool while the preferred maneuver is searched
+      
+      // Coarse to fine collision checking of maneuver candidates, disabled when 1 or lower
+      int coarse_check_stride_;
+      
+      // Straight line stretches validated with one swept area check, or with one clearance lookup of the distance field. 0 or lower checks every pose
+      double line_sweep_length_;
+      
+      // Memo of checked segments, shared like the worker pool
+      boost::shared_ptr<CandidateMemo> candidate_memo_;
+      double footprint_radius_;   // Distance from the center to the farthest footprint point
+      
+      // Time budget of a plan
+      double max_planning_time_;  // Used when no deadline is given, 0 or lower for no limit
+      ros::WallTime deadline_;    // Deadline of the current plan, zero for none
+      boost::shared_ptr<boost::atomic<bool> > search_interrupted_;   // Set once the deadline of the current plan passed, read by all the search threads
+      // A search that is cancelled on its own, like the speculative fallbacks, runs with a context installed on its thread
+      struct SearchContext;
+      static boost::thread_specific_ptr<SearchContext> search_context_;
+      static void keepSearchContext(SearchContext* context) {}   // Contexts are owned by the caller of the search
+      
+      // Statistics of the current plan, NULL when they are not collected. Copies made during the plan report to the same collector
+      struct StatisticsCollector;
+      StatisticsCollector* statistics_;
+      
+      // Inputs and outcome of every plan are appended to record_file for replaying them offline, empty when not recording
+      boost::shared_ptr<PlanRecorder> recorder_;
+      double record_window_margin_;   // Costmap recorded around the start and the goal
+      
+      /**
+       * @brief A single maneuver candidate: reference point plus the curve parameters of one turning radius
+       */
+      struct SingleManeuverCandidate
+      {
+          SE2 refpoint_robot_coord;
+          double dist_before_steering_refp;
+          double dist_after_steering_refp;
+          double signed_turning_radius_refp;
+          bool curve_possible;
+      };
+      struct CandidateSearchState;
+      
+      /**
+       * @brief One midway goal of the overtake maneuver: a first maneuver to it, then a left-right maneuver from its end to the goal
+       */
+      struct OvertakeAttempt
+      {
+          SE2 center_midway_goal;
+          bool succesful;
+          bool second_m_evaluated;
+          double dist_without_obstacles;
+          base_local_planner::CompactPlan plan_first_m;
+          base_local_planner::CompactPlan plan_second_m;
+          
+          OvertakeAttempt() : succesful(false), second_m_evaluated(false), dist_without_obstacles(0.0) {}
+      };
+      struct OvertakeSearchState;
+      struct SpeculativeSearchState;
+      
+      /**
+       * @brief Integration state of the robot center along a reference point trajectory. Allows to continue a check with a chained segment
+       */
+      struct CenterTrajectoryState
+      {
+          Eigen::Vector2d prev_motion_refpoint_localtraj;
+          Eigen::Vector3d center_pose_loctrajframe;   // x y theta
+          double total_ahead_distance;
+      };
+      
       
       /**
        * @brief  Checks the legality of the robot footprint at a position and orientation using the world model
@@ -138,35 +303,157 @@ namespace maneuver_planner{
        * @return 
        */
       double footprintCost(double x_i, double y_i, double theta_i);
+
+      /**
+       * @brief  Takes the current footprint model for the plan and passes it to the footprint templates and the distance field
+       */
+      void updateFootprint();
+      /**
+       * @brief  Takes the reference points of the maneuvers from the corners of the footprint
+       * @return False if the footprint is not a rectangle around the center of rotation, the reference points are kept then
+       */
+      bool setCorners(const base_local_planner::FootprintModel& footprint);
+      /**
+       * @brief  Whether the deadline of the current plan passed. Once it did it stays passed until the next plan, so all the searches stop
+       */
+      bool deadlinePassed();
+      /**
+       * @brief  Interruption flag of the search running on this thread: the one of its context, otherwise the one of the plan
+       */
+      boost::atomic<bool>& searchInterrupted();
+      /**
+       * @brief  Deadline of a plan when the caller gives none, from max_planning_time
+       */
+      ros::WallTime defaultDeadline() const;
+      /**
+       * @brief  Starts collecting the statistics of a plan into statistics, until endStatistics
+       */
+      void beginStatistics(StatisticsCollector& collector, PlanningStatistics& statistics);
+      void endStatistics(bool plan_free);
+      /**
+       * @brief  Writes a record of the plan just made, with the costmap window and the footprint it was made with
+       */
+      void recordPlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal, bool use_line_planner,
+                      const ros::WallTime& deadline, const ros::WallTime& call_start, const base_local_planner::CompactPlan& plan,
+                      bool plan_free, double dist_without_obstacles);
+      const std::vector<geometry_msgs::Point>& getRobotFootprint() const;
+      std::string getGlobalFrameID() const;
       
-      void rotate2D(const tf::Stamped<tf::Pose> &pose_tf_in, const double theta, tf::Stamped<tf::Pose> &pose_tf_out);
-      void translate2D(const tf::Stamped<tf::Pose> &pose_tf_in, const tf::Vector3 &vector3_translation, tf::Stamped<tf::Pose> &pose_tf_out);      
-      bool computeSingleManeuverParameters(const tf::Stamped<tf::Pose>& pose_target, const double& signed_turning_radius, const double& x_intersection, double &dist_before_steering, double &dist_after_steering);
-      int  determineManeuverType(const tf::Stamped<tf::Pose>& pose_target,  double &signed_max_turning_radius, double& x_intersection);      
-      
-      bool searchTrajectoryCompoundLeftRightManeuver(const tf::Stamped<tf::Pose>& start_tf, const tf::Stamped<tf::Pose>& goal_tf, 
-                                             const tf::Stamped<tf::Pose>& refpoint_tf_robot_coord, std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles);
-      
-      bool searchTrajectoryOvertakeManeuver(const tf::Stamped<tf::Pose>& start_tf, const tf::Stamped<tf::Pose>& goal_tf, 
-                                                        const tf::Stamped<tf::Pose>& refpoint_tf_robot_coord, std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles);
-      bool searchTrajectoryLeftRightManeuver(const tf::Stamped<tf::Pose>& start_tf, const tf::Stamped<tf::Pose>& goal_tf, 
-                                             const tf::Stamped<tf::Pose>& refpoint_tf_robot_coord, std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles);
+      SE2 poseToSE2(const geometry_msgs::Pose& pose);
+      bool computeSingleManeuverParameters(const SE2& pose_target, const double& signed_turning_radius, const double& x_intersection, double &dist_before_steering, double &dist_after_steering);
+      /**
+       * @brief  computeSingleManeuverParameters for a whole set of radii in one pass, all vectors are indexed by radius
+       */
+      void computeSingleManeuverParameters(const SE2& pose_target, const std::vector<double>& signed_turning_radii, const double& x_intersection,
+                                           std::vector<double>& dist_before_steering, std::vector<double>& dist_after_steering, std::vector<char>& curve_possible);
+      int  determineManeuverType(const SE2& pose_target,  double &signed_max_turning_radius, double& x_intersection);      
       
-      bool searchTrajectorySingleManeuver(const tf::Stamped<tf::Pose>& start_tf, const tf::Stamped<tf::Pose>& goal_tf, 
-                                           std::vector< tf::Stamped<tf::Pose> >& refpoint_tf_robot_coord_vec, std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles);
-      bool checkFootprintTransformLocalToGlobal(const tf::Stamped<tf::Pose>& start_tf, 
-                                const tf::Stamped<tf::Pose>& goal_tf, const tf::Stamped<tf::Pose>& refpoint_tf_robot_coord, 
-                                const std::vector<tf::Pose> &local_plan_refp, std::vector<geometry_msgs::PoseStamped>& plan, double &dist_without_obstacles );
+      bool searchTrajectoryCompoundLeftRightManeuver(const SE2& start, const SE2& goal, 
+                                             const SE2& refpoint_robot_coord, base_local_planner::CompactPlan& plan, double & dist_without_obstacles);
       
+      bool searchTrajectoryOvertakeManeuver(const SE2& start, const SE2& goal, 
+                                                        const SE2& refpoint_robot_coord, base_local_planner::CompactPlan& plan, double & dist_without_obstacles);
+      void enumerateOvertakeAttempts(const SE2& start, const SE2& goal, const SE2& refpoint_robot_coord, std::vector<OvertakeAttempt>& attempts);
+      /**
+       * @brief  Plans the two maneuvers of an overtake attempt
+       * @param first_success_index When given, the attempt is abandoned between maneuvers as soon as it is lower than attempt_index
+       * @return True if both maneuvers are collision free
+       */
+      bool checkOvertakeAttempt(const SE2& start, const SE2& goal, const SE2& refpoint_robot_coord, OvertakeAttempt& attempt,
+                                const boost::atomic<size_t>* first_success_index = NULL, size_t attempt_index = 0);
+      void evaluateOvertakeAttempts(OvertakeSearchState* state);
+      bool searchTrajectoryLeftRightManeuver(const SE2& start, const SE2& goal, 
+                                             const SE2& refpoint_robot_coord, base_local_planner::CompactPlan& plan, double & dist_without_obstacles);
       
-      void generateDublinTrajectory(const double& dist_before_steering_refp, const double& dist_after_steering_refp, 
-                               const double& signed_turning_radius_refp, const double& theta_refp_goal, std::vector<tf::Pose> &local_plan_refp);
+      bool searchTrajectorySingleManeuver(const SE2& start, const SE2& goal, 
+                                           const std::vector<SE2>& refpoint_robot_coord_vec, base_local_planner::CompactPlan& plan, double & dist_without_obstacles);
+      /**
+       * @brief  Single maneuver search in which the radius search is guided by how far every candidate gets before colliding
+       */
+      bool searchTrajectorySingleManeuverWithFeedback(const SE2& start, const SE2& goal, 
+                                           const std::vector<SE2>& refpoint_robot_coord_vec, base_local_planner::CompactPlan& plan, double & dist_without_obstacles);
+      void enumerateSingleManeuverCandidates(const SE2& start, const SE2& goal, 
+                                           const std::vector<SE2>& refpoint_robot_coord_vec, std::vector<SingleManeuverCandidate>& candidates);
+      void evaluateSingleManeuverCandidates(CandidateSearchState* state);
+      bool checkSingleManeuverCandidate(const SE2& start, const SingleManeuverCandidate& candidate, double theta_refp_goal, bool coarse_to_fine,
+                                        CenterTrajectoryState& center_state, std::vector<Eigen::Vector3d>& center_traj,
+                                        const boost::atomic<size_t>* first_success_index = NULL, size_t candidate_index = 0);
+      /**
+       * @brief  Reports a failed single maneuver search like the exhaustive search does: the plan of the last candidate up to its
+       * first collision and the distance of the last candidate that could be generated
+       * @param candidates_end Number of candidates evaluated, less than all of them when the search was interrupted
+       */
+      void traceFailedSingleManeuver(const SE2& start, const std::vector<SingleManeuverCandidate>& candidates, size_t candidates_end,
+                                     double theta_refp_goal, base_local_planner::CompactPlan& plan, double & dist_without_obstacles);
+      void initCenterTrajectory(const SE2& refpoint_robot_coord, CenterTrajectoryState& center_state);
+      /**
+       * @brief  Generates the reference point trajectory of a segment and checks the footprint of the corresponding center poses one by one, stopping at the first collision
+       * @param center_state Integration state, updated with the checked poses
+       * @param center_traj The collision free center poses (x, y, yaw) in the global frame are appended here
+       * @param coarse_to_fine Check every coarse_check_stride_-th pose first, then the ones in checkPosesCoarseToFine. On a collision only the returned value
+       * is meaningful, center_state and center_traj do not stop at the first collision
+       * @param first_success_index When given, the check is aborted as soon as it is lower than candidate_index
+       * @return True if the whole segment is collision free
+       */
+      bool checkDublinSegment(const SE2& start, const SE2& refpoint_robot_coord, 
+                                const DublinSegment& segment, CenterTrajectoryState& center_state, std::vector<Eigen::Vector3d>& center_traj,
+                                bool coarse_to_fine = false, const boost::atomic<size_t>* first_success_index = NULL, size_t candidate_index = 0);
+      /**
+       * @brief  Key of a segment in the candidate memo: start, reference point, segment parameters and the integration state it starts from
+       */
+      void makeMemoKey(const SE2& start, const SE2& refpoint_robot_coord, const DublinSegment& segment,
+                       const CenterTrajectoryState& center_state, CandidateMemo::Key& key) const;
+      /**
+       * @brief  Checks the center poses from first_pose on, except every coarse_check_stride_-th pose that is checked while generating: first the end pose and the apex pose, then the rest
+       * @return True if all the poses are collision free
+       */
+      bool checkPosesCoarseToFine(const std::vector<Eigen::Vector3d>& center_traj, size_t first_pose, size_t apex_pose,
+                                  const boost::atomic<size_t>* first_success_index, size_t candidate_index);
+      /**
+       * @brief  Converts center poses to plan poses. The header of the poses is left to makePlan
+       */
+      void materializePlan(const std::vector<Eigen::Vector3d>& center_traj, base_local_planner::CompactPlan& plan);
       bool linePlanner(const geometry_msgs::PoseStamped& start,
-                               const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan, double &dist_without_obstacles);
+                               const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& plan, double &dist_without_obstacles);
       bool makePlanUntilPossible(const geometry_msgs::PoseStamped& start,
-                               const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles);
+                               const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& plan, double & dist_without_obstacles);
+      /**
+       * @brief  Takes the current costmap and footprint, done once per request
+       */
+      void updateWorldState();
+      /**
+       * @brief  Searches a plan from start on the state taken by updateWorldState
+       */
+      bool planInUpdatedWorld(const geometry_msgs::PoseStamped& start,
+                               const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& plan, double & dist_without_obstacles);
+      /**
+       * @brief  Searches the maneuver preferred for maneuver_type
+       */
+      bool planPreferredManeuver(int maneuver_type, const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                                 const SE2& start_pose, const SE2& goal_pose, base_local_planner::CompactPlan& plan, double & dist_without_obstacles);
+      /**
+       * @brief  Whether the fallbacks are tried after the preferred maneuver of maneuver_type gave this result
+       */
+      bool fallbacksNeeded(int maneuver_type, bool maneuver_traj_succesful, double dist_without_obstacles);
+      /**
+       * @brief  Line planner, then the overtake maneuver if the line gets blocked close to the robot
+       * @param fallback Set to the PlanningStatistics fallback whose plan is returned
+       */
+      bool planFallbacks(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                         const SE2& start_pose, const SE2& goal_pose, base_local_planner::CompactPlan& plan, double & dist_without_obstacles,
+                         int& fallback);
+      /**
+       * @brief  Searches the preferred maneuver and, on another thread of the pool, the fallbacks. The fallbacks are cancelled
+       * as soon as they are known not to be needed, the result is the one of the sequential search
+       */
+      bool planWithSpeculativeFallbacks(int maneuver_type, const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                                        const SE2& start_pose, const SE2& goal_pose, base_local_planner::CompactPlan& plan, double & dist_without_obstacles,
+                                        int& fallback);
+      void evaluateSpeculativeSearch(SpeculativeSearchState* state);
+      bool checkGoalBatch(const geometry_msgs::PoseStamped& start, const std::vector<geometry_msgs::PoseStamped>& goals, bool chain,
+                          std::vector<GoalFeasibility>& results, bool keep_plans);
       
-      void removeLastPoints( std::vector<geometry_msgs::PoseStamped>& plan, double & distToRemove);
+      void removeLastPoints( base_local_planner::CompactPlan& plan, double & distToRemove);
       
       
       enum curveType
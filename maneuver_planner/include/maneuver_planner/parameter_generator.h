@@ -38,6 +38,7 @@
 #define PARAMETER_GENERATOR_H_
 
 #include <math.h>
+#include <vector>
 #include <ros/ros.h>
 
 
@@ -48,6 +49,16 @@ namespace parameter_generator{
    */
   class ParameterGenerator{
     public:
+      /**
+       * @brief  Order in which resetSearch/search produce the values
+       */
+      enum SearchStrategy
+      {
+        LINEAR_SEARCH,          // From min to max
+        MID_SEARCH,             // From the middle outwards, alternating sides
+        GOLDEN_SECTION_SEARCH,  // Narrows down on the value with the highest feedback, see setFeedback
+      };
+      
       /**
        * @brief  Constructor for the ParameterGenerator
        */
@@ -68,6 +79,33 @@ namespace parameter_generator{
       void resetMidSearch(double lin_search_min, double lin_search_max);      
       bool midSearch(double &lin_search_curr);      
       
+      /**
+       * @brief  Golden-section search for the value with the highest feedback. Every value must get its feedback
+       * before the next one is requested, values without feedback count as the worst
+       */
+      void resetGoldenSectionSearch(double lin_search_min, double lin_search_max);
+      bool goldenSectionSearch(double &lin_search_curr);
+      
+      /**
+       * @brief  Resets and runs the search of the selected strategy
+       */
+      void resetSearch(double lin_search_min, double lin_search_max);
+      bool search(double &lin_search_curr);
+      /**
+       * @brief  Reports how good the last value was, e.g. the distance without obstacles of the candidate generated with it.
+       * Only used by the golden-section search
+       */
+      void setFeedback(double feedback);
+      
+      /**
+       * @brief  All the values of a search at once, in the order search would produce them, without changing this generator.
+       * The golden-section search depends on feedback, for it the values of the mid search are given
+       */
+      void searchValues(double lin_search_min, double lin_search_max, std::vector<double>& values) const;
+      
+      void setStrategy(SearchStrategy strategy);
+      SearchStrategy getStrategy() const;
+      
       double lin_search_min_;    // Minimum while searching for turning radius
       double lin_search_max_;    // Maximum while searching for turning radius
 
@@ -83,6 +121,15 @@ namespace parameter_generator{
       int lin_search_sign_;
       int lin_search_cnt_;  
       
+      SearchStrategy strategy_;
+      
+      // GoldenSectionSearch
+      double gs_lower_, gs_upper_;      // Bracket of the best value
+      double gs_x1_, gs_x2_;            // Inner points, gs_x1_ < gs_x2_
+      double gs_f1_, gs_f2_;            // Their feedback
+      int gs_state_;                    // Which inner point waits for its feedback
+      double feedback_;                 // Feedback of the last value
+      
 
 
   };
@@ -0,0 +1,135 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#ifndef PLAN_RECORD_H_
+#define PLAN_RECORD_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <costmap_2d/costmap_2d.h>
+#include <geometry_msgs/Point.h>
+#include <geometry_msgs/PoseStamped.h>
+
+namespace maneuver_planner{
+  /**
+   * @brief Inputs of one makePlan call and what it returned, enough to repeat the call offline
+   */
+  struct PlanRecord
+  {
+      geometry_msgs::PoseStamped start, goal;
+      bool use_line_planner;
+      double time_budget;                     // Seconds from the call to its deadline, 0 for none
+      std::vector<geometry_msgs::Point> footprint;
+      
+      // Window of the costmap around the maneuver, in the cells of the original costmap
+      double origin_x, origin_y, resolution;
+      unsigned int size_x, size_y;
+      std::vector<unsigned char> cells;       // Row major, size_x*size_y
+      
+      // Outcome of the recorded call
+      bool plan_free;
+      double dist_without_obstacles;
+      unsigned int plan_size;
+      double planning_time;                   // Seconds
+      
+      PlanRecord() : use_line_planner(false), time_budget(0.0), origin_x(0.0), origin_y(0.0), resolution(0.0), size_x(0), size_y(0),
+                     plan_free(false), dist_without_obstacles(0.0), plan_size(0), planning_time(0.0) {}
+      
+      /**
+       * @brief  Copies the cells of costmap inside [min_x, max_x] x [min_y, max_y], clamped to the costmap
+       */
+      void cropCostmap(const costmap_2d::Costmap2D& costmap, double min_x, double min_y, double max_x, double max_y);
+      
+      /**
+       * @brief  A costmap with the recorded window, for replaying the call
+       */
+      boost::shared_ptr<costmap_2d::Costmap2D> makeCostmap() const;
+  };
+
+  /**
+   * @class PlanRecorder
+   * @brief Appends PlanRecords to a binary file. The costmap window is stored run length encoded.
+   * Every planner of a process recording to the same file shares one recorder, writes are serialized.
+   */
+  class PlanRecorder{
+    public:
+      /**
+       * @brief  The recorder of file, the file is created on the first call for it in this process
+       * @return Empty if the file cannot be opened
+       */
+      static boost::shared_ptr<PlanRecorder> open(const std::string& file);
+      
+      void write(const PlanRecord& record);
+      
+    private:
+      PlanRecorder(const std::string& file);
+      
+      std::ofstream out_;
+      boost::mutex mutex_;
+  };
+
+  /**
+   * @class PlanRecordReader
+   * @brief Reads the records of a file written by PlanRecorder, in the order they were made
+   */
+  class PlanRecordReader{
+    public:
+      PlanRecordReader(const std::string& file);
+      
+      /**
+       * @brief  Whether the file was opened and has the expected header
+       */
+      bool isValid() const { return valid_; }
+      
+      /**
+       * @return False at the end of the file, or if the file is truncated or corrupt. Nothing is allocated for sizes
+       * the rest of the file cannot hold
+       */
+      bool read(PlanRecord& record);
+      
+    private:
+      // Whether the rest of the file holds at least bytes
+      bool remains(unsigned long long bytes);
+      
+      std::ifstream in_;
+      std::streampos end_;
+      bool valid_;
+  };
+};
+#endif
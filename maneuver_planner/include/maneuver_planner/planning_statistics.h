@@ -0,0 +1,101 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#ifndef PLANNING_STATISTICS_H_
+#define PLANNING_STATISTICS_H_
+
+namespace maneuver_planner{
+  /**
+   * @brief Statistics of one makePlan call. Stage times are in seconds, the times of the stages that run on the
+   * worker pool are summed over its threads, and stages nest: the fallbacks include their own generation and checks
+   */
+  struct PlanningStatistics
+  {
+      enum
+      {
+        MANEUVER_NOT_DETERMINED = -1,   // Line planner requested by the caller, or the goal was rejected
+        MANEUVER_NONE = 0,              // Straight line
+        MANEUVER_LEFT,
+        MANEUVER_RIGHT,
+        MANEUVER_LEFT_RIGHT,
+        MANEUVER_RIGHT_LEFT,
+        MANEUVER_STRAIGHT_OTHERWISE_OVERTAKE,
+      };
+      
+      enum
+      {
+        FALLBACK_NONE = 0,              // The plan is the one of the preferred maneuver
+        FALLBACK_LINE,
+        FALLBACK_OVERTAKE,
+      };
+      
+      int maneuver_type;                // Preferred maneuver, same values as ManeuverPlanner
+      int fallback;                     // Fallback that produced the final plan
+      bool plan_free;
+      bool search_complete;             // False when the deadline stopped the search
+      
+      unsigned long reference_points;   // Reference points for which radius candidates were generated
+      unsigned long radius_candidates;  // Trajectory segments checked, one per turning radius tried
+      unsigned long midway_candidates;  // Midway goals of left-right and overtake maneuvers tried
+      unsigned long footprint_checks;   // Footprint checks of this planner and its copies during the call
+      
+      double determine_maneuver_time;
+      double generation_time;           // Enumeration of the radius candidates and the overtake midway goals
+      double collision_check_time;      // Checks of the trajectory segments and of the line planner
+      double fallback_time;             // Includes speculative fallbacks whose plan was not used
+      double total_time;
+
+      PlanningStatistics() { reset(); }
+      
+      void reset()
+      {
+          maneuver_type = MANEUVER_NOT_DETERMINED;
+          fallback = FALLBACK_NONE;
+          plan_free = false;
+          search_complete = true;
+          reference_points = 0;
+          radius_candidates = 0;
+          midway_candidates = 0;
+          footprint_checks = 0;
+          determine_maneuver_time = 0.0;
+          generation_time = 0.0;
+          collision_check_time = 0.0;
+          fallback_time = 0.0;
+          total_time = 0.0;
+      }
+  };
+};
+#endif
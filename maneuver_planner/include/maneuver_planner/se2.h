@@ -0,0 +1,118 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#ifndef SE2_H_
+#define SE2_H_
+
+#include <math.h>
+#include <angles/angles.h>
+
+namespace maneuver_planner{
+  /**
+   * @class SE2
+   * @brief A planar pose (x, y, theta) that also acts as the transform from its own frame to the parent frame.
+   * The cosine and sine of theta are cached, theta is kept in [-pi, pi].
+   */
+  class SE2{
+    public:
+      SE2() : x_(0.0), y_(0.0), theta_(0.0), cos_(1.0), sin_(0.0) {}
+
+      SE2(double x, double y, double theta) : x_(x), y_(y)
+      {
+          setTheta(theta);
+      }
+
+      double x() const { return x_; }
+      double y() const { return y_; }
+      double theta() const { return theta_; }
+      double cos() const { return cos_; }
+      double sin() const { return sin_; }
+
+      void setOrigin(double x, double y)
+      {
+          x_ = x;
+          y_ = y;
+      }
+
+      void setTheta(double theta)
+      {
+          theta_ = angles::normalize_angle(theta);
+          cos_ = std::cos(theta_);
+          sin_ = std::sin(theta_);
+      }
+
+      /**
+       * @brief  Composition, rhs is expressed in the frame of this pose and the result in the parent frame
+       */
+      SE2 operator*(const SE2& rhs) const
+      {
+          return SE2(x_ + cos_*rhs.x_ - sin_*rhs.y_, y_ + sin_*rhs.x_ + cos_*rhs.y_,
+                     wrap(theta_ + rhs.theta_), cos_*rhs.cos_ - sin_*rhs.sin_, sin_*rhs.cos_ + cos_*rhs.sin_);
+      }
+
+      SE2 inverse() const
+      {
+          return SE2(-cos_*x_ - sin_*y_, sin_*x_ - cos_*y_, wrap(-theta_), cos_, -sin_);
+      }
+
+      /**
+       * @brief  Transforms a point expressed in the frame of this pose to the parent frame
+       */
+      void transformPoint(double x_in, double y_in, double& x_out, double& y_out) const
+      {
+          x_out = x_ + cos_*x_in - sin_*y_in;
+          y_out = y_ + sin_*x_in + cos_*y_in;
+      }
+
+    private:
+      SE2(double x, double y, double theta, double cos_theta, double sin_theta) :
+          x_(x), y_(y), theta_(theta), cos_(cos_theta), sin_(sin_theta) {}
+
+      // Sum or negation of angles already in [-pi, pi] is at most one turn away
+      static double wrap(double theta)
+      {
+          if( theta > M_PI )
+              return theta - 2.0*M_PI;
+          if( theta < -M_PI )
+              return theta + 2.0*M_PI;
+          return theta;
+      }
+
+      double x_, y_, theta_;
+      double cos_, sin_;
+  };
+};
+#endif
@@ -0,0 +1,60 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#ifndef SWEPT_AREA_H_
+#define SWEPT_AREA_H_
+
+#include <vector>
+#include <costmap_2d/costmap_2d.h>
+#include <geometry_msgs/Point.h>
+#include <maneuver_planner/se2.h>
+
+namespace maneuver_planner{
+  /**
+   * @brief  Checks every costmap cell that overlaps the area swept by the footprint between two poses. The area is the
+   * convex hull of the footprint at both poses, grown by padding. For a straight motion without rotation the hull contains
+   * the footprint at every pose in between, the padding has to cover the rotation and the rasterization of the checks it replaces
+   * @param costmap The costmap that should be used
+   * @param footprint_spec The footprint of the robot in the robot frame
+   * @param from The first pose of the robot
+   * @param to The last pose of the robot
+   * @param padding Distance in meters by which the hull is grown
+   * @return True if no cell of the area is lethal or unknown and the area lies inside the map
+   */
+  bool sweptAreaFree(const costmap_2d::Costmap2D& costmap, const std::vector<geometry_msgs::Point>& footprint_spec,
+                     const SE2& from, const SE2& to, double padding);
+};
+#endif
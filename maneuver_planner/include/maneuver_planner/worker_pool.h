@@ -0,0 +1,92 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#ifndef WORKER_POOL_H_
+#define WORKER_POOL_H_
+
+#include <boost/thread.hpp>
+#include <boost/function.hpp>
+#include <boost/exception_ptr.hpp>
+
+namespace maneuver_planner{
+  /**
+   * @class WorkerPool
+   * @brief A fixed set of threads that execute the same task together with the calling thread.
+   * The task is expected to pull its own work items (e.g. candidate indices) from shared state.
+   */
+  class WorkerPool{
+    public:
+      /**
+       * @brief  Constructor for the WorkerPool
+       * @param num_threads Total number of threads taking part in a run, including the calling thread
+       */
+      WorkerPool(unsigned int num_threads);
+
+      ~WorkerPool();
+
+      /**
+       * @brief  Number of threads taking part in a run, including the calling thread
+       */
+      unsigned int size() const;
+
+      /**
+       * @brief  Executes task on every worker and on the calling thread and returns when all are done.
+       * If the pool is already running a task (e.g. a nested call from within a task) the task
+       * is executed on the calling thread only. An exception thrown by the task is rethrown once all the threads
+       * are done, the one of the calling thread before those of the workers.
+       * @param task The task to execute
+       */
+      void run(const boost::function<void ()>& task);
+
+    private:
+      void workerLoop();
+
+      boost::thread_group threads_;
+      unsigned int num_workers_;
+
+      boost::mutex mutex_;
+      boost::mutex run_mutex_;
+      boost::condition_variable job_cond_;
+      boost::condition_variable done_cond_;
+
+      boost::function<void ()> task_;
+      boost::exception_ptr exception_;     // First exception thrown by a worker during the current run
+      unsigned long generation_;
+      unsigned int pending_;
+      bool shutdown_;
+  };
+};
+#endif
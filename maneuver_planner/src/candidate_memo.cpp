@@ -0,0 +1,87 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#include <maneuver_planner/candidate_memo.h>
+
+namespace maneuver_planner{
+
+CandidateMemo::CandidateMemo(size_t max_entries) :
+    max_entries_(max_entries)
+{
+}
+
+void CandidateMemo::update(const costmap_2d::Costmap2D& costmap, const std::vector<geometry_msgs::Point>& footprint)
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    
+    bool same_footprint = footprint.size() == footprint_.size();
+    for (size_t i = 0; same_footprint && i < footprint.size(); i++)
+        same_footprint = footprint[i].x == footprint_[i].x && footprint[i].y == footprint_[i].y;
+    if( !same_footprint )
+    {
+        footprint_ = footprint;
+        entries_.clear();
+    }
+    
+    unsigned long previous_revision = change_tracker_.revision();
+    change_tracker_.update(costmap);
+    if( change_tracker_.resetRevision() > previous_revision )
+        entries_.clear();   // The whole map moved, nothing can be reused
+}
+
+bool CandidateMemo::lookup(const Key& key, CandidateMemoEntry& entry) const
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    std::map<Key, CandidateMemoEntry>::const_iterator it = entries_.find(key);
+    if( it == entries_.end() )
+        return false;
+    if( change_tracker_.changedSince(it->second.revision, it->second.min_x, it->second.min_y, it->second.max_x, it->second.max_y) )
+        return false;
+    entry = it->second;
+    return true;
+}
+
+void CandidateMemo::store(const Key& key, const CandidateMemoEntry& entry)
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    if( entries_.size() >= max_entries_ )
+        entries_.clear();
+    CandidateMemoEntry& stored_entry = entries_[key];
+    stored_entry = entry;
+    stored_entry.revision = change_tracker_.revision();
+}
+
+};
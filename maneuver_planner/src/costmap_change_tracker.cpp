@@ -0,0 +1,188 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#include <maneuver_planner/costmap_change_tracker.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace maneuver_planner{
+
+CostmapChangeTracker::CostmapChangeTracker(unsigned int tile_size) :
+    tile_size_(std::max(tile_size, 1u)), size_x_(0), size_y_(0), tiles_x_(0), tiles_y_(0),
+    resolution_(0.0), origin_x_(0.0), origin_y_(0.0), revision_(0), reset_revision_(0)
+{
+}
+
+unsigned long CostmapChangeTracker::update(const costmap_2d::Costmap2D& costmap)
+{
+    const unsigned char* charmap = costmap.getCharMap();
+    unsigned int size_x = costmap.getSizeInCellsX();
+    unsigned int size_y = costmap.getSizeInCellsY();
+    
+    if( size_x == size_x_ && size_y == size_y_ && costmap.getResolution() == resolution_ &&
+        (costmap.getOriginX() != origin_x_ || costmap.getOriginY() != origin_y_) )
+    {   // A rolling window moves by whole cells, the cells it still covers keep their revisions
+        double shift_x = (costmap.getOriginX() - origin_x_)/resolution_;
+        double shift_y = (costmap.getOriginY() - origin_y_)/resolution_;
+        int cells_x = (int) std::floor(shift_x + 0.5);
+        int cells_y = (int) std::floor(shift_y + 0.5);
+        if( std::fabs(shift_x - cells_x) < 1e-3 && std::fabs(shift_y - cells_y) < 1e-3 &&
+            std::abs(cells_x) < (int) size_x_ && std::abs(cells_y) < (int) size_y_ )
+            shift(cells_x, cells_y, costmap);
+    }
+    
+    if( size_x != size_x_ || size_y != size_y_ || costmap.getResolution() != resolution_ ||
+        costmap.getOriginX() != origin_x_ || costmap.getOriginY() != origin_y_ )
+    {   // Cells do not correspond anymore, everything changed
+        size_x_ = size_x;
+        size_y_ = size_y;
+        resolution_ = costmap.getResolution();
+        origin_x_ = costmap.getOriginX();
+        origin_y_ = costmap.getOriginY();
+        tiles_x_ = (size_x_ + tile_size_ - 1)/tile_size_;
+        tiles_y_ = (size_y_ + tile_size_ - 1)/tile_size_;
+        snapshot_.assign(charmap, charmap + size_x_*size_y_);
+        revision_++;
+        reset_revision_ = revision_;
+        tile_revision_.assign(tiles_x_*tiles_y_, revision_);
+        return revision_;
+    }
+    
+    bool changed = false;
+    for (unsigned int y = 0; y < size_y_; y++)
+    {
+        const unsigned int row = y*size_x_;
+        if( std::memcmp(&snapshot_[row], charmap + row, size_x_) == 0 )
+            continue;   // Most rows do not change, compare them at once
+        unsigned long* tile_revision_row = &tile_revision_[(y/tile_size_)*tiles_x_];
+        for (unsigned int tx = 0; tx < tiles_x_; tx++)
+        {
+            const unsigned int x0 = tx*tile_size_;
+            const unsigned int length = std::min(tile_size_, size_x_ - x0);
+            if( std::memcmp(&snapshot_[row + x0], charmap + row + x0, length) != 0 )
+            {
+                std::memcpy(&snapshot_[row + x0], charmap + row + x0, length);
+                if( !changed )
+                {
+                    changed = true;
+                    revision_++;
+                }
+                tile_revision_row[tx] = revision_;
+            }
+        }
+    }
+    return revision_;
+}
+
+void CostmapChangeTracker::shift(int cells_x, int cells_y, const costmap_2d::Costmap2D& costmap)
+{
+    // Cell (x, y) of the moved map was cell (x + cells_x, y + cells_y) before, the cells that entered the map changed
+    const unsigned char* charmap = costmap.getCharMap();
+    std::vector<unsigned char> snapshot(size_x_*size_y_);
+    for (unsigned int y = 0; y < size_y_; y++)
+    {
+        const int old_y = (int) y + cells_y;
+        const int old_x0 = std::max(cells_x, 0);
+        const int old_x1 = std::min((int) size_x_ + cells_x, (int) size_x_);
+        std::memcpy(&snapshot[y*size_x_], charmap + y*size_x_, size_x_);
+        if( old_y >= 0 && old_y < (int) size_y_ )
+            std::memcpy(&snapshot[y*size_x_ + old_x0 - cells_x], &snapshot_[old_y*size_x_ + old_x0], old_x1 - old_x0);
+    }
+    snapshot_.swap(snapshot);
+    
+    // A tile takes the latest revision of the tiles it overlapped, or a new one when it contains cells that entered
+    revision_++;
+    std::vector<unsigned long> tile_revision(tiles_x_*tiles_y_);
+    for (unsigned int ty = 0; ty < tiles_y_; ty++)
+    {
+        const int old_y0 = (int) (ty*tile_size_) + cells_y;
+        const int old_y1 = (int) std::min((ty + 1)*tile_size_, size_y_) - 1 + cells_y;
+        for (unsigned int tx = 0; tx < tiles_x_; tx++)
+        {
+            const int old_x0 = (int) (tx*tile_size_) + cells_x;
+            const int old_x1 = (int) std::min((tx + 1)*tile_size_, size_x_) - 1 + cells_x;
+            unsigned long& revision = tile_revision[ty*tiles_x_ + tx];
+            if( old_x0 < 0 || old_y0 < 0 || old_x1 >= (int) size_x_ || old_y1 >= (int) size_y_ )
+            {
+                revision = revision_;
+                continue;
+            }
+            revision = 0;
+            for (int oty = old_y0/(int) tile_size_; oty <= old_y1/(int) tile_size_; oty++)
+                for (int otx = old_x0/(int) tile_size_; otx <= old_x1/(int) tile_size_; otx++)
+                    revision = std::max(revision, tile_revision_[oty*tiles_x_ + otx]);
+        }
+    }
+    tile_revision_.swap(tile_revision);
+    origin_x_ = costmap.getOriginX();
+    origin_y_ = costmap.getOriginY();
+}
+
+bool CostmapChangeTracker::changedSince(unsigned long revision, int min_x, int min_y, int max_x, int max_y) const
+{
+    if( revision < reset_revision_ )
+        return true;
+    
+    // Cells outside the map can only change with the origin
+    min_x = std::max(min_x, 0);
+    min_y = std::max(min_y, 0);
+    max_x = std::min(max_x, (int) size_x_ - 1);
+    max_y = std::min(max_y, (int) size_y_ - 1);
+    if( min_x > max_x || min_y > max_y )
+        return false;
+    
+    for (int ty = min_y/(int) tile_size_; ty <= max_y/(int) tile_size_; ty++)
+    {
+        for (int tx = min_x/(int) tile_size_; tx <= max_x/(int) tile_size_; tx++)
+        {
+            if( tile_revision_[ty*tiles_x_ + tx] > revision )
+                return true;
+        }
+    }
+    return false;
+}
+
+bool CostmapChangeTracker::changedSince(unsigned long revision, double min_wx, double min_wy, double max_wx, double max_wy) const
+{
+    if( revision < reset_revision_ )
+        return true;
+    
+    return changedSince(revision, (int) std::floor((min_wx - origin_x_)/resolution_), (int) std::floor((min_wy - origin_y_)/resolution_),
+                                  (int) std::floor((max_wx - origin_x_)/resolution_), (int) std::floor((max_wy - origin_y_)/resolution_));
+}
+
+};
@@ -36,18 +36,69 @@
 *********************************************************************/
 #include <maneuver_planner/maneuver_planner.h>
 #include <pluginlib/class_list_macros.h>
+#include <limits>
 
 //register this planner as a BaseGlobalPlanner plugin
 PLUGINLIB_EXPORT_CLASS(maneuver_planner::ManeuverPlanner, nav_core::BaseGlobalPlanner)
 
 namespace maneuver_planner {
 
+/**
+ * Counters of the plan being collected, updated by all the search threads
+ */
+struct ManeuverPlanner::StatisticsCollector
+{
+    PlanningStatistics* statistics;
+    ros::WallTime start_time;
+    unsigned long start_footprint_checks;
+    
+    boost::atomic<unsigned long> reference_points;
+    boost::atomic<unsigned long> radius_candidates;
+    boost::atomic<unsigned long> midway_candidates;
+    
+    // Stage times in nanoseconds
+    boost::atomic<unsigned long> determine_maneuver_time;
+    boost::atomic<unsigned long> generation_time;
+    boost::atomic<unsigned long> collision_check_time;
+    boost::atomic<unsigned long> fallback_time;
+    
+    StatisticsCollector() : statistics(NULL), start_footprint_checks(0), reference_points(0), radius_candidates(0), midway_candidates(0),
+                            determine_maneuver_time(0), generation_time(0), collision_check_time(0), fallback_time(0) {}
+};
+
+namespace {
+/**
+ * Adds the time until it goes out of scope to a stage of the statistics, does nothing without one
+ */
+class StageTimer
+{
+  public:
+    StageTimer(boost::atomic<unsigned long>* stage_time) : stage_time_(stage_time)
+    {
+        if( stage_time_ )
+            start_ = ros::WallTime::now();
+    }
+    
+    ~StageTimer()
+    {
+        if( stage_time_ )
+            stage_time_->fetch_add((unsigned long)((ros::WallTime::now() - start_).toSec()*1e9), boost::memory_order_relaxed);
+    }
+    
+  private:
+    boost::atomic<unsigned long>* stage_time_;
+    ros::WallTime start_;
+};
+}
+
 ManeuverPlanner::ManeuverPlanner()
-    : costmap_ros_(NULL), initialized_(false)
+    : costmap_ros_(NULL), footprint_from_costmap_(true), distance_field_model_(NULL), parallel_candidate_evaluation_(false), speculative_fallbacks_(false), max_planning_time_(0.0),
+      search_interrupted_(new boost::atomic<bool>(false)), statistics_(NULL), record_window_margin_(3.0), initialized_(false)
 {}
 
 ManeuverPlanner::ManeuverPlanner(std::string name, costmap_2d::Costmap2DROS* costmap_ros)
-    : costmap_ros_(NULL), initialized_(false)
+    : costmap_ros_(NULL), footprint_from_costmap_(true), distance_field_model_(NULL), parallel_candidate_evaluation_(false), speculative_fallbacks_(false), max_planning_time_(0.0),
+      search_interrupted_(new boost::atomic<bool>(false)), statistics_(NULL), record_window_margin_(3.0), initialized_(false)
 {
     initialize(name, costmap_ros); 
 }
@@ -57,72 +108,104 @@ void ManeuverPlanner::initialize(std::string name, costmap_2d::Costmap2DROS* cos
     if(!initialized_)
     {
         costmap_ros_ = costmap_ros;
-        costmap_ = costmap_ros_->getCostmap();        
+        initialize(name, costmap_ros_->getCostmap(), costmap_ros_->getRobotFootprint(), costmap_ros_->getGlobalFrameID());
+    }
+    else
+        ROS_WARN("This planner has already been initialized... doing nothing");
+}
+
+void ManeuverPlanner::initialize(std::string name, costmap_2d::Costmap2D* costmap,
+                                 const std::vector<geometry_msgs::Point>& footprint_spec, const std::string& global_frame)
+{
+    if(!initialized_)
+    {
+        costmap_ = costmap;
+        global_frame_ = global_frame;
+        footprint_checks_.reset(new boost::atomic<unsigned long>(0));
 
         ros::NodeHandle private_nh("~/" + name);
         private_nh.param("step_size", step_size_, costmap_->getResolution());
         private_nh.param("use_last_goal_as_start", last_goal_as_start_, false);
-        valid_last_goal_ = false;
-        world_model_ = new base_local_planner::CostmapModel(*costmap_);
-
-
-        // For now only rectangular robot shape is supported. Initiallize transformation matrices
-        std::vector<geometry_msgs::Point> footprint = costmap_ros_->getRobotFootprint();
-        //if we have no footprint... do nothing
-        if(footprint.size() != 4)
+        // Evaluate the (reference point, radius) candidates of a maneuver on a pool of threads
+        private_nh.param("parallel_candidate_evaluation", parallel_candidate_evaluation_, false);
+        // Search the fallback maneuvers on the same pool while the preferred maneuver is searched
+        private_nh.param("speculative_fallbacks", speculative_fallbacks_, false);
+        int candidate_threads;
+        private_nh.param("candidate_threads", candidate_threads, (int) boost::thread::hardware_concurrency());
+        if( (parallel_candidate_evaluation_ || speculative_fallbacks_) && candidate_threads > 1 )
         {
-            ROS_ERROR("Footprint must have hour points");
-            return;
+            worker_pool_.reset(new WorkerPool(candidate_threads));
         }
-
-        // The heading of the robot is towards the x axis.
-        bool topRightCorner_b = false;
-        bool topLeftCorner_b = false;
-        bool bottomRightCorner_b = false;
-        bool bottomLeftCorner_b = false;
-
-
-
-        for (int i_fp = 0; i_fp<footprint.size(); i_fp++)
+        else
         {
-// 	ROS_INFO("footprint %.3f, %.3f", footprint[i_fp].x, footprint[i_fp].y);
-            if( footprint[i_fp].x > 0 && footprint[i_fp].y > 0)
-            {
-                topLeftCorner_b = true;
-                topLeftCorner_ << footprint[i_fp].x, footprint[i_fp].y;
-            } 
-            else if( footprint[i_fp].x > 0 && footprint[i_fp].y < 0)
-            {
-                topRightCorner_b = true;
-                topRightCorner_ << footprint[i_fp].x, footprint[i_fp].y;
-            } 
-            else if( footprint[i_fp].x < 0 && footprint[i_fp].y < 0)
-            {
-                bottomRightCorner_b = true;
-                bottomRightCorner_ << footprint[i_fp].x, footprint[i_fp].y;
-            } 
-            else if( footprint[i_fp].x < 0 && footprint[i_fp].y > 0)
-            {
-                bottomLeftCorner_b = true;
-                bottomLeftCorner_ << footprint[i_fp].x, footprint[i_fp].y;
-            }
+            parallel_candidate_evaluation_ = false;
+            speculative_fallbacks_ = false;
         }
-
-        if( ! (topRightCorner_b & topLeftCorner_b & bottomRightCorner_b & bottomLeftCorner_b) )
-        {
-            ROS_ERROR("Footprint must have four corners and center of rotation inside the footprint");
-            return;
+        // Check every coarse_check_stride-th pose of a candidate first, so colliding candidates are rejected after a few checks
+        private_nh.param("coarse_check_stride", coarse_check_stride_, 8);
+        // Validate free stretches of a straight line at once, poses are checked one by one only close to obstacles
+        private_nh.param("line_sweep_length", line_sweep_length_, 4.0);
+        // Remember checked segments while the costmap around them does not change
+        bool candidate_memo;
+        int candidate_memo_size;
+        private_nh.param("candidate_memo", candidate_memo, true);
+        private_nh.param("candidate_memo_size", candidate_memo_size, 20000);
+        if( candidate_memo )
+            candidate_memo_.reset(new CandidateMemo(candidate_memo_size));
+        // Time budget of a plan when the caller gives no deadline, the best plan found so far is returned when it runs out
+        private_nh.param("max_planning_time", max_planning_time_, 0.0);
+        // Record the inputs of every plan for maneuver_planner_replay, planners recording to the same file share it
+        std::string record_file;
+        private_nh.param("record_file", record_file, std::string(""));
+        private_nh.param("record_window_margin", record_window_margin_, 3.0);
+        if( !record_file.empty() )
+            recorder_ = PlanRecorder::open(record_file);
+        valid_last_goal_ = false;
+        std::string world_model_type;
+        private_nh.param("world_model", world_model_type, std::string("costmap"));
+        if( world_model_type == "distance_field" )
+        {   // Footprint checks with a few distance lookups, the distances are updated before every plan
+            distance_field_model_ = new base_local_planner::DistanceFieldModel(*costmap_);
+            world_model_ = distance_field_model_;
         }
         else
         {
-	    right_side_ref_point_ << 0.1, bottomRightCorner_[1];
-	    left_side_ref_point_  << 0.1, bottomLeftCorner_[1] ;
+            if( world_model_type != "costmap" )
+                ROS_WARN("Unknown world model %s, using the costmap", world_model_type.c_str());
+            world_model_ = new base_local_planner::CostmapModel(*costmap_);
+            // Footprint checks through per heading rasterized templates, 0 bins uses the exact costmap model
+            int footprint_heading_bins;
+            private_nh.param("footprint_heading_bins", footprint_heading_bins, 256);
+            if( footprint_heading_bins > 0 )
+                footprint_cache_.reset(new base_local_planner::FootprintTemplateCache(*costmap_, footprint_heading_bins));
         }
+
+
+        // One footprint model for all the checks, with the templates rasterized for the costmap resolution
+        shared_footprint_.reset(new base_local_planner::SharedFootprintModel(footprint_cache_ ? footprint_cache_->numHeadingBins() : 1));
+        shared_footprint_->set(footprint_spec, footprint_cache_ ? costmap_->getResolution() : 0.0);
+        footprint_from_costmap_ = true;
+        // For now only rectangular robot shape is supported
+        updateFootprint();
+        if( !footprint_->hasFourCorners() )
+            return;
         
        
         radius_search_ = parameter_generator::ParameterGenerator(0.1, 2.0, 2.0, 0.05, 20);
         midway_scale_lr_search_ = parameter_generator::ParameterGenerator(0.0, 0.9, 1.0, 0.1, 20);
         midway_side_ovt_search_ = parameter_generator::ParameterGenerator(0.0, 1.0, 1.0, 0.1, 20);
+        // Order in which turning radii and midway goals are tried. golden_section narrows down on the candidates that get furthest before colliding
+        std::string parameter_search;
+        private_nh.param("parameter_search", parameter_search, std::string("mid"));
+        parameter_generator::ParameterGenerator::SearchStrategy search_strategy = parameter_generator::ParameterGenerator::MID_SEARCH;
+        if( parameter_search == "linear" )
+            search_strategy = parameter_generator::ParameterGenerator::LINEAR_SEARCH;
+        else if( parameter_search == "golden_section" )
+            search_strategy = parameter_generator::ParameterGenerator::GOLDEN_SECTION_SEARCH;
+        else if( parameter_search != "mid" )
+            ROS_WARN("Unknown parameter search %s, using mid", parameter_search.c_str());
+        radius_search_.setStrategy(search_strategy);
+        midway_scale_lr_search_.setStrategy(search_strategy);
         maxDistanceBeforeObstacle_ = 1.0; // TODO: Use parameter // TODO: make the  parameter tunable from constructor
         maxDistanceBeforeReplanning_ = 1.0; // TODO: Use parameter // TODO: make the  parameter tunable from constructor
         initialized_ = true;
@@ -131,45 +214,19 @@ void ManeuverPlanner::initialize(std::string name, costmap_2d::Costmap2DROS* cos
         ROS_WARN("This planner has already been initialized... doing nothing");
 }
 
-void ManeuverPlanner::rotate2D(const tf::Stamped<tf::Pose> &pose_tf_in, const double theta, tf::Stamped<tf::Pose> &pose_tf_out)
-{
-    tf::Vector3 origin;
-    tf::Quaternion quat;
-    quat.setRPY(0.0,0.0,theta);
-    double ty,tp,tr;
-    origin = pose_tf_in.getOrigin().rotate(tf::Vector3(0,0,1),theta);
-    pose_tf_in.getBasis().getEulerYPR(ty,tp,tr);
-    quat.setRPY(0.0,0.0,theta+ty);
-    pose_tf_out.setData(tf::Transform(quat,origin));
-    pose_tf_out.stamp_ = pose_tf_in.stamp_;
-
-    return;
-
-
-}
-
-void ManeuverPlanner::translate2D(const tf::Stamped<tf::Pose>& pose_tf_in, const tf::Vector3& vector3_translation, tf::Stamped<tf::Pose> &pose_tf_out)
+SE2 ManeuverPlanner::poseToSE2(const geometry_msgs::Pose& pose)
 {
-
-    tf::Vector3 origin;
-    tf::Quaternion quat;
-
-    origin = pose_tf_in.getOrigin() + vector3_translation;
-    quat = pose_tf_in.getRotation();
-    pose_tf_out.setData(tf::Transform(quat,origin));
-    pose_tf_out.stamp_ = pose_tf_in.stamp_;
-
+    return SE2(pose.position.x, pose.position.y, tf::getYaw(pose.orientation));
 }
 
-int  ManeuverPlanner::determineManeuverType(const tf::Stamped<tf::Pose>& pose_target,  double &signed_max_turning_radius, double& x_intersection)
+int  ManeuverPlanner::determineManeuverType(const SE2& pose_target,  double &signed_max_turning_radius, double& x_intersection)
 {
     
     int maneuver_type = ManeuverPlanner::MANEUVER_NONE;
 
-    double x_target   = pose_target.getOrigin().getX();
-    double y_target   = pose_target.getOrigin().getY();
-    double yaw_target,useless_pitcht,useless_rollt;
-    pose_target.getBasis().getEulerYPR(yaw_target,useless_pitcht,useless_rollt);
+    double x_target   = pose_target.x();
+    double y_target   = pose_target.y();
+    double yaw_target = pose_target.theta();
     double theta_target = std::atan2(y_target,x_target);
     
 
@@ -240,14 +297,13 @@ int  ManeuverPlanner::determineManeuverType(const tf::Stamped<tf::Pose>& pose_ta
 }
 
 
-bool ManeuverPlanner::computeSingleManeuverParameters(const tf::Stamped<tf::Pose>& pose_target, const double& signed_turning_radius, const double& x_intersection, double &dist_before_steering, double &dist_after_steering)
+bool ManeuverPlanner::computeSingleManeuverParameters(const SE2& pose_target, const double& signed_turning_radius, const double& x_intersection, double &dist_before_steering, double &dist_after_steering)
 {
     dist_before_steering   = -1.0;
     dist_after_steering    = -1.0;
-    double x_target   = pose_target.getOrigin().getX();
-    double y_target   = pose_target.getOrigin().getY();
-    double yaw_target,useless_pitcht,useless_rollt;
-    pose_target.getBasis().getEulerYPR(yaw_target,useless_pitcht,useless_rollt);
+    double x_target   = pose_target.x();
+    double y_target   = pose_target.y();
+    double yaw_target = pose_target.theta();
 
     // here no checks are done on the validity of the radius and intersection. That is done in determineManeuverType function, which must be called before
     
@@ -267,6 +323,133 @@ bool ManeuverPlanner::computeSingleManeuverParameters(const tf::Stamped<tf::Pose
     return true;
 }
 
+void ManeuverPlanner::computeSingleManeuverParameters(const SE2& pose_target, const std::vector<double>& signed_turning_radii, const double& x_intersection,
+                                           std::vector<double>& dist_before_steering, std::vector<double>& dist_after_steering, std::vector<char>& curve_possible)
+{
+    const double x_target   = pose_target.x();
+    const double y_target   = pose_target.y();
+    const double yaw_target = pose_target.theta();
+    const size_t n_radii    = signed_turning_radii.size();
+    
+    // Terms that do not depend on the radius are computed once. The loop has no branches, so the compiler can vectorize it
+    const double dist_target_to_intersection = std::sqrt( (x_target-x_intersection)*(x_target-x_intersection) + y_target*y_target );    
+    const double tan_half_angle = tan((M_PI-yaw_target)/2.0);
+    
+    dist_before_steering.resize(n_radii);
+    dist_after_steering.resize(n_radii);
+    curve_possible.resize(n_radii);
+    for (size_t i = 0; i < n_radii; i++)
+    {
+        double dist_x_intersection_steering = signed_turning_radii[i]/tan_half_angle;
+        dist_before_steering[i] = x_intersection - dist_x_intersection_steering;
+        dist_after_steering[i]  = dist_target_to_intersection - dist_x_intersection_steering;
+        curve_possible[i] = !( (dist_before_steering[i] < 0.0) | (dist_after_steering[i] < 0.0) | (dist_before_steering[i] > x_intersection) );
+    }
+}
+
+const std::vector<geometry_msgs::Point>& ManeuverPlanner::getRobotFootprint() const
+{
+    return footprint_->getFootprint();
+}
+
+std::string ManeuverPlanner::getGlobalFrameID() const
+{
+    if( costmap_ros_ )
+        return costmap_ros_->getGlobalFrameID();
+    return global_frame_;
+}
+
+/**
+ * A search run on one thread of the pool, cancelled and collected apart from the rest of the plan.
+ * Its statistics go to the collector of the plan, like those of all the searches
+ */
+struct ManeuverPlanner::SearchContext
+{
+    boost::atomic<bool> interrupted;
+    bool succesful;
+    double dist_without_obstacles;
+    int fallback;
+    base_local_planner::CompactPlan plan;
+    
+    SearchContext() : interrupted(false), succesful(false), dist_without_obstacles(0.0), fallback(PlanningStatistics::FALLBACK_NONE) {}
+};
+
+boost::thread_specific_ptr<ManeuverPlanner::SearchContext> ManeuverPlanner::search_context_(&ManeuverPlanner::keepSearchContext);
+
+boost::atomic<bool>& ManeuverPlanner::searchInterrupted()
+{
+    SearchContext* context = search_context_.get();
+    return context ? context->interrupted : *search_interrupted_;
+}
+
+bool ManeuverPlanner::deadlinePassed()
+{
+    boost::atomic<bool>& interrupted = searchInterrupted();
+    if( interrupted.load(boost::memory_order_relaxed) )
+        return true;
+    if( deadline_.isZero() || ros::WallTime::now() < deadline_ )
+        return false;
+    interrupted.store(true, boost::memory_order_relaxed);
+    return true;
+}
+
+unsigned long ManeuverPlanner::getFootprintChecks() const
+{
+    if( !footprint_checks_ )
+        return 0;
+    return footprint_checks_->load(boost::memory_order_relaxed);
+}
+
+void ManeuverPlanner::setFootprintModel(const boost::shared_ptr<base_local_planner::SharedFootprintModel>& footprint_model)
+{
+    shared_footprint_ = footprint_model;
+    footprint_from_costmap_ = false;
+}
+
+void ManeuverPlanner::updateFootprint()
+{
+    // The footprint of the costmap is copied once per plan, and only when no model is shared with the caller
+    if( costmap_ros_ && footprint_from_costmap_ )
+        shared_footprint_->set(costmap_ros_->getRobotFootprint(), footprint_cache_ ? costmap_->getResolution() : 0.0);
+    base_local_planner::FootprintModelConstPtr footprint = shared_footprint_->get();
+    
+    // Templates of the shared model are reused, they are rebuilt only when they were made for another costmap resolution
+    if( footprint_cache_ && footprint_cache_->setFootprintModel(footprint) )
+        ROS_DEBUG("Footprint templates of version %lu in use", footprint->version());
+    if( distance_field_model_ )
+        distance_field_model_->setFootprint(footprint->getFootprint());
+    
+    if( footprint == footprint_ )
+        return;
+    // A new footprint, e.g. after attaching a load
+    footprint_ = footprint;
+    footprint_radius_ = footprint_->circumscribedRadius();
+    setCorners(*footprint_);
+}
+
+bool ManeuverPlanner::setCorners(const base_local_planner::FootprintModel& footprint)
+{
+    if( footprint.getFootprint().size() != 4 )
+    {
+        ROS_ERROR("Footprint must have hour points");
+        return false;
+    }
+    if( !footprint.hasFourCorners() )
+    {
+        ROS_ERROR("Footprint must have four corners and center of rotation inside the footprint");
+        return false;
+    }
+    
+    // The heading of the robot is towards the x axis.
+    topLeftCorner_     << footprint.frontLeftCorner().x, footprint.frontLeftCorner().y;
+    topRightCorner_    << footprint.frontRightCorner().x, footprint.frontRightCorner().y;
+    bottomLeftCorner_  << footprint.rearLeftCorner().x, footprint.rearLeftCorner().y;
+    bottomRightCorner_ << footprint.rearRightCorner().x, footprint.rearRightCorner().y;
+    right_side_ref_point_ << 0.1, bottomRightCorner_[1];
+    left_side_ref_point_  << 0.1, bottomLeftCorner_[1] ;
+    return true;
+}
+
 //we need to take the footprint of the robot into account when we calculate cost to obstacles
 double ManeuverPlanner::footprintCost(double x_i, double y_i, double theta_i)
 {
@@ -275,15 +458,23 @@ double ManeuverPlanner::footprintCost(double x_i, double y_i, double theta_i)
         ROS_ERROR("The planner has not been initialized, please call initialize() to use the planner");
         return -1.0;
     }
+    footprint_checks_->fetch_add(1, boost::memory_order_relaxed);
 
-    std::vector<geometry_msgs::Point> footprint = costmap_ros_->getRobotFootprint();
+    if( footprint_cache_ )
+    {   // Templates are kept up to date by updateFootprint
+        if( !footprint_cache_->hasFootprint() )
+            return -1.0;
+        return footprint_cache_->footprintCost(x_i, y_i, theta_i);
+    }
+    if( distance_field_model_ )
+        return distance_field_model_->footprintCost(x_i, y_i, theta_i);
 
     //if we have no footprint... do nothing
-    if(footprint.size() < 3)
+    if(!footprint_->hasFootprint())
         return -1.0;
 
-    //check if the footprint is legal
-    double footprint_cost = world_model_->footprintCost(x_i, y_i, theta_i, footprint);    
+    //check if the footprint is legal, with the radii of the model
+    double footprint_cost = world_model_->footprintCost(x_i, y_i, theta_i, *footprint_);    
   
     /* std::cout << "footprint_cost " << footprint_cost <<std::endl; */
     
@@ -297,120 +488,35 @@ double ManeuverPlanner::footprintCost(double x_i, double y_i, double theta_i)
 }
 
 
-void ManeuverPlanner::generateDublinTrajectory(const double& dist_before_steering_refp, const double& dist_after_steering_refp, 
-                               const double& signed_turning_radius_refp, const double& theta_refp_goal, std::vector<tf::Pose> &local_plan_refp)
+void ManeuverPlanner::initCenterTrajectory(const SE2& refpoint_robot_coord, CenterTrajectoryState& center_state)
 {
-    
-    // Compute trajectory as points. Only the center of teh robot has a pose and orientation
-    motion_refpoint_localtraj_ << 0.0, 0.0; // starts at origin by definition
-    prev_motion_refpoint_localtraj_  << 0.0, 0.0;
-    tf::Quaternion temp_quat;
-    tf::Vector3 temp_vector3;
-    tf::Pose ref_traj_point_tf_refstart_coord; // current  Refpoint in the the start position of the reference point coordinate frame    
-    bool traj_ready = false;    
-    double theta_refp_traj = 0.0 ; // This is only to control evolution of the curvature.
-    double theta_refp_traj_gridsz = step_size_/signed_turning_radius_refp; // Gridsize of the trajectory angle
-    double dist_bef_steer = 0.0, dist_af_steer = 0.0;    
-    double theta_refp_goal_internal = 0.0;
-    
-    if(theta_refp_traj_gridsz < 0)
-    {
-        theta_refp_goal_internal = - std::abs(theta_refp_goal);
-    }
-    else
-    {
-        theta_refp_goal_internal = std::abs(theta_refp_goal);
-    }
-    
-    local_plan_refp.clear();
-    
-    while (!traj_ready)
-    {
-        // Generate next reference refpoint in trajectory
-        if( dist_bef_steer <  dist_before_steering_refp)
-        {   // Move straight before steering
-            theta_refp_traj = 0;
-            motion_refpoint_localtraj_[0] = prev_motion_refpoint_localtraj_[0]+ step_size_;
-            motion_refpoint_localtraj_[1] = prev_motion_refpoint_localtraj_[1];
-            dist_bef_steer += step_size_;
-        } 
-        else if(std::abs(theta_refp_goal_internal-theta_refp_traj) > std::abs(theta_refp_traj_gridsz/2.0))
-        {   // Turn with circle. This can be as well a clothoid!
-            theta_refp_traj +=theta_refp_traj_gridsz;
-            motion_refpoint_localtraj_[0] = dist_before_steering_refp +signed_turning_radius_refp*std::sin(theta_refp_traj);
-            motion_refpoint_localtraj_[1] = signed_turning_radius_refp*(1.0 - std::cos(theta_refp_traj));
-        } 
-        else if( dist_af_steer <  dist_after_steering_refp)
-        {   // Move straight after steering
-            theta_refp_traj = theta_refp_goal_internal;
-            motion_refpoint_localtraj_[0] = prev_motion_refpoint_localtraj_[0]+ step_size_*std::cos(theta_refp_traj);
-            motion_refpoint_localtraj_[1] = prev_motion_refpoint_localtraj_[1]+ step_size_*std::sin(theta_refp_traj);
-            dist_af_steer += step_size_;
-        }
-        else
-        {
-            traj_ready = true;
-            break;
-        }
-        prev_motion_refpoint_localtraj_ = motion_refpoint_localtraj_;
-        
-        // Add point to trajectory
-        temp_quat.setRPY(0.0,0.0,theta_refp_traj);
-        temp_vector3 = tf::Vector3(motion_refpoint_localtraj_[0], motion_refpoint_localtraj_[1], theta_refp_traj);        
-        ref_traj_point_tf_refstart_coord.setOrigin(temp_vector3);
-        ref_traj_point_tf_refstart_coord.setRotation(temp_quat);
-        local_plan_refp.push_back(ref_traj_point_tf_refstart_coord);        
-    }  
-    
+    // Trajectory of reference point starts by definition at the origin, the center point at -refpoint_robot_coord
+    center_state.prev_motion_refpoint_localtraj << 0.0, 0.0;
+    center_state.center_pose_loctrajframe << -refpoint_robot_coord.x(), -refpoint_robot_coord.y(), 0.0;
+    center_state.total_ahead_distance = 0.0;
 }
 
-
-
-bool ManeuverPlanner::checkFootprintTransformLocalToGlobal(const tf::Stamped<tf::Pose>& start_tf, 
-                                const tf::Stamped<tf::Pose>& goal_tf, const tf::Stamped<tf::Pose>& refpoint_tf_robot_coord, 
-                                const std::vector<tf::Pose>& local_plan_refp, std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles)
+bool ManeuverPlanner::checkDublinSegment(const SE2& start, const SE2& refpoint_robot_coord, 
+                                const DublinSegment& segment, CenterTrajectoryState& center_state, std::vector<Eigen::Vector3d>& center_traj,
+                                bool coarse_to_fine, const boost::atomic<size_t>* first_success_index, size_t candidate_index)
 {
-    std::vector<tf::Pose>::const_iterator local_plan_point_it;        
-    double start_yaw, goal_yaw, temp_yaw, temp_pitch, temp_roll, theta_refp_traj;
+    StageTimer timer(statistics_ ? &statistics_->collision_check_time : NULL);
+    Eigen::Vector2d motion_refpoint_localtraj;
+    Eigen::Vector2d& prev_motion_refpoint_localtraj = center_state.prev_motion_refpoint_localtraj;
+    Eigen::Vector3d& center_pose_loctrajframe = center_state.center_pose_loctrajframe;
+    double theta_refp_traj;
     
-    tf::Quaternion temp_quat;
-    tf::Vector3 temp_vector3;
-    start_tf.getBasis().getEulerYPR(start_yaw, temp_pitch, temp_roll);    
-
-    double footprint_cost;
-    Eigen::Matrix2d jacobian_motrefPoint;
-    Eigen::Matrix2d invjacobian_motrefPoint;
-
-    tf::Pose ref_traj_point_tf_refstart_coord; // current  Refpoint in the the start position of the reference point coordinate frame
-    tf::Stamped<tf::Pose> center_traj_point_tf_refstart_coord; // current  Center point in the the start position of the reference point coordinate frame
-    tf::Stamped<tf::Pose> center_traj_point_tf; // current  Center point in the global coordinate frame
-
-    // Initialize trajectory of reference point. By definition at the origin
-
-
-    // Initialize trajectory of center point. By definition at -refpoint_tf_robot_coord
-    center_traj_point_tf_refstart_coord.frame_id_ = "/refpoint_start_pos";
-    center_traj_point_tf_refstart_coord.stamp_ = goal_tf.stamp_;
-    temp_quat.setRPY(0.0,0.0,0.0);
-    temp_vector3 = -refpoint_tf_robot_coord.getOrigin();
-    center_traj_point_tf_refstart_coord.setData(tf::Transform(temp_quat,temp_vector3));
-    // This pose as a vector because it will be more direct to make operations on it. x y theta
-    center_pose_loctrajframe_ << temp_vector3.getX(), temp_vector3.getY(), 0.0;
-
-
-    // Compute global coordinates center trajectory point
-    center_traj_point_tf.frame_id_ = goal_tf.frame_id_;
-    center_traj_point_tf.stamp_ = goal_tf.stamp_;
-
-    translate2D(center_traj_point_tf_refstart_coord,refpoint_tf_robot_coord.getOrigin(),center_traj_point_tf);
-    rotate2D(center_traj_point_tf,start_yaw,center_traj_point_tf);
-    translate2D(center_traj_point_tf,start_tf.getOrigin(),center_traj_point_tf);
+    // Start position of the reference point in the global frame
+    const SE2 refpoint_start = start*refpoint_robot_coord;
+    const double refp_x = refpoint_robot_coord.x();
+    const double refp_y = refpoint_robot_coord.y();
     
     // Jacobian to compute virtual velocities and therefore positions.      
-    jacobian_motrefPoint  << 1.0 , -refpoint_tf_robot_coord.getOrigin().getY(),
-                                0.0 ,  refpoint_tf_robot_coord.getOrigin().getX();                  
-
-    if ( refpoint_tf_robot_coord.getOrigin().getX() != 0.0 )
+    Eigen::Matrix2d jacobian_motrefPoint;
+    Eigen::Matrix2d invjacobian_motrefPoint;
+    jacobian_motrefPoint  << 1.0 , -refp_y,
+                             0.0 ,  refp_x;                  
+    if ( refp_x != 0.0 )
     {   // Check refpoint is not at the center
         invjacobian_motrefPoint = jacobian_motrefPoint.inverse();                   
     }
@@ -420,241 +526,296 @@ bool ManeuverPlanner::checkFootprintTransformLocalToGlobal(const tf::Stamped<tf:
                                     0.0, 0.0;
     }    
     
-
-    bool traj_free = true;
-    
-    
-    prev_motion_refpoint_localtraj_[0] = 0.0;
-    prev_motion_refpoint_localtraj_[1] = 0.0;
-        
-    double total_ahead_distance = 0.0;
+    // A segment checked before, with the costmap around it unchanged, is only generated again
+    CandidateMemo::Key memo_key;
+    CandidateMemoEntry memo_entry;
+    bool replay = false;
+    if( candidate_memo_ )
+    {
+        makeMemoKey(start, refpoint_robot_coord, segment, center_state, memo_key);
+        if( candidate_memo_->lookup(memo_key, memo_entry) )
+        {
+            if( !memo_entry.traj_free && coarse_to_fine )
+                return false;
+            replay = memo_entry.traj_free || memo_entry.collision_pose >= 0;
+        }
+    }
     
-    for (local_plan_point_it = local_plan_refp.begin(); local_plan_point_it != local_plan_refp.end(); local_plan_point_it++)
+    DublinTrajectoryGenerator generator(segment, step_size_);
+    // The heading of the center is rotated into and then integrated with, so its sine and cosine carry over to the next pose
+    double cos_center_theta = std::cos(center_pose_loctrajframe[2]);
+    double sin_center_theta = std::sin(center_pose_loctrajframe[2]);
+    bool traj_free = true;
+    const size_t first_pose = center_traj.size();
+    size_t arc_first_pose = first_pose;
+    size_t arc_poses = 0;
+    int collision_pose = -1;
+    memo_entry.min_x = memo_entry.min_y = std::numeric_limits<double>::max();
+    memo_entry.max_x = memo_entry.max_y = -std::numeric_limits<double>::max();
+    
+    // Reference point poses are generated, converted to the center and checked one at a time, stopping at the first collision.
+    // In coarse to fine mode only every stride-th pose is checked while generating, the rest once the segment is complete
+    while( generator.next(motion_refpoint_localtraj[0], motion_refpoint_localtraj[1], theta_refp_traj) )
     {            
-        motion_refpoint_localtraj_[0] = local_plan_point_it->getOrigin().getX();        
-        motion_refpoint_localtraj_[1] = local_plan_point_it->getOrigin().getY(); 
-        local_plan_point_it->getBasis().getEulerYPR(theta_refp_traj, temp_pitch, temp_roll);
-        
+        if( first_success_index != NULL && first_success_index->load(boost::memory_order_relaxed) < candidate_index )
+        {   // A candidate with higher priority already succeeded, this one will not be used
+            traj_free  = false;
+            break;
+        }
         
         // Now compute robot center of rotation trajectory
         // Compute virtual velocity of reference point. Virtual time of 1.0 sec
         Eigen::Vector2d motion_refpoint_virvel_loctrajframe;
         Eigen::Vector2d motion_refpoint_deltapos_loctrajframe;        
-        motion_refpoint_deltapos_loctrajframe = (motion_refpoint_localtraj_ - prev_motion_refpoint_localtraj_);
-        total_ahead_distance = total_ahead_distance + hypot(motion_refpoint_deltapos_loctrajframe[0],motion_refpoint_deltapos_loctrajframe[1]);
+        motion_refpoint_deltapos_loctrajframe = (motion_refpoint_localtraj - prev_motion_refpoint_localtraj);
+        center_state.total_ahead_distance = center_state.total_ahead_distance + hypot(motion_refpoint_deltapos_loctrajframe[0],motion_refpoint_deltapos_loctrajframe[1]);
         motion_refpoint_virvel_loctrajframe = motion_refpoint_deltapos_loctrajframe/1.0;
-        prev_motion_refpoint_localtraj_ = motion_refpoint_localtraj_;
+        prev_motion_refpoint_localtraj = motion_refpoint_localtraj;
 
-        if ( refpoint_tf_robot_coord.getOrigin().getX() != 0.0 )
+        if ( refp_x != 0.0 )
         {   // Check refpoint is not at the center
             //Compute center of rotation pose from inverse Jacobian
             Eigen::Matrix2d RotM;
-            RotM    << std::cos(center_pose_loctrajframe_[2]),  std::sin(center_pose_loctrajframe_[2]),
-                        -std::sin(center_pose_loctrajframe_[2]),  std::cos(center_pose_loctrajframe_[2]);
+            RotM    << cos_center_theta,  sin_center_theta,
+                        -sin_center_theta,  cos_center_theta;
             // Compute refpoint velocity local at the robot by rotating velocity vector
             Eigen::Vector2d motion_refpoint_virvel_robotframe;
             motion_refpoint_virvel_robotframe = RotM*motion_refpoint_virvel_loctrajframe;
             // Compute the corresponding robot velocity using inverse of the jacobian
             Eigen::Vector2d center_vel_robotframe;          
-            motion_refpoint_virvel_robotframe[0]=motion_refpoint_virvel_robotframe[0];
-            motion_refpoint_virvel_robotframe[1]=motion_refpoint_virvel_robotframe[1];
             center_vel_robotframe = invjacobian_motrefPoint*motion_refpoint_virvel_robotframe; // [dx dtheta]
             // Compute evolution of the robot by integrating virtual velocity (dt virtual is 1.0 sec)
-            center_pose_loctrajframe_[2] += 1.0*center_vel_robotframe[1];
-            center_pose_loctrajframe_[0] += 1.0*center_vel_robotframe[0]*std::cos(center_pose_loctrajframe_[2]);
-            center_pose_loctrajframe_[1] += 1.0*center_vel_robotframe[0]*std::sin(center_pose_loctrajframe_[2]);
+            center_pose_loctrajframe[2] += 1.0*center_vel_robotframe[1];
+            cos_center_theta = std::cos(center_pose_loctrajframe[2]);
+            sin_center_theta = std::sin(center_pose_loctrajframe[2]);
+            center_pose_loctrajframe[0] += 1.0*center_vel_robotframe[0]*cos_center_theta;
+            center_pose_loctrajframe[1] += 1.0*center_vel_robotframe[0]*sin_center_theta;
         }
         else
         {
             // Compute center of rotation directly from ref_point positions
-            center_pose_loctrajframe_[0] = motion_refpoint_localtraj_[0];
-            center_pose_loctrajframe_[1] = motion_refpoint_localtraj_[1];
-            center_pose_loctrajframe_[2] = theta_refp_traj;
-
+            center_pose_loctrajframe[0] = motion_refpoint_localtraj[0];
+            center_pose_loctrajframe[1] = motion_refpoint_localtraj[1];
+            center_pose_loctrajframe[2] = theta_refp_traj;
         }
 
-        // Center pose in local trajectory frame, in tf::PoseStamped
-        temp_quat.setRPY(0.0,0.0,center_pose_loctrajframe_[2]);
-        temp_vector3 = tf::Vector3(center_pose_loctrajframe_[0],center_pose_loctrajframe_[1],0.0);
-        center_traj_point_tf_refstart_coord.setData(tf::Transform(temp_quat,temp_vector3));
-
-        // Center pose in global frame, in tf::PoseStamped
-        translate2D(center_traj_point_tf_refstart_coord,refpoint_tf_robot_coord.getOrigin(),center_traj_point_tf);
-        rotate2D(center_traj_point_tf,start_yaw,center_traj_point_tf);
-        translate2D(center_traj_point_tf,start_tf.getOrigin(),center_traj_point_tf);
+        // Center pose in global frame
+        Eigen::Vector3d center_pose_global;
+        refpoint_start.transformPoint(center_pose_loctrajframe[0], center_pose_loctrajframe[1], center_pose_global[0], center_pose_global[1]);
+        center_pose_global[2] = angles::normalize_angle(refpoint_start.theta() + center_pose_loctrajframe[2]);
+        
+        if( replay )
+        {   // Outcome known from the memo
+            if( !memo_entry.traj_free && center_traj.size() - first_pose == (size_t) memo_entry.collision_pose )
+            {
+                traj_free  = false;
+                break;
+            }
+            center_traj.push_back(center_pose_global);
+            continue;
+        }
+        memo_entry.min_x = std::min(memo_entry.min_x, center_pose_global[0]);
+        memo_entry.min_y = std::min(memo_entry.min_y, center_pose_global[1]);
+        memo_entry.max_x = std::max(memo_entry.max_x, center_pose_global[0]);
+        memo_entry.max_y = std::max(memo_entry.max_y, center_pose_global[1]);
+        
+        if( coarse_to_fine )
+        {
+            if( generator.onArc() && arc_poses++ == 0 )
+                arc_first_pose = center_traj.size();
+            if( (center_traj.size() - first_pose) % coarse_check_stride_ == (size_t) coarse_check_stride_ - 1 &&
+                footprintCost(center_pose_global[0], center_pose_global[1], center_pose_global[2]) < 0 )
+            {
+                traj_free  = false;
+                break;
+            }
+            center_traj.push_back(center_pose_global);
+            continue;
+        }
         
-        center_traj_point_tf.getBasis().getEulerYPR(temp_yaw, temp_pitch, temp_roll);
-        temp_vector3 = center_traj_point_tf.getOrigin();
-        footprint_cost = footprintCost(temp_vector3.getX(), temp_vector3.getY(), temp_yaw);
-        if(footprint_cost < 0)
+        if( footprintCost(center_pose_global[0], center_pose_global[1], center_pose_global[2]) < 0 )
         {
             traj_free  = false;
+            collision_pose = center_traj.size() - first_pose;
             break;
         }
-        else
-        {   // Add current point to overall trajectory
-            geometry_msgs::PoseStamped traj_point;
-            poseStampedTFToMsg(center_traj_point_tf,traj_point);
-            tf::Quaternion goal_quat = tf::createQuaternionFromYaw(temp_yaw);
-
-            traj_point.pose.position.x = temp_vector3.getX();
-            traj_point.pose.position.y = temp_vector3.getY();
-
-            traj_point.pose.orientation.x = goal_quat.x();
-            traj_point.pose.orientation.y = goal_quat.y();
-            traj_point.pose.orientation.z = goal_quat.z();
-            traj_point.pose.orientation.w = goal_quat.w();
-
-            plan.push_back(traj_point);
-
-        }
-        
+        // Add current point to overall trajectory
+        center_traj.push_back(center_pose_global);
+    }
+    
+    if( replay )
+        return traj_free;
+    
+    if( coarse_to_fine && traj_free )
+    {   // Apex of the turn, or the middle of the segment if it is straight
+        size_t apex_pose = arc_poses > 0 ? arc_first_pose + arc_poses/2 : first_pose + (center_traj.size() - first_pose)/2;
+        traj_free = checkPosesCoarseToFine(center_traj, first_pose, apex_pose, first_success_index, candidate_index);
+    }
+    
+    // A cancelled check says nothing about the segment
+    bool cancelled = first_success_index != NULL && first_success_index->load() < candidate_index;
+    if( candidate_memo_ && !cancelled && memo_entry.min_x <= memo_entry.max_x )
+    {   // Footprint cells lie within its circumscribed radius, plus a cell for the rasterization
+        double margin = footprint_radius_ + costmap_->getResolution();
+        memo_entry.min_x -= margin;
+        memo_entry.min_y -= margin;
+        memo_entry.max_x += margin;
+        memo_entry.max_y += margin;
+        memo_entry.traj_free = traj_free;
+        memo_entry.collision_pose = collision_pose;
+        candidate_memo_->store(memo_key, memo_entry);
     }
-    dist_without_obstacles = total_ahead_distance;
     
     return traj_free;
-        
 }
 
-bool ManeuverPlanner::searchTrajectoryCompoundLeftRightManeuver(const tf::Stamped<tf::Pose>& start_tf, const tf::Stamped<tf::Pose>& goal_tf, 
-                                                        const tf::Stamped<tf::Pose>& refpoint_tf_robot_coord, std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles)
+void ManeuverPlanner::makeMemoKey(const SE2& start, const SE2& refpoint_robot_coord, const DublinSegment& segment,
+                                  const CenterTrajectoryState& center_state, CandidateMemo::Key& key) const
 {
-    tf::Stamped<tf::Pose> temp_goal_tf;
-    tf::Stamped<tf::Pose> temp_start_tf;
-    
-    temp_goal_tf.frame_id_ = goal_tf.frame_id_;
-    temp_goal_tf.stamp_ = goal_tf.stamp_;
+    key.clear();
+    key.push_back(start.x());
+    key.push_back(start.y());
+    key.push_back(start.theta());
+    key.push_back(refpoint_robot_coord.x());
+    key.push_back(refpoint_robot_coord.y());
+    key.push_back(refpoint_robot_coord.theta());
+    key.push_back(segment.dist_before_steering);
+    key.push_back(segment.dist_after_steering);
+    key.push_back(segment.signed_turning_radius);
+    key.push_back(segment.theta_goal);
+    key.push_back(segment.offset.x());
+    key.push_back(segment.offset.y());
+    key.push_back(segment.offset.theta());
+    key.push_back(segment.skip_first_pose);
+    // Chained segments continue from the end of the previous one
+    key.push_back(center_state.prev_motion_refpoint_localtraj[0]);
+    key.push_back(center_state.prev_motion_refpoint_localtraj[1]);
+    key.push_back(center_state.center_pose_loctrajframe[0]);
+    key.push_back(center_state.center_pose_loctrajframe[1]);
+    key.push_back(center_state.center_pose_loctrajframe[2]);
+}
 
-            
-    
-    tf::Stamped<tf::Pose> refpoint_start_tf; // Start Refpoint in the global coordinate frame
-    tf::Stamped<tf::Pose> refpoint_goal_tf; // Goal Refpoint in the global coordinate frame        
-    tf::Stamped<tf::Pose> refpoint_goal_tf_refstart_coord; // Goal Refpoint in the the start position of the reference point coordinate frame
-    tf::Stamped<tf::Pose> refpoint_goal_tf_refmidway_coord; // Goal Refpoint in the the midway position of the reference point coordinate frame. Used in second maneuver
-    double dist_before_steering_refp, dist_after_steering_refp, signed_turning_radius_refp;
-    double unsigned_radius;
-    double dist_before_steering_center, dist_after_steering_center, signed_turning_radius_center;
-    int curve_type;  
-    bool maneuver_traj_succesful = false;
-    double start_yaw, goal_yaw, temp_yaw, temp_pitch, temp_roll;
-    tf::Quaternion temp_quat;
-    tf::Vector3 temp_vector3;
-    start_tf.getBasis().getEulerYPR(start_yaw, temp_pitch, temp_roll);             
-    goal_tf.getBasis().getEulerYPR(goal_yaw, temp_pitch, temp_roll);             
+bool ManeuverPlanner::checkPosesCoarseToFine(const std::vector<Eigen::Vector3d>& center_traj, size_t first_pose, size_t apex_pose,
+                                             const boost::atomic<size_t>* first_success_index, size_t candidate_index)
+{
+    const size_t end_pose = center_traj.size();
+    if( first_pose == end_pose )
+        return true;
+    const size_t stride = coarse_check_stride_;
+    const size_t last_pose = end_pose - 1;
+    
+    // Every stride-th pose is already checked. Sparse poses first: the end of the segment and the apex of the turn,
+    // obstacles are mostly met there, then the rest of the poses in order
+    std::vector<size_t> check_order;
+    check_order.reserve(end_pose - first_pose);
+    for (size_t i = first_pose; i < end_pose; i++)
+    {
+        if( (i - first_pose) % stride == stride - 1 )
+            continue;
+        if( i == last_pose || i == apex_pose )
+            check_order.insert(check_order.begin(), i);
+        else
+            check_order.push_back(i);
+    }
     
-    tf::Stamped<tf::Pose> goal_tf_start_coord; // Goal in the start vector coordinates
-    goal_tf_start_coord.frame_id_ = "/center_rotation_start_pos";
+    for (size_t i = 0; i < check_order.size(); i++)
+    {
+        if( first_success_index != NULL && first_success_index->load(boost::memory_order_relaxed) < candidate_index )
+            return false;   // A candidate with higher priority already succeeded, this one will not be used
+        const Eigen::Vector3d& center_pose_global = center_traj[check_order[i]];
+        if( footprintCost(center_pose_global[0], center_pose_global[1], center_pose_global[2]) < 0 )
+            return false;
+    }
+    return true;
+}
 
-    translate2D(goal_tf,-start_tf.getOrigin(),goal_tf_start_coord);
-    rotate2D(goal_tf_start_coord,-start_yaw,goal_tf_start_coord);
-    
+void ManeuverPlanner::materializePlan(const std::vector<Eigen::Vector3d>& center_traj, base_local_planner::CompactPlan& plan)
+{
+    // Frame and stamp are set by makePlan
+    plan.reserve(plan.size() + center_traj.size());
+    std::vector<Eigen::Vector3d>::const_iterator center_traj_it;
+    for (center_traj_it = center_traj.begin(); center_traj_it != center_traj.end(); center_traj_it++)
+        plan.push_back((*center_traj_it)[0], (*center_traj_it)[1], (*center_traj_it)[2]);
+}
+
+bool ManeuverPlanner::searchTrajectoryCompoundLeftRightManeuver(const SE2& start, const SE2& goal, 
+                                                        const SE2& refpoint_robot_coord, base_local_planner::CompactPlan& plan, double & dist_without_obstacles)
+{
+    bool maneuver_traj_succesful = false;
     
     // Compute reference start and goal on global coordinates
-    refpoint_start_tf.frame_id_ = goal_tf.frame_id_;
-    refpoint_start_tf.stamp_ = goal_tf.stamp_;
-    rotate2D(refpoint_tf_robot_coord,start_yaw,refpoint_start_tf);
-    translate2D(refpoint_start_tf,start_tf.getOrigin(),refpoint_start_tf);
-
-    refpoint_goal_tf.frame_id_ = goal_tf.frame_id_;
-    refpoint_goal_tf.stamp_ = goal_tf.stamp_;
-    rotate2D(refpoint_tf_robot_coord,goal_yaw,refpoint_goal_tf);
-    translate2D(refpoint_goal_tf,goal_tf.getOrigin(),refpoint_goal_tf);
-
-    // Then Compute reference start and goal on reference start coordinates
-    refpoint_goal_tf_refstart_coord.frame_id_ = "/refpoint_start_pos";
-    refpoint_goal_tf_refstart_coord.stamp_ = goal_tf.stamp_;
-
-    translate2D(refpoint_goal_tf,-refpoint_start_tf.getOrigin(),refpoint_goal_tf_refstart_coord);
-    refpoint_start_tf.getBasis().getEulerYPR(temp_yaw, temp_pitch, temp_roll);
-    rotate2D(refpoint_goal_tf_refstart_coord,-temp_yaw,refpoint_goal_tf_refstart_coord);    
-    
-    tf::Stamped<tf::Pose> refpoint_midway_goal_tf_refstart_coord; // Midway Goal Refpoint in the the start position of the reference point coordinate frame
-    tf::Stamped<tf::Pose> center_midway_goal_tf; // center of rotation of "ideal" midway goal in global coordinate frame
+    SE2 refpoint_start = start*refpoint_robot_coord;            // Start Refpoint in the global coordinate frame
+    SE2 refpoint_goal = goal*refpoint_robot_coord;              // Goal Refpoint in the global coordinate frame
+    // Then Compute reference goal on reference start coordinates
+    SE2 refpoint_goal_refstart_coord = refpoint_start.inverse()*refpoint_goal;
+    
+    SE2 refpoint_midway_goal_refstart_coord; // Midway Goal Refpoint in the the start position of the reference point coordinate frame
+    SE2 center_midway_goal; // center of rotation of "ideal" midway goal in global coordinate frame
+    SE2 temp_start;
     // the minimiun angle for theta midway is the angle of the 
     double refp_theta_min;
     double refp_theta_max;
     double theta_refp_goal;
     
 
-    std::vector<geometry_msgs::PoseStamped> plan_first_m;
-    std::vector<geometry_msgs::PoseStamped> plan_second_m;
+    base_local_planner::CompactPlan plan_first_m;
+    base_local_planner::CompactPlan plan_second_m;
     
     
     double midway_scale_lr;
     
-    std::vector< tf::Stamped<tf::Pose> > refpoint_tf_robot_coord_vec;    
-    refpoint_tf_robot_coord_vec.push_back(refpoint_tf_robot_coord);
+    std::vector<SE2> refpoint_robot_coord_vec;    
+    refpoint_robot_coord_vec.push_back(refpoint_robot_coord);
     
-    midway_scale_lr_search_.resetMidSearch(midway_scale_lr_search_.lin_search_min_, midway_scale_lr_search_.lin_search_max_);
+    // Local copy of the generator, so concurrent searches do not share its state
+    parameter_generator::ParameterGenerator midway_scale_lr_search = midway_scale_lr_search_;
+    midway_scale_lr_search.resetMidSearch(midway_scale_lr_search_.lin_search_min_, midway_scale_lr_search_.lin_search_max_);
     
-    while( midway_scale_lr_search_.midSearch(midway_scale_lr) & !maneuver_traj_succesful){         
-               
+    while( midway_scale_lr_search.midSearch(midway_scale_lr) & !maneuver_traj_succesful){         
+        if( deadlinePassed() )
+            break;
+        if( statistics_ )
+            statistics_->midway_candidates.fetch_add(1, boost::memory_order_relaxed);
     
-        temp_vector3 = tf::Vector3( midway_scale_lr*refpoint_goal_tf_refstart_coord.getOrigin().getX(), refpoint_goal_tf_refstart_coord.getOrigin().getY()/2.0, 0.0);    
-        refpoint_midway_goal_tf_refstart_coord.setOrigin(temp_vector3);
-        refp_theta_min = std::atan2(refpoint_midway_goal_tf_refstart_coord.getOrigin().getY(), refpoint_midway_goal_tf_refstart_coord.getOrigin().getX());    
+        refpoint_midway_goal_refstart_coord.setOrigin(midway_scale_lr*refpoint_goal_refstart_coord.x(), refpoint_goal_refstart_coord.y()/2.0);
+        refp_theta_min = std::atan2(refpoint_midway_goal_refstart_coord.y(), refpoint_midway_goal_refstart_coord.x());    
         if( refp_theta_min > 0)   // Left right
             refp_theta_max = M_PI/2.0;
         else // Right left
             refp_theta_max = -M_PI/2.0;
         
         theta_refp_goal = angles::normalize_angle(refp_theta_min + 0.5*(refp_theta_max-refp_theta_min)  ); // Final angle of mid goal // For now set a fix value. We can do also a search on this parameter_generator 
-        temp_quat.setRPY(0.0, 0.0, theta_refp_goal); 
-        refpoint_midway_goal_tf_refstart_coord.setRotation(temp_quat);
-        
-//         ROS_INFO("refpoint_midway_goal_loc: %f, %f, %f", refpoint_midway_goal_tf_refstart_coord.getOrigin().getX(), refpoint_midway_goal_tf_refstart_coord.getOrigin().getY(), theta_refp_goal);
+        refpoint_midway_goal_refstart_coord.setTheta(theta_refp_goal);
         
-         // Convert back to global coordinates
-        temp_quat.setRPY(0.0, 0.0, 0.0); 
-        center_midway_goal_tf.setOrigin(-refpoint_tf_robot_coord.getOrigin());
-        center_midway_goal_tf.setRotation(temp_quat);
-        rotate2D(center_midway_goal_tf,theta_refp_goal,center_midway_goal_tf); 
-        translate2D(center_midway_goal_tf,refpoint_midway_goal_tf_refstart_coord.getOrigin(),center_midway_goal_tf);        
+//         ROS_INFO("refpoint_midway_goal_loc: %f, %f, %f", refpoint_midway_goal_refstart_coord.x(), refpoint_midway_goal_refstart_coord.y(), theta_refp_goal);
         
-        translate2D(center_midway_goal_tf,refpoint_tf_robot_coord.getOrigin(),center_midway_goal_tf);        
-        rotate2D(center_midway_goal_tf,start_yaw,center_midway_goal_tf); 
-        translate2D(center_midway_goal_tf,start_tf.getOrigin(),center_midway_goal_tf);
-
-       
-                
-        temp_start_tf = start_tf;
-        temp_goal_tf.setOrigin(center_midway_goal_tf.getOrigin()); 
-        temp_goal_tf.setRotation(center_midway_goal_tf.getRotation()); 
+        // Convert back to global coordinates: center of the robot when the reference point is at the midway goal
+        center_midway_goal = refpoint_start*refpoint_midway_goal_refstart_coord*refpoint_robot_coord.inverse();
         
         double dist_without_obstacles_single_maneuver;  
         plan_first_m.clear();
-        maneuver_traj_succesful = searchTrajectorySingleManeuver(temp_start_tf, temp_goal_tf, refpoint_tf_robot_coord_vec, plan_first_m, dist_without_obstacles_single_maneuver);
+        maneuver_traj_succesful = searchTrajectorySingleManeuver(start, center_midway_goal, refpoint_robot_coord_vec, plan_first_m, dist_without_obstacles_single_maneuver);
         dist_without_obstacles = dist_without_obstacles_single_maneuver;
         if (!maneuver_traj_succesful)
             continue;
         
         maneuver_traj_succesful = false;
 //         ROS_INFO("First local trajectory created. Second maneuver reached");   
-        std::vector<geometry_msgs::PoseStamped>::iterator plan_iterator;
-        plan_iterator = plan_first_m.end()-1;
         // Take last pose of previus plan
-        poseStampedMsgToTF(*plan_iterator,temp_start_tf); 
+        size_t last_pose = plan_first_m.size()-1;
+        temp_start = SE2(plan_first_m.x(last_pose), plan_first_m.y(last_pose), plan_first_m.yaw(last_pose));
         
      
-        ROS_INFO("temp_start_tf: %f, %f", temp_start_tf.getOrigin().getX(), temp_start_tf.getOrigin().getY() );
-        
-        temp_goal_tf.setOrigin(goal_tf.getOrigin());
-        temp_goal_tf.setRotation(goal_tf.getRotation());
+        ROS_DEBUG("temp_start: %f, %f", temp_start.x(), temp_start.y() );
         
         plan_second_m.clear();
-        maneuver_traj_succesful = searchTrajectorySingleManeuver(temp_start_tf, temp_goal_tf, refpoint_tf_robot_coord_vec, plan_second_m, dist_without_obstacles_single_maneuver);
+        maneuver_traj_succesful = searchTrajectorySingleManeuver(temp_start, goal, refpoint_robot_coord_vec, plan_second_m, dist_without_obstacles_single_maneuver);
         dist_without_obstacles = dist_without_obstacles + dist_without_obstacles_single_maneuver;
         
 //         ROS_INFO("Second trajectory maneuver_traj_succesful: %d", maneuver_traj_succesful);
 
-        for (plan_iterator = plan_first_m.begin(); plan_iterator != plan_first_m.end(); plan_iterator++)
-        {
-            plan.push_back(*plan_iterator);
-        }
-        for (plan_iterator = plan_second_m.begin(); plan_iterator != plan_second_m.end(); plan_iterator++)
-        {
-            plan.push_back(*plan_iterator);
-        }            
+        plan.append(plan_first_m);
+        plan.append(plan_second_m);
      
         
   }
@@ -663,277 +824,246 @@ bool ManeuverPlanner::searchTrajectoryCompoundLeftRightManeuver(const tf::Stampe
   return maneuver_traj_succesful;
 }
 
-bool ManeuverPlanner::searchTrajectoryOvertakeManeuver(const tf::Stamped<tf::Pose>& start_tf, const tf::Stamped<tf::Pose>& goal_tf, 
-                                                        const tf::Stamped<tf::Pose>& refpoint_tf_robot_coord, std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles)
+/**
+ * Shared state of a parallel overtake search. Midway goals are handed out in priority order,
+ * first_success holds the index of the highest priority successful attempt found so far.
+ */
+struct ManeuverPlanner::OvertakeSearchState
 {
-    tf::Stamped<tf::Pose> temp_goal_tf;
-    tf::Stamped<tf::Pose> temp_start_tf;
-
-    temp_goal_tf.frame_id_ = goal_tf.frame_id_;
-    temp_goal_tf.stamp_ = goal_tf.stamp_;
-
-            
-
-    tf::Stamped<tf::Pose> refpoint_start_tf; // Start Refpoint in the global coordinate frame
-    tf::Stamped<tf::Pose> refpoint_goal_tf; // Goal Refpoint in the global coordinate frame        
-    tf::Stamped<tf::Pose> refpoint_goal_tf_refstart_coord; // Goal Refpoint in the the start position of the reference point coordinate frame
-    
-    double dist_before_steering_refp, dist_after_steering_refp, signed_turning_radius_refp;
-    double unsigned_radius;
-    double dist_before_steering_center, dist_after_steering_center, signed_turning_radius_center;
-    int curve_type;  
-    bool maneuver_traj_succesful = false;
-    double start_yaw, goal_yaw, temp_yaw, temp_pitch, temp_roll;
-    tf::Quaternion temp_quat;
-    tf::Vector3 temp_vector3;
-    start_tf.getBasis().getEulerYPR(start_yaw, temp_pitch, temp_roll);     
-    
-    goal_tf.getBasis().getEulerYPR(goal_yaw, temp_pitch, temp_roll);     
-    
-    //start_yaw = goal_yaw; // With this we just compute the intermediate point with same angle as the goal_yaw. This works better in corridors.
-
+    const SE2* start;
+    const SE2* goal;
+    const SE2* refpoint_robot_coord;
+    std::vector<ManeuverPlanner::OvertakeAttempt>* attempts;
+    
+    boost::mutex mutex;
+    size_t next_attempt;            // Attempts before it were handed out
+    boost::atomic<size_t> first_success;
+};
 
+void ManeuverPlanner::enumerateOvertakeAttempts(const SE2& start, const SE2& goal, const SE2& refpoint_robot_coord, std::vector<OvertakeAttempt>& attempts)
+{
+    StageTimer timer(statistics_ ? &statistics_->generation_time : NULL);
     // Compute reference start and reference goal on global coordinates
-    refpoint_start_tf.frame_id_ = goal_tf.frame_id_;
-    refpoint_start_tf.stamp_ = goal_tf.stamp_;
-    rotate2D(refpoint_tf_robot_coord,start_yaw,refpoint_start_tf);
-    translate2D(refpoint_start_tf,start_tf.getOrigin(),refpoint_start_tf);
-
-    refpoint_goal_tf.frame_id_ = goal_tf.frame_id_;
-    refpoint_goal_tf.stamp_ = goal_tf.stamp_;
-    rotate2D(refpoint_tf_robot_coord,goal_yaw,refpoint_goal_tf);
-    translate2D(refpoint_goal_tf,goal_tf.getOrigin(),refpoint_goal_tf);
-
+    SE2 refpoint_start = start*refpoint_robot_coord;            // Start Refpoint in the global coordinate frame
+    SE2 refpoint_goal = goal*refpoint_robot_coord;              // Goal Refpoint in the global coordinate frame
     // Then Compute reference goal on reference start coordinates
-    refpoint_goal_tf_refstart_coord.frame_id_ = "/refpoint_start_pos";
-    refpoint_goal_tf_refstart_coord.stamp_ = goal_tf.stamp_;
-
-    translate2D(refpoint_goal_tf,-refpoint_start_tf.getOrigin(),refpoint_goal_tf_refstart_coord);
-    refpoint_start_tf.getBasis().getEulerYPR(temp_yaw, temp_pitch, temp_roll);
-    rotate2D(refpoint_goal_tf_refstart_coord,-temp_yaw,refpoint_goal_tf_refstart_coord);    
-    
-   
-    tf::Stamped<tf::Pose> refpoint_midway_goal_tf_refstart_coord; // Midway Goal Refpoint in the the start position of the reference point coordinate frame
-    tf::Stamped<tf::Pose> center_midway_goal_tf; // center of rotation of "ideal" midway goal in global coordinate frame
-    std::vector< tf::Stamped<tf::Pose> > refpoint_tf_robot_coord_vec;
-    
-    // the minimiun angle for theta midway is the angle of the 
-    double refp_theta_min;
-    double refp_theta_max;
-
-
-
-    std::vector<geometry_msgs::PoseStamped> plan_first_m;
-    std::vector<geometry_msgs::PoseStamped> plan_second_m;
-    std::vector<geometry_msgs::PoseStamped> plan_internal;
+    SE2 refpoint_goal_refstart_coord = refpoint_start.inverse()*refpoint_goal;
     
-    std::vector<geometry_msgs::PoseStamped> plan_first_m_final;
-    std::vector<geometry_msgs::PoseStamped> plan_second_m_final;
-    
-    std::vector<geometry_msgs::PoseStamped>::iterator plan_iterator;
-    double dist_to_goal_final = 1000.0; // TODO: Use infinite instead of a large number
-
+    SE2 refpoint_midway_goal_refstart_coord; // Midway Goal Refpoint in the the start position of the reference point coordinate frame
+    SE2 center_midway_goal; // center of rotation of "ideal" midway goal in global coordinate frame
     double midway_side_ovt;
-        
-
-
     
-   for (int iside = 0; iside<2; iside++)
-   {
-
-            
-//     midway_side_ovt_search_.resetLinearSearch(midway_side_ovt_search_.lin_search_min_, midway_side_ovt_search_.lin_search_max_);
-//         while( midway_side_ovt_search_.linearSearch(midway_side_ovt) & !maneuver_traj_succesful){      
+    // Local copy of the generator, so concurrent searches do not share its state
+    parameter_generator::ParameterGenerator midway_side_ovt_search = midway_side_ovt_search_;
+    
+    attempts.clear();
+    for (int iside = 0; iside<2; iside++)
+    {
+//         midway_side_ovt_search.resetLinearSearch(midway_side_ovt_search_.lin_search_min_, midway_side_ovt_search_.lin_search_max_);
+//         while( midway_side_ovt_search.linearSearch(midway_side_ovt) ){      
             
-       midway_side_ovt_search_.resetMidSearch(midway_side_ovt_search_.lin_search_min_, midway_side_ovt_search_.lin_search_max_);       
-        while( midway_side_ovt_search_.midSearch(midway_side_ovt) & !maneuver_traj_succesful){               
+        midway_side_ovt_search.resetMidSearch(midway_side_ovt_search_.lin_search_min_, midway_side_ovt_search_.lin_search_max_);       
+        while( midway_side_ovt_search.midSearch(midway_side_ovt) )
+        {
             if(iside==1) // try to overtake on the right. Useful to come back to lane
                 midway_side_ovt = -1*midway_side_ovt;
                 
-        // refpoint_goal_tf_refstart_coord.getOrigin().getX()*0.5
-        temp_vector3 = tf::Vector3( refpoint_goal_tf_refstart_coord.getOrigin().getX()*0.3 + refpoint_tf_robot_coord.getOrigin().getX(), midway_side_ovt + refpoint_goal_tf_refstart_coord.getOrigin().getY(), 0.0);    
-        refpoint_goal_tf_refstart_coord.getBasis().getEulerYPR(temp_yaw,temp_pitch,temp_roll);                
-        temp_quat.setRPY(0.0, 0.0, temp_yaw); 
-        
-        refpoint_midway_goal_tf_refstart_coord.setOrigin(temp_vector3);
-        refpoint_midway_goal_tf_refstart_coord.setRotation(temp_quat);        
+            // refpoint_goal_refstart_coord.x()*0.5
+            refpoint_midway_goal_refstart_coord = SE2(refpoint_goal_refstart_coord.x()*0.3 + refpoint_robot_coord.x(), midway_side_ovt + refpoint_goal_refstart_coord.y(), 
+                                                      refpoint_goal_refstart_coord.theta());
 
-//         ROS_INFO("refpoint_midway_goal_loc: %f, %f, %f", refpoint_midway_goal_tf_refstart_coord.getOrigin().getX(), refpoint_midway_goal_tf_refstart_coord.getOrigin().getY(), theta_refp_goal);
-        
-        // Convert back to global coordinates
-        temp_quat.setRPY(0.0, 0.0, 0.0); 
-        center_midway_goal_tf.setOrigin(-refpoint_tf_robot_coord.getOrigin());
-        center_midway_goal_tf.setRotation(temp_quat);
-//         rotate2D(center_midway_goal_tf,theta_refp_goal,center_midway_goal_tf); 
-        translate2D(center_midway_goal_tf,refpoint_midway_goal_tf_refstart_coord.getOrigin(),center_midway_goal_tf);        
-        
-        translate2D(center_midway_goal_tf,refpoint_tf_robot_coord.getOrigin(),center_midway_goal_tf);        
-        rotate2D(center_midway_goal_tf,start_yaw,center_midway_goal_tf); 
-        translate2D(center_midway_goal_tf,start_tf.getOrigin(),center_midway_goal_tf);
-        temp_quat.setRPY(0.0, 0.0, goal_yaw); // force rotation to be same as goal. TODO: check transformations!
-        center_midway_goal_tf.setRotation(temp_quat); 
-                
-        temp_start_tf = start_tf;
-        temp_goal_tf.setOrigin(center_midway_goal_tf.getOrigin()); 
-        temp_goal_tf.setRotation(center_midway_goal_tf.getRotation()); 
-        
-        
-        // For the first part We try to search a single maneuver, if not possible then go to a double maneuver.
-        // This is particularly useful when tehre is a replan during teh first phase
-        refpoint_tf_robot_coord_vec.push_back(refpoint_tf_robot_coord);
-        double dist_without_obstacles_single_maneuver;    
-        plan_first_m.clear();
-        maneuver_traj_succesful = searchTrajectorySingleManeuver(temp_start_tf, temp_goal_tf, refpoint_tf_robot_coord_vec, plan_first_m, dist_without_obstacles_single_maneuver);
-        if (!maneuver_traj_succesful)
-            maneuver_traj_succesful = searchTrajectoryLeftRightManeuver(temp_start_tf, temp_goal_tf, refpoint_tf_robot_coord, plan_first_m, dist_without_obstacles_single_maneuver);
-        
-        dist_without_obstacles = dist_without_obstacles_single_maneuver;
-        
-        Eigen::Vector2d goalPoint;
-        Eigen::Vector2d endPlanPoint;
-        tf::Stamped<tf::Pose> temp_endplan_tf;
-        double dist_to_goal;
+//             ROS_INFO("refpoint_midway_goal_loc: %f, %f, %f", refpoint_midway_goal_refstart_coord.x(), refpoint_midway_goal_refstart_coord.y(), theta_refp_goal);
+            
+            // Convert back to global coordinates
+            center_midway_goal = refpoint_start*SE2(refpoint_midway_goal_refstart_coord.x() - refpoint_robot_coord.x(), 
+                                                    refpoint_midway_goal_refstart_coord.y() - refpoint_robot_coord.y(), 0.0);
+            center_midway_goal.setTheta(goal.theta()); // force rotation to be same as goal. TODO: check transformations!
+            
+            attempts.push_back(OvertakeAttempt());
+            attempts.back().center_midway_goal = center_midway_goal;
+        }
+    }
+}
+
+bool ManeuverPlanner::checkOvertakeAttempt(const SE2& start, const SE2& goal, const SE2& refpoint_robot_coord, OvertakeAttempt& attempt,
+                                           const boost::atomic<size_t>* first_success_index, size_t attempt_index)
+{
+    if( statistics_ )
+        statistics_->midway_candidates.fetch_add(1, boost::memory_order_relaxed);
+    std::vector<SE2> refpoint_robot_coord_vec;
+    refpoint_robot_coord_vec.push_back(refpoint_robot_coord);
+    
+    attempt.succesful = false;
+    attempt.second_m_evaluated = false;
+    attempt.plan_first_m.clear();
+    attempt.plan_second_m.clear();
+    
+    // For the first part We try to search a single maneuver, if not possible then go to a double maneuver.
+    // This is particularly useful when tehre is a replan during teh first phase
+    double dist_without_obstacles_single_maneuver = 0.0;
+    bool maneuver_traj_succesful = searchTrajectorySingleManeuver(start, attempt.center_midway_goal, refpoint_robot_coord_vec, attempt.plan_first_m, dist_without_obstacles_single_maneuver);
+    if (!maneuver_traj_succesful)
+    {
+        if( first_success_index != NULL && first_success_index->load() < attempt_index )
+            return false;   // An attempt with higher priority already succeeded, this one will not be used
+        maneuver_traj_succesful = searchTrajectoryLeftRightManeuver(start, attempt.center_midway_goal, refpoint_robot_coord, attempt.plan_first_m, dist_without_obstacles_single_maneuver);
+    }
+    
+    attempt.dist_without_obstacles = dist_without_obstacles_single_maneuver;
+    if (!maneuver_traj_succesful)
+        return false;
+    if( first_success_index != NULL && first_success_index->load() < attempt_index )
+        return false;
+    
+//     ROS_INFO("First local trajectory created. Second maneuver reached");          
+    // Take last pose of previus plan
+    // force rotation to be same as goal. TODO:This creates a discontinuity. Do this in a proper way by continuing the previous maneuver
+    size_t last_pose = attempt.plan_first_m.size()-1;
+    SE2 temp_start = SE2(attempt.plan_first_m.x(last_pose), attempt.plan_first_m.y(last_pose), goal.theta());
+    
+    attempt.succesful = searchTrajectoryLeftRightManeuver(temp_start, goal, refpoint_robot_coord, attempt.plan_second_m, attempt.dist_without_obstacles);
+    attempt.dist_without_obstacles = attempt.dist_without_obstacles + dist_without_obstacles_single_maneuver;
+    attempt.second_m_evaluated = true;
+//     ROS_INFO("Second trajectory maneuver_traj_succesful: %d", maneuver_traj_succesful);
+    return attempt.succesful;
+}
+
+void ManeuverPlanner::evaluateOvertakeAttempts(OvertakeSearchState* state)
+{
+    std::vector<OvertakeAttempt>& attempts = *state->attempts;
+    size_t iattempt;
+    
+    while(true)
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(state->mutex);
+            // Like the candidates, the deadline is only checked between attempts
+            if( deadlinePassed() )
+                break;
+            iattempt = state->next_attempt++;
+        }
+        // Attempts are handed out in order, so once past a successful one nothing else can be used
+        if( iattempt >= attempts.size() || iattempt > state->first_success.load() )
+            break;
+        
+        if( !checkOvertakeAttempt(*state->start, *state->goal, *state->refpoint_robot_coord, attempts[iattempt], &state->first_success, iattempt) )
+            continue;
         
-        if( plan_first_m.size() > 1 )
+        boost::unique_lock<boost::mutex> lock(state->mutex);
+        if( iattempt < state->first_success.load() )
+            state->first_success.store(iattempt);
+    }
+}
+
+bool ManeuverPlanner::searchTrajectoryOvertakeManeuver(const SE2& start, const SE2& goal, 
+                                                        const SE2& refpoint_robot_coord, base_local_planner::CompactPlan& plan, double & dist_without_obstacles)
+{
+    //start_yaw = goal_yaw; // With this we just compute the intermediate point with same angle as the goal_yaw. This works better in corridors.
+
+    // Midway goals in priority order: first overtaking on the left, then on the right
+    std::vector<OvertakeAttempt> attempts;
+    enumerateOvertakeAttempts(start, goal, refpoint_robot_coord, attempts);
+    
+    // Number of attempts the sequential search checks: up to the first successful one, or until the deadline
+    size_t attempts_end = 0;
+    if( !parallel_candidate_evaluation_ )
+    {
+        while( attempts_end < attempts.size() && !deadlinePassed() )
         {
-            goalPoint[0] = goal_tf.getOrigin().getX();
-            goalPoint[1] = goal_tf.getOrigin().getY();
-                        
-            plan_iterator = plan_first_m.end()-1;
-            poseStampedMsgToTF(*plan_iterator,temp_endplan_tf); 
-            endPlanPoint[0] = temp_endplan_tf.getOrigin().getX();
-            endPlanPoint[1] = temp_endplan_tf.getOrigin().getY();
+            if( checkOvertakeAttempt(start, goal, refpoint_robot_coord, attempts[attempts_end++]) )
+                break;
+        }
+    }
+    else
+    {   // Both sides and all their midway goals are checked concurrently, the candidates of every attempt on the same thread
+        OvertakeSearchState state;
+        state.start = &start;
+        state.goal = &goal;
+        state.refpoint_robot_coord = &refpoint_robot_coord;
+        state.attempts = &attempts;
+        state.next_attempt = 0;
+        state.first_success.store(attempts.size());
+        
+        worker_pool_->run(boost::bind(&ManeuverPlanner::evaluateOvertakeAttempts, this, &state));
+        
+        if( state.first_success.load() < attempts.size() )
+            attempts_end = state.first_success.load() + 1;
+        else
+            attempts_end = std::min(state.next_attempt, attempts.size());
+    }
+    
+    // Keep the plan that ends closest to the goal, in the order the attempts are made
+    Eigen::Vector2d goalPoint;
+    Eigen::Vector2d endPlanPoint;
+    double dist_to_goal;
+    double dist_to_goal_final = 1000.0; // TODO: Use infinite instead of a large number
+    const OvertakeAttempt* first_m_final = NULL;
+    const OvertakeAttempt* second_m_final = NULL;
+    goalPoint[0] = goal.x();
+    goalPoint[1] = goal.y();
+    
+    for (size_t iattempt = 0; iattempt < attempts_end; iattempt++)
+    {
+        const OvertakeAttempt& attempt = attempts[iattempt];
+        dist_without_obstacles = attempt.dist_without_obstacles;
+        
+        if( attempt.plan_first_m.size() > 1 )
+        {
+            endPlanPoint[0] = attempt.plan_first_m.x(attempt.plan_first_m.size()-1);
+            endPlanPoint[1] = attempt.plan_first_m.y(attempt.plan_first_m.size()-1);
             
             dist_to_goal = hypot(goalPoint[1]-endPlanPoint[1],goalPoint[0]-endPlanPoint[0]);
             
             if( dist_to_goal < dist_to_goal_final )
             { // Update plan
-                plan_first_m_final.clear();
-                for (plan_iterator = plan_first_m.begin(); plan_iterator != plan_first_m.end(); plan_iterator++)
-                {
-                    plan_first_m_final.push_back(*plan_iterator);
-                }    
+                first_m_final = &attempt;
                 dist_to_goal_final = dist_to_goal;
             }
         }
-        if (!maneuver_traj_succesful)
-            continue;
         
-        
-        
-        maneuver_traj_succesful = false;
-    //         ROS_INFO("First local trajectory created. Second maneuver reached");          
-        plan_iterator = plan_first_m.end()-1;
-        // Take last pose of previus plan
-        poseStampedMsgToTF(*plan_iterator,temp_start_tf); 
-        
-        temp_quat.setRPY(0.0, 0.0, goal_yaw); // force rotation to be same as goal. TODO:This creates a discontinuity. Do this in a proper way by continuing the previous maneuver
-        temp_start_tf.setRotation(temp_quat); 
-
-        
-        temp_goal_tf.setOrigin(goal_tf.getOrigin());
-        temp_goal_tf.setRotation(goal_tf.getRotation());
-        
-        
-        plan_second_m.clear();
-        maneuver_traj_succesful = searchTrajectoryLeftRightManeuver(temp_start_tf, temp_goal_tf, refpoint_tf_robot_coord, plan_second_m, dist_without_obstacles);
-        dist_without_obstacles = dist_without_obstacles + dist_without_obstacles_single_maneuver;
-    //         ROS_INFO("Second trajectory maneuver_traj_succesful: %d", maneuver_traj_succesful);
-        
-        
-        if( plan_second_m.size() > 1 )
+        if( attempt.second_m_evaluated && attempt.plan_second_m.size() > 1 )
         {        
-            plan_iterator = plan_second_m.end()-1;
-            poseStampedMsgToTF(*plan_iterator,temp_endplan_tf); 
-            endPlanPoint[0] = temp_endplan_tf.getOrigin().getX();
-            endPlanPoint[1] = temp_endplan_tf.getOrigin().getY();
+            endPlanPoint[0] = attempt.plan_second_m.x(attempt.plan_second_m.size()-1);
+            endPlanPoint[1] = attempt.plan_second_m.y(attempt.plan_second_m.size()-1);
             
             dist_to_goal =  hypot(goalPoint[1]-endPlanPoint[1],goalPoint[0]-endPlanPoint[0]);
             
-            
             if( dist_to_goal < dist_to_goal_final )
             { // Update plan
                 dist_to_goal_final = dist_to_goal;
-                plan_first_m_final.clear();
-                plan_second_m_final.clear();
-                for (plan_iterator = plan_first_m.begin(); plan_iterator != plan_first_m.end(); plan_iterator++)
-                {
-                    plan_first_m_final.push_back(*plan_iterator);
-                }    
-                for (plan_iterator = plan_second_m.begin(); plan_iterator != plan_second_m.end(); plan_iterator++)
-                {
-                    plan_second_m_final.push_back(*plan_iterator);
-                }                                      
+                first_m_final = &attempt;
+                second_m_final = &attempt;
             }
         }
-        
-        
     }
-    if(maneuver_traj_succesful)
-        break;
-   }
   
-
-    for (plan_iterator = plan_first_m_final.begin(); plan_iterator != plan_first_m_final.end(); plan_iterator++)
-    {
-        plan.push_back(*plan_iterator);
-    }
-    for (plan_iterator = plan_second_m_final.begin(); plan_iterator != plan_second_m_final.end(); plan_iterator++)
-    {
-        plan.push_back(*plan_iterator);
-    }            
-
+    if( first_m_final != NULL )
+        plan.append(first_m_final->plan_first_m);
+    if( second_m_final != NULL )
+        plan.append(second_m_final->plan_second_m);
   
 //   ROS_INFO("Total trajectory created. Check trajectory, free: %d", (int) maneuver_traj_succesful);
-  return maneuver_traj_succesful;
+    return attempts_end > 0 && attempts[attempts_end-1].succesful;
 }
 
 
 
-bool ManeuverPlanner::searchTrajectoryLeftRightManeuver(const tf::Stamped<tf::Pose>& start_tf, const tf::Stamped<tf::Pose>& goal_tf, 
-                                                        const tf::Stamped<tf::Pose>& refpoint_tf_robot_coord, std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles)
+bool ManeuverPlanner::searchTrajectoryLeftRightManeuver(const SE2& start, const SE2& goal, 
+                                                        const SE2& refpoint_robot_coord, base_local_planner::CompactPlan& plan, double & dist_without_obstacles)
 {
-    tf::Stamped<tf::Pose> midway_goal_tf;
-    midway_goal_tf.frame_id_    = goal_tf.frame_id_;
-    midway_goal_tf.stamp_       = goal_tf.stamp_;
-            
-    
-    tf::Stamped<tf::Pose> refpoint_start_tf; // Start Refpoint in the global coordinate frame
-    tf::Stamped<tf::Pose> refpoint_goal_tf; // Goal Refpoint in the global coordinate frame        
-    tf::Stamped<tf::Pose> refpoint_goal_tf_refstart_coord; // Goal Refpoint in the the start position of the reference point coordinate frame
-    tf::Stamped<tf::Pose> refpoint_goal_tf_refmidway_coord; // Goal Refpoint in the the midway position of the reference point coordinate frame. Used in second maneuver
     double dist_before_steering_refp, dist_after_steering_refp, signed_turning_radius_refp;
     double unsigned_radius;
-    double dist_before_steering_center, dist_after_steering_center, signed_turning_radius_center;
     int curve_type;  
     bool maneuver_traj_succesful = false;
-    double start_yaw, goal_yaw, temp_yaw, temp_pitch, temp_roll;
-    tf::Quaternion temp_quat;
-    tf::Vector3 temp_vector3;
-    start_tf.getBasis().getEulerYPR(start_yaw, temp_pitch, temp_roll);             
-    goal_tf.getBasis().getEulerYPR(goal_yaw, temp_pitch, temp_roll);             
-    
    
     // Compute reference start and goal on global coordinates
-    refpoint_start_tf.frame_id_ = goal_tf.frame_id_;
-    refpoint_start_tf.stamp_ = goal_tf.stamp_;
-    rotate2D(refpoint_tf_robot_coord,start_yaw,refpoint_start_tf);
-    translate2D(refpoint_start_tf,start_tf.getOrigin(),refpoint_start_tf);
-
-    refpoint_goal_tf.frame_id_ = goal_tf.frame_id_;
-    refpoint_goal_tf.stamp_ = goal_tf.stamp_;
-    rotate2D(refpoint_tf_robot_coord,goal_yaw,refpoint_goal_tf);
-    translate2D(refpoint_goal_tf,goal_tf.getOrigin(),refpoint_goal_tf);
-
-    // Then Compute reference start and goal on reference start coordinates
-    refpoint_goal_tf_refstart_coord.frame_id_ = "/refpoint_start_pos";
-    refpoint_goal_tf_refstart_coord.stamp_ = goal_tf.stamp_;
-
-    translate2D(refpoint_goal_tf,-refpoint_start_tf.getOrigin(),refpoint_goal_tf_refstart_coord);
-    refpoint_start_tf.getBasis().getEulerYPR(temp_yaw, temp_pitch, temp_roll);
-    rotate2D(refpoint_goal_tf_refstart_coord,-temp_yaw,refpoint_goal_tf_refstart_coord);    
+    SE2 refpoint_start = start*refpoint_robot_coord;            // Start Refpoint in the global coordinate frame
+    SE2 refpoint_goal = goal*refpoint_robot_coord;              // Goal Refpoint in the global coordinate frame
+    // Then Compute reference goal on reference start coordinates
+    SE2 refpoint_goal_refstart_coord = refpoint_start.inverse()*refpoint_goal;
+    SE2 refpoint_goal_refmidway_coord; // Goal Refpoint in the the midway position of the reference point coordinate frame. Used in second maneuver
     
-    tf::Stamped<tf::Pose> refpoint_midway_goal_tf_refstart_coord; // Midway Goal Refpoint in the the start position of the reference point coordinate frame
+    SE2 refpoint_midway_goal_refstart_coord; // Midway Goal Refpoint in the the start position of the reference point coordinate frame
     // the minimiun angle for theta midway is the angle of the 
     double refp_theta_min;
     double refp_theta_max;
@@ -942,55 +1072,84 @@ bool ManeuverPlanner::searchTrajectoryLeftRightManeuver(const tf::Stamped<tf::Po
     double signed_max_turning_radius_refp;    // Maximum steering radius using the eference point
     double xlocal_intersection_refp;          // Intersection of target in local x coodinates using the reference point    
     int maneuver_type_refp;
-    std::vector<tf::Pose> local_plan_refp;    
-    std::vector<tf::Pose> local_plan_refp_first_m;
-    std::vector<tf::Pose> local_plan_refp_second_m;
-    
+    DublinSegment first_m_segment, second_m_segment;
+    CenterTrajectoryState center_state_first_m, center_state;
+    std::vector<Eigen::Vector3d> center_traj;   // Center poses (x, y, yaw) in the global frame
+    size_t first_m_traj_size = 0;
+    bool traj_evaluated = false;
+    bool second_m_evaluated_last = false;
+    // The feedback of the golden-section search needs the distance to the first collision, so then every pose is checked in order
+    const bool feedback_search = radius_search_.getStrategy() == parameter_generator::ParameterGenerator::GOLDEN_SECTION_SEARCH;
+    const bool coarse_to_fine = coarse_check_stride_ > 1 && !feedback_search;
+
     double midway_scale_lr;
+    double midway_progress;     // Feedback of a midway goal: the first maneuver counts for one half, the second for the other
     
-    midway_scale_lr_search_.resetMidSearch(midway_scale_lr_search_.lin_search_min_, midway_scale_lr_search_.lin_search_max_);
+    // Local copies of the generators, so concurrent searches do not share their state
+    parameter_generator::ParameterGenerator midway_scale_lr_search = midway_scale_lr_search_;
+    parameter_generator::ParameterGenerator radius_search = radius_search_;
+    midway_scale_lr_search.resetSearch(midway_scale_lr_search_.lin_search_min_, midway_scale_lr_search_.lin_search_max_);
     
-    while( midway_scale_lr_search_.midSearch(midway_scale_lr) & !maneuver_traj_succesful){ 
+    while( midway_scale_lr_search.search(midway_scale_lr) & !maneuver_traj_succesful){ 
 //         ROS_INFO("Search midway scale: %f", midway_scale_lr);
+        if( deadlinePassed() )
+            break;
+        if( statistics_ )
+            statistics_->midway_candidates.fetch_add(1, boost::memory_order_relaxed);
+        midway_progress = 0.0;
                
     
-        temp_vector3 = tf::Vector3( midway_scale_lr*refpoint_goal_tf_refstart_coord.getOrigin().getX(), refpoint_goal_tf_refstart_coord.getOrigin().getY()/2.0, 0.0);    
-        refpoint_midway_goal_tf_refstart_coord.setOrigin(temp_vector3);
-        refp_theta_min = std::atan2(refpoint_midway_goal_tf_refstart_coord.getOrigin().getY(), refpoint_midway_goal_tf_refstart_coord.getOrigin().getX());    
+        refpoint_midway_goal_refstart_coord.setOrigin(midway_scale_lr*refpoint_goal_refstart_coord.x(), refpoint_goal_refstart_coord.y()/2.0);
+        refp_theta_min = std::atan2(refpoint_midway_goal_refstart_coord.y(), refpoint_midway_goal_refstart_coord.x());    
         if( refp_theta_min > 0)   // Left right
             refp_theta_max = M_PI/2.0;
         else // Right left
             refp_theta_max = -M_PI/2.0;
         
         theta_refp_goal = angles::normalize_angle(refp_theta_min + 0.5*(refp_theta_max-refp_theta_min)  ); // Final angle of mid goal // For now set a fix value. We can do also a search on this parameter_generator 
-        temp_quat.setRPY(0.0, 0.0, theta_refp_goal); 
-        refpoint_midway_goal_tf_refstart_coord.setRotation(temp_quat);
+        refpoint_midway_goal_refstart_coord.setTheta(theta_refp_goal);
         
-//         ROS_INFO("refpoint_midway_goal_tf_refstart_coord %f, %f", refpoint_midway_goal_tf_refstart_coord.getOrigin().getX(), refpoint_midway_goal_tf_refstart_coord.getOrigin().getY());
+//         ROS_INFO("refpoint_midway_goal_refstart_coord %f, %f", refpoint_midway_goal_refstart_coord.x(), refpoint_midway_goal_refstart_coord.y());
             
     //     ROS_INFO("First maneuver reached");
         // First maneuver    
-        maneuver_type_refp = determineManeuverType(refpoint_midway_goal_tf_refstart_coord,  signed_max_turning_radius_refp, xlocal_intersection_refp);            
+        maneuver_type_refp = determineManeuverType(refpoint_midway_goal_refstart_coord,  signed_max_turning_radius_refp, xlocal_intersection_refp);            
         if (maneuver_type_refp == ManeuverPlanner::MANEUVER_LEFT || maneuver_type_refp == ManeuverPlanner::MANEUVER_RIGHT)
         {   // This only supports single maneuvers    
         
-            radius_search_.resetMidSearch(radius_search_.lin_search_min_, std::abs(signed_max_turning_radius_refp));
-            while( radius_search_.midSearch(unsigned_radius) & !maneuver_traj_succesful)
+            radius_search.resetSearch(radius_search_.lin_search_min_, std::abs(signed_max_turning_radius_refp));
+            while( radius_search.search(unsigned_radius) & !maneuver_traj_succesful)
             {           
+                if( deadlinePassed() )
+                    break;
                 if(signed_max_turning_radius_refp > 0.0)
                     signed_turning_radius_refp = unsigned_radius;
                 else
                     signed_turning_radius_refp = -unsigned_radius;
                                     
     //             ROS_INFO(" signed_turning_radius_first_maneuver: %.3f", signed_turning_radius_refp);
-                curve_type = computeSingleManeuverParameters(refpoint_midway_goal_tf_refstart_coord, signed_turning_radius_refp,  xlocal_intersection_refp, dist_before_steering_refp, dist_after_steering_refp);
+                curve_type = computeSingleManeuverParameters(refpoint_midway_goal_refstart_coord, signed_turning_radius_refp,  xlocal_intersection_refp, dist_before_steering_refp, dist_after_steering_refp);
 //                 ROS_INFO("Curve parameters: %.3f / %.3f / %.3f",dist_before_steering_refp, dist_after_steering_refp, signed_turning_radius_refp);             
                 if( curve_type!= ManeuverPlanner::CURVE_NONE ) // curve possible, generate
                 {
-                    generateDublinTrajectory(dist_before_steering_refp, dist_after_steering_refp, signed_turning_radius_refp, theta_refp_goal, local_plan_refp_first_m);  
-                    plan.clear();
-                    maneuver_traj_succesful = checkFootprintTransformLocalToGlobal(start_tf, goal_tf, refpoint_tf_robot_coord, local_plan_refp_first_m, plan, dist_without_obstacles); // here goal_tf is only  
-                }                
+                    if( statistics_ )
+                        statistics_->radius_candidates.fetch_add(1, boost::memory_order_relaxed);
+                    first_m_segment.dist_before_steering = dist_before_steering_refp;
+                    first_m_segment.dist_after_steering = dist_after_steering_refp;
+                    first_m_segment.signed_turning_radius = signed_turning_radius_refp;
+                    first_m_segment.theta_goal = theta_refp_goal;
+                    center_traj.clear();
+                    initCenterTrajectory(refpoint_robot_coord, center_state_first_m);
+                    maneuver_traj_succesful = checkDublinSegment(start, refpoint_robot_coord, first_m_segment, center_state_first_m, center_traj, coarse_to_fine);
+                    dist_without_obstacles = center_state_first_m.total_ahead_distance;
+                    first_m_traj_size = center_traj.size();
+                    traj_evaluated = true;
+                    second_m_evaluated_last = false;
+                    
+                    radius_search.setFeedback(first_m_segment.completedFraction(center_state_first_m.total_ahead_distance));
+                    midway_progress = std::max(midway_progress, 0.5*first_m_segment.completedFraction(center_state_first_m.total_ahead_distance));
+                    midway_scale_lr_search.setFeedback(midway_progress);
+                }
             }                                
         } 
 
@@ -1001,64 +1160,76 @@ bool ManeuverPlanner::searchTrajectoryLeftRightManeuver(const tf::Stamped<tf::Po
         maneuver_traj_succesful = false;
 //         ROS_INFO("First local trajectory created. Second maneuver reached");   
         
-        refpoint_goal_tf_refmidway_coord = refpoint_goal_tf_refstart_coord;
-        translate2D(refpoint_goal_tf_refmidway_coord,-refpoint_midway_goal_tf_refstart_coord.getOrigin(),refpoint_goal_tf_refmidway_coord);
-        refpoint_midway_goal_tf_refstart_coord.getBasis().getEulerYPR(temp_yaw, temp_pitch, temp_roll);
-        rotate2D(refpoint_goal_tf_refmidway_coord,-temp_yaw,refpoint_goal_tf_refmidway_coord); 
-        
-        refpoint_goal_tf_refmidway_coord.getBasis().getEulerYPR(theta_refp_goal,temp_pitch,temp_roll);        
-        maneuver_type_refp = determineManeuverType(refpoint_goal_tf_refmidway_coord,  signed_max_turning_radius_refp, xlocal_intersection_refp);            
+        refpoint_goal_refmidway_coord = refpoint_midway_goal_refstart_coord.inverse()*refpoint_goal_refstart_coord;
+        theta_refp_goal = refpoint_goal_refmidway_coord.theta();
+        maneuver_type_refp = determineManeuverType(refpoint_goal_refmidway_coord,  signed_max_turning_radius_refp, xlocal_intersection_refp);
         if (maneuver_type_refp == ManeuverPlanner::MANEUVER_LEFT || maneuver_type_refp == ManeuverPlanner::MANEUVER_RIGHT)
-        {   // This only supports single maneuvers    
-                
-            
-            radius_search_.resetMidSearch(radius_search_.lin_search_min_, std::abs(signed_max_turning_radius_refp));
-            while( radius_search_.midSearch(unsigned_radius) & !maneuver_traj_succesful)
-            {      
+        {   // This only supports single maneuvers
+
+
+            radius_search.resetSearch(radius_search_.lin_search_min_, std::abs(signed_max_turning_radius_refp));
+            while( radius_search.search(unsigned_radius) & !maneuver_traj_succesful)
+            {
+                if( deadlinePassed() )
+                    break;
                 if(signed_max_turning_radius_refp > 0.0)
                     signed_turning_radius_refp = unsigned_radius;
                 else
                     signed_turning_radius_refp = -unsigned_radius;
 //                 ROS_INFO(" signed_turning_radius_second_maneuver: %.3f", signed_turning_radius_refp);
-                curve_type = computeSingleManeuverParameters(refpoint_goal_tf_refmidway_coord, signed_turning_radius_refp,  xlocal_intersection_refp, dist_before_steering_refp, dist_after_steering_refp);
-                // ROS_INFO("Curve parameters: %.3f / %.3f / %.3f",dist_before_steering_refp, dist_after_steering_refp, signed_turning_radius_refp);             
+                curve_type = computeSingleManeuverParameters(refpoint_goal_refmidway_coord, signed_turning_radius_refp,  xlocal_intersection_refp, dist_before_steering_refp, dist_after_steering_refp);
+                // ROS_INFO("Curve parameters: %.3f / %.3f / %.3f",dist_before_steering_refp, dist_after_steering_refp, signed_turning_radius_refp);
                 if( curve_type!= ManeuverPlanner::CURVE_NONE ) // curve possible, generate
                 {
-                    generateDublinTrajectory(dist_before_steering_refp, dist_after_steering_refp, signed_turning_radius_refp, theta_refp_goal, local_plan_refp_second_m);                
-                //     ROS_INFO("Second local trajectory created");
-                    
-                    std::vector<tf::Pose>::iterator plan_iterator;
-                    tf::Pose pose_local_plan;
-                    tf::Stamped<tf::Pose> point_local_plan_refp_second_m_stamped;
-                    
-                    local_plan_refp.clear();
-                    // Add first plan. TODO: This is inefficient implementation. Later make sure rechecks are not done
-                    for (plan_iterator = local_plan_refp_first_m.begin(); plan_iterator != local_plan_refp_first_m.end(); plan_iterator++)
-                    {
-                        local_plan_refp.push_back(*plan_iterator);
-                    }
-                    
-                    for (plan_iterator = local_plan_refp_second_m.begin()+1; plan_iterator != local_plan_refp_second_m.end(); plan_iterator++)
-                    {
-                        point_local_plan_refp_second_m_stamped.setData(*plan_iterator);        
-                        
-                        // transform back from the middle way point 
-                        refpoint_midway_goal_tf_refstart_coord.getBasis().getEulerYPR(temp_yaw, temp_pitch, temp_roll);
-                        rotate2D(point_local_plan_refp_second_m_stamped,+temp_yaw,point_local_plan_refp_second_m_stamped); 
-                        translate2D(point_local_plan_refp_second_m_stamped, refpoint_midway_goal_tf_refstart_coord.getOrigin(), point_local_plan_refp_second_m_stamped);                 
-                        pose_local_plan.setOrigin(point_local_plan_refp_second_m_stamped.getOrigin());
-                        pose_local_plan.setRotation(point_local_plan_refp_second_m_stamped.getRotation());
-                        local_plan_refp.push_back(pose_local_plan);
-                    }
-                
-                    plan.clear();
-                    maneuver_traj_succesful = checkFootprintTransformLocalToGlobal(start_tf, goal_tf, refpoint_tf_robot_coord, local_plan_refp, plan, dist_without_obstacles); // here goal_tf is only                        
+                    if( statistics_ )
+                        statistics_->radius_candidates.fetch_add(1, boost::memory_order_relaxed);
+                    // Second maneuver starts at the midway goal, its first pose is the last one of the first maneuver
+                    second_m_segment.dist_before_steering = dist_before_steering_refp;
+                    second_m_segment.dist_after_steering = dist_after_steering_refp;
+                    second_m_segment.signed_turning_radius = signed_turning_radius_refp;
+                    second_m_segment.theta_goal = theta_refp_goal;
+                    second_m_segment.offset = refpoint_midway_goal_refstart_coord;
+                    second_m_segment.skip_first_pose = true;
+
+                    // The first maneuver is already checked, continue from its end instead of checking it again
+                    center_traj.resize(first_m_traj_size);
+                    center_state = center_state_first_m;
+                    maneuver_traj_succesful = checkDublinSegment(start, refpoint_robot_coord, second_m_segment, center_state, center_traj, coarse_to_fine);
+                    dist_without_obstacles = center_state.total_ahead_distance;
+                    second_m_evaluated_last = true;
                     
+                    double second_m_fraction = second_m_segment.completedFraction(center_state.total_ahead_distance - center_state_first_m.total_ahead_distance);
+                    radius_search.setFeedback(second_m_fraction);
+                    midway_progress = std::max(midway_progress, 0.5 + 0.5*second_m_fraction);
+                    midway_scale_lr_search.setFeedback(midway_progress);
                 }
-            }                                
-        }       
+            }
+        }
+  }
+
+  if( traj_evaluated && !maneuver_traj_succesful && coarse_to_fine )
+  {   // Candidates were only checked for feasibility, trace the last one again up to its first collision
+      if( second_m_evaluated_last )
+      {
+          center_traj.resize(first_m_traj_size);
+          center_state = center_state_first_m;
+          checkDublinSegment(start, refpoint_robot_coord, second_m_segment, center_state, center_traj);
+          dist_without_obstacles = center_state.total_ahead_distance;
+      }
+      else
+      {
+          center_traj.clear();
+          initCenterTrajectory(refpoint_robot_coord, center_state_first_m);
+          checkDublinSegment(start, refpoint_robot_coord, first_m_segment, center_state_first_m, center_traj);
+          dist_without_obstacles = center_state_first_m.total_ahead_distance;
+      }
+  }
+
+  if( traj_evaluated )
+  {
+      plan.clear();
+      materializePlan(center_traj, plan);
   }
-  
 //   ROS_INFO("Total trajectory created. Check trajectory, free: %d", (int) maneuver_traj_succesful);
   return maneuver_traj_succesful;
 
@@ -1066,114 +1237,297 @@ bool ManeuverPlanner::searchTrajectoryLeftRightManeuver(const tf::Stamped<tf::Po
 
 
 
-bool ManeuverPlanner::searchTrajectorySingleManeuver(const tf::Stamped<tf::Pose>& start_tf, 
-                               const tf::Stamped<tf::Pose>& goal_tf, std::vector< tf::Stamped<tf::Pose> >& refpoint_tf_robot_coord_vec, 
-                               std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles)
+/**
+ * Shared state of a parallel candidate evaluation. Candidates are handed out in priority order,
+ * first_success holds the index of the highest priority feasible candidate found so far.
+ */
+struct ManeuverPlanner::CandidateSearchState
 {
-    tf::Stamped<tf::Pose> refpoint_tf_robot_coord;
-    tf::Stamped<tf::Pose> refpoint_start_tf; // Start Refpoint in the global coordinate frame
-    tf::Stamped<tf::Pose> refpoint_goal_tf; // Goal Refpoint in the global coordinate frame        
-    tf::Stamped<tf::Pose> refpoint_goal_tf_refstart_coord; // Goal Refpoint in the the start position of the reference point coordinate frame
-    double dist_before_steering_refp, dist_after_steering_refp, signed_turning_radius_refp;
-    double dist_before_steering_center, dist_after_steering_center, signed_turning_radius_center;
-    int curve_type;  
-    bool maneuver_traj_succesful = false;
-    double start_yaw, goal_yaw, temp_yaw, temp_pitch, temp_roll;    
-    tf::Quaternion temp_quat;
-    tf::Vector3 temp_vector3;
-    start_tf.getBasis().getEulerYPR(start_yaw, temp_pitch, temp_roll);             
-    goal_tf.getBasis().getEulerYPR(goal_yaw, temp_pitch, temp_roll);             
+    const SE2* start;
+    const std::vector<ManeuverPlanner::SingleManeuverCandidate>* candidates;
+    double theta_refp_goal;
     
-    tf::Stamped<tf::Pose> goal_tf_start_coord; // Goal in the start vector coordinates
-    goal_tf_start_coord.frame_id_ = "/center_rotation_start_pos";
+    boost::mutex mutex;
+    size_t next_candidate;          // Candidates before it were handed out
+    boost::atomic<size_t> first_success;
+    
+    std::vector<Eigen::Vector3d> success_traj;
+    double success_dist_without_obstacles;
+};
 
-    translate2D(goal_tf,-start_tf.getOrigin(),goal_tf_start_coord);
-    rotate2D(goal_tf_start_coord,-start_yaw,goal_tf_start_coord);
-    double theta_refp_goal = angles::normalize_angle( goal_yaw - start_yaw ); // Final angle of curvature    
+void ManeuverPlanner::enumerateSingleManeuverCandidates(const SE2& start, const SE2& goal, 
+                               const std::vector<SE2>& refpoint_robot_coord_vec, std::vector<SingleManeuverCandidate>& candidates)
+{
+    StageTimer timer(statistics_ ? &statistics_->generation_time : NULL);
+    SE2 refpoint_goal_refstart_coord; // Goal Refpoint in the the start position of the reference point coordinate frame
     
     double min_radius = radius_search_.lin_search_min_;        
-    double signed_max_turning_radius_center;    // Maximum steering radius using the center of the robot
-    double xlocal_intersection_center;          // Intersection of target in local x coodinates
-    int maneuver_type_center;
-    std::vector<tf::Pose> local_plan_refp;
-    double unsigned_radius;
+    std::vector<double> signed_turning_radii, dist_before_steering, dist_after_steering;
+    std::vector<char> curve_possible;
     double signed_max_turning_radius_refp;    // Maximum steering radius using the eference point
     double xlocal_intersection_refp;          // Intersection of target in local x coodinates using the reference point    
     int maneuver_type_refp;
+    SingleManeuverCandidate candidate;
 
-    std::vector< tf::Stamped<tf::Pose> >::iterator refpoint_tf_robot_coord_it;
+    candidates.clear();
+    std::vector<SE2>::const_iterator refpoint_robot_coord_it;
      
-    for ( refpoint_tf_robot_coord_it = refpoint_tf_robot_coord_vec.begin(); refpoint_tf_robot_coord_it!=refpoint_tf_robot_coord_vec.end(); refpoint_tf_robot_coord_it++)
+    for ( refpoint_robot_coord_it = refpoint_robot_coord_vec.begin(); refpoint_robot_coord_it!=refpoint_robot_coord_vec.end(); refpoint_robot_coord_it++)
     {
-        refpoint_tf_robot_coord = *refpoint_tf_robot_coord_it;
-   
-    
-        // Compute reference start and goal on global coordinates
-        refpoint_start_tf.frame_id_ = goal_tf.frame_id_;
-        refpoint_start_tf.stamp_ = goal_tf.stamp_;
-        rotate2D(refpoint_tf_robot_coord,start_yaw,refpoint_start_tf);
-        translate2D(refpoint_start_tf,start_tf.getOrigin(),refpoint_start_tf);
-
-        refpoint_goal_tf.frame_id_ = goal_tf.frame_id_;
-        refpoint_goal_tf.stamp_ = goal_tf.stamp_;
-        rotate2D(refpoint_tf_robot_coord,goal_yaw,refpoint_goal_tf);
-        translate2D(refpoint_goal_tf,goal_tf.getOrigin(),refpoint_goal_tf);
+        // Compute reference start and goal on global coordinates, then goal on reference start coordinates
+        refpoint_goal_refstart_coord = (start*(*refpoint_robot_coord_it)).inverse()*(goal*(*refpoint_robot_coord_it));
 
-        // Then Compute reference start and goal on reference start coordinates
-        refpoint_goal_tf_refstart_coord.frame_id_ = "/refpoint_start_pos";
-        refpoint_goal_tf_refstart_coord.stamp_ = goal_tf.stamp_;
-
-        translate2D(refpoint_goal_tf,-refpoint_start_tf.getOrigin(),refpoint_goal_tf_refstart_coord);
-        refpoint_start_tf.getBasis().getEulerYPR(temp_yaw, temp_pitch, temp_roll);
-        rotate2D(refpoint_goal_tf_refstart_coord,-temp_yaw,refpoint_goal_tf_refstart_coord);
-
-        maneuver_type_refp = determineManeuverType(refpoint_goal_tf_refstart_coord,  signed_max_turning_radius_refp, xlocal_intersection_refp);        
+        maneuver_type_refp = determineManeuverType(refpoint_goal_refstart_coord,  signed_max_turning_radius_refp, xlocal_intersection_refp);        
                 
         if (maneuver_type_refp == ManeuverPlanner::MANEUVER_LEFT || maneuver_type_refp == ManeuverPlanner::MANEUVER_RIGHT)
         {   // This only supports single maneuvers    
+            if( statistics_ )
+                statistics_->reference_points.fetch_add(1, boost::memory_order_relaxed);
                 
-            radius_search_.resetMidSearch(min_radius, std::abs(signed_max_turning_radius_refp));
-            while( radius_search_.midSearch(unsigned_radius) & !maneuver_traj_succesful)
-            {      
-                if(signed_max_turning_radius_refp > 0.0)
-                    signed_turning_radius_refp = unsigned_radius;
-                else
-                    signed_turning_radius_refp = -unsigned_radius;         
-//                 ROS_INFO(" signed_turning_radius_refp: %.3f", signed_turning_radius_refp);
-                curve_type = computeSingleManeuverParameters(refpoint_goal_tf_refstart_coord, signed_turning_radius_refp,  xlocal_intersection_refp, dist_before_steering_refp, dist_after_steering_refp);
-//                 ROS_INFO("Curve parameters: %.3f / %.3f / %.3f",dist_before_steering_refp, dist_after_steering_refp, signed_turning_radius_refp);             
-                plan.clear();
-                if( curve_type!= ManeuverPlanner::CURVE_NONE ) // curve possible, generate
-                {
-                    generateDublinTrajectory(dist_before_steering_refp, dist_after_steering_refp, signed_turning_radius_refp, theta_refp_goal, local_plan_refp);
-                    maneuver_traj_succesful = checkFootprintTransformLocalToGlobal(start_tf, goal_tf, refpoint_tf_robot_coord, local_plan_refp, plan, dist_without_obstacles);
-                }
-            }                        
+            // The whole radius set of the reference point is generated up front and its parameters computed in one pass
+            radius_search_.searchValues(min_radius, std::abs(signed_max_turning_radius_refp), signed_turning_radii);
+            if( signed_max_turning_radius_refp <= 0.0 )
+            {
+                for (size_t i = 0; i < signed_turning_radii.size(); i++)
+                    signed_turning_radii[i] = -signed_turning_radii[i];
+            }
+            computeSingleManeuverParameters(refpoint_goal_refstart_coord, signed_turning_radii, xlocal_intersection_refp,
+                                            dist_before_steering, dist_after_steering, curve_possible);
             
+            candidate.refpoint_robot_coord = *refpoint_robot_coord_it;
+            for (size_t i = 0; i < signed_turning_radii.size(); i++)
+            {
+                candidate.signed_turning_radius_refp = signed_turning_radii[i];
+                candidate.dist_before_steering_refp = dist_before_steering[i];
+                candidate.dist_after_steering_refp = dist_after_steering[i];
+                candidate.curve_possible = curve_possible[i];
+                candidates.push_back(candidate);
+            }
         }
+    }
+}
 
-
-        if (maneuver_traj_succesful)
+void ManeuverPlanner::evaluateSingleManeuverCandidates(CandidateSearchState* state)
+{
+    const std::vector<SingleManeuverCandidate>& candidates = *state->candidates;
+    std::vector<Eigen::Vector3d> center_traj;
+    CenterTrajectoryState center_state;
+    size_t icand;
+    
+    while(true)
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(state->mutex);
+            // The deadline is only checked between candidates, candidates handed out are always completed
+            if( deadlinePassed() )
+                break;
+            icand = state->next_candidate++;
+        }
+        // Candidates are handed out in order, so once past a feasible one nothing else can be used
+        if( icand >= candidates.size() || icand > state->first_success.load() )
             break;
+        if( !candidates[icand].curve_possible )
+            continue;
+        
+        if( statistics_ )
+            statistics_->radius_candidates.fetch_add(1, boost::memory_order_relaxed);
+        // Only feasibility matters here, a failed search is traced again afterwards
+        bool traj_free = checkSingleManeuverCandidate(*state->start, candidates[icand], state->theta_refp_goal, coarse_check_stride_ > 1,
+                                                      center_state, center_traj, &state->first_success, icand);
+        
+        boost::unique_lock<boost::mutex> lock(state->mutex);
+        if( traj_free && icand < state->first_success.load() )
+        {
+            state->first_success.store(icand);
+            state->success_traj.swap(center_traj);
+            state->success_dist_without_obstacles = center_state.total_ahead_distance;
+        }
     }
+}
 
-    return maneuver_traj_succesful;
+bool ManeuverPlanner::checkSingleManeuverCandidate(const SE2& start, const SingleManeuverCandidate& candidate, double theta_refp_goal, bool coarse_to_fine,
+                                                   CenterTrajectoryState& center_state, std::vector<Eigen::Vector3d>& center_traj,
+                                                   const boost::atomic<size_t>* first_success_index, size_t candidate_index)
+{
+    DublinSegment segment;
+    segment.dist_before_steering = candidate.dist_before_steering_refp;
+    segment.dist_after_steering = candidate.dist_after_steering_refp;
+    segment.signed_turning_radius = candidate.signed_turning_radius_refp;
+    segment.theta_goal = theta_refp_goal;
+    center_traj.clear();
+    initCenterTrajectory(candidate.refpoint_robot_coord, center_state);
+    return checkDublinSegment(start, candidate.refpoint_robot_coord, segment, center_state, center_traj,
+                              coarse_to_fine, first_success_index, candidate_index);
+}
+
+void ManeuverPlanner::traceFailedSingleManeuver(const SE2& start, const std::vector<SingleManeuverCandidate>& candidates, size_t candidates_end,
+                                                double theta_refp_goal, base_local_planner::CompactPlan& plan, double & dist_without_obstacles)
+{
+    std::vector<Eigen::Vector3d> center_traj;
+    CenterTrajectoryState center_state;
+    plan.clear();
+    for (size_t icand = candidates_end; icand > 0; icand--)
+    {
+        if( candidates[icand-1].curve_possible )
+        {
+            checkSingleManeuverCandidate(start, candidates[icand-1], theta_refp_goal, false, center_state, center_traj);
+            dist_without_obstacles = center_state.total_ahead_distance;
+            if( icand == candidates_end )
+                materializePlan(center_traj, plan);
+            break;
+        }
+    }
+}
 
+bool ManeuverPlanner::searchTrajectorySingleManeuver(const SE2& start, 
+                               const SE2& goal, const std::vector<SE2>& refpoint_robot_coord_vec, 
+                               base_local_planner::CompactPlan& plan, double & dist_without_obstacles)
+{
+    if( radius_search_.getStrategy() == parameter_generator::ParameterGenerator::GOLDEN_SECTION_SEARCH )
+        return searchTrajectorySingleManeuverWithFeedback(start, goal, refpoint_robot_coord_vec, plan, dist_without_obstacles);
+    
+    bool maneuver_traj_succesful = false;
+    double theta_refp_goal = angles::normalize_angle( goal.theta() - start.theta() ); // Final angle of curvature    
+    
+    // Candidates in priority order: reference points first, then the radius search of each of them
+    std::vector<SingleManeuverCandidate> candidates;
+    enumerateSingleManeuverCandidates(start, goal, refpoint_robot_coord_vec, candidates);
+    if( candidates.empty() )
+        return false;
+    
+    const bool coarse_to_fine = coarse_check_stride_ > 1;
+    if( !parallel_candidate_evaluation_ || candidates.size() == 1 )
+    {
+        std::vector<Eigen::Vector3d> center_traj;
+        CenterTrajectoryState center_state;
+        size_t icand;
+        for (icand = 0; icand < candidates.size(); icand++)
+        {
+            if( deadlinePassed() )
+                break;
+            const SingleManeuverCandidate& candidate = candidates[icand];
+            center_traj.clear();
+            if( candidate.curve_possible ) // curve possible, generate
+            {
+                if( statistics_ )
+                    statistics_->radius_candidates.fetch_add(1, boost::memory_order_relaxed);
+                maneuver_traj_succesful = checkSingleManeuverCandidate(start, candidate, theta_refp_goal, coarse_to_fine, center_state, center_traj);
+                dist_without_obstacles = center_state.total_ahead_distance;
+            }
+            if (maneuver_traj_succesful)
+                break;
+        }
+        if( !maneuver_traj_succesful && coarse_to_fine )
+        {
+            traceFailedSingleManeuver(start, candidates, icand, theta_refp_goal, plan, dist_without_obstacles);
+            return false;
+        }
+        // Only the reported trajectory is converted to a plan
+        plan.clear();
+        materializePlan(center_traj, plan);
+        return maneuver_traj_succesful;
+    }
+    
+    CandidateSearchState state;
+    state.start = &start;
+    state.candidates = &candidates;
+    state.theta_refp_goal = theta_refp_goal;
+    state.next_candidate = 0;
+    state.first_success.store(candidates.size());
+    
+    worker_pool_->run(boost::bind(&ManeuverPlanner::evaluateSingleManeuverCandidates, this, &state));
+    
+    size_t first_success = state.first_success.load();
+    if( first_success < candidates.size() )
+    {
+        plan.clear();
+        materializePlan(state.success_traj, plan);
+        dist_without_obstacles = state.success_dist_without_obstacles;
+        return true;
+    }
+    
+    // Nothing feasible: report the same as the sequential search, over the candidates it would have evaluated
+    traceFailedSingleManeuver(start, candidates, std::min(state.next_candidate, candidates.size()), theta_refp_goal, plan, dist_without_obstacles);
+    return false;
 }
 
 
+bool ManeuverPlanner::searchTrajectorySingleManeuverWithFeedback(const SE2& start, 
+                               const SE2& goal, const std::vector<SE2>& refpoint_robot_coord_vec, 
+                               base_local_planner::CompactPlan& plan, double & dist_without_obstacles)
+{
+    bool maneuver_traj_succesful = false;
+    double theta_refp_goal = angles::normalize_angle( goal.theta() - start.theta() ); // Final angle of curvature    
+    SE2 refpoint_goal_refstart_coord; // Goal Refpoint in the the start position of the reference point coordinate frame
+    
+    // Local copy of the generator, so concurrent searches do not share its state
+    parameter_generator::ParameterGenerator radius_search = radius_search_;
+    double unsigned_radius;
+    double signed_max_turning_radius_refp;    // Maximum steering radius using the eference point
+    double xlocal_intersection_refp;          // Intersection of target in local x coodinates using the reference point    
+    int maneuver_type_refp;
+    SingleManeuverCandidate candidate;
+    DublinSegment segment;
+    segment.theta_goal = theta_refp_goal;
+    
+    std::vector<Eigen::Vector3d> center_traj;
+    CenterTrajectoryState center_state;
+    std::vector<SE2>::const_iterator refpoint_robot_coord_it;
+    
+    for ( refpoint_robot_coord_it = refpoint_robot_coord_vec.begin(); refpoint_robot_coord_it!=refpoint_robot_coord_vec.end(); refpoint_robot_coord_it++)
+    {
+        refpoint_goal_refstart_coord = (start*(*refpoint_robot_coord_it)).inverse()*(goal*(*refpoint_robot_coord_it));
+        maneuver_type_refp = determineManeuverType(refpoint_goal_refstart_coord,  signed_max_turning_radius_refp, xlocal_intersection_refp);        
+        if (maneuver_type_refp != ManeuverPlanner::MANEUVER_LEFT && maneuver_type_refp != ManeuverPlanner::MANEUVER_RIGHT)
+            continue;   // This only supports single maneuvers
+        if( statistics_ )
+            statistics_->reference_points.fetch_add(1, boost::memory_order_relaxed);
+        
+        // Every radius is checked pose by pose, the part of the trajectory before the first collision tells where to look next.
+        // Radii for which no curve is possible get no feedback, so the search moves away from them
+        candidate.refpoint_robot_coord = *refpoint_robot_coord_it;
+        radius_search.resetSearch(radius_search_.lin_search_min_, std::abs(signed_max_turning_radius_refp));
+        while( !maneuver_traj_succesful && radius_search.search(unsigned_radius) && !deadlinePassed() )
+        {
+            if(signed_max_turning_radius_refp > 0.0)
+                candidate.signed_turning_radius_refp = unsigned_radius;
+            else
+                candidate.signed_turning_radius_refp = -unsigned_radius;         
+            candidate.curve_possible = computeSingleManeuverParameters(refpoint_goal_refstart_coord, candidate.signed_turning_radius_refp,  
+                                                                       xlocal_intersection_refp, candidate.dist_before_steering_refp, candidate.dist_after_steering_refp);
+            center_traj.clear();
+            if( !candidate.curve_possible )
+                continue;
+            if( statistics_ )
+                statistics_->radius_candidates.fetch_add(1, boost::memory_order_relaxed);
+            
+            maneuver_traj_succesful = checkSingleManeuverCandidate(start, candidate, theta_refp_goal, false, center_state, center_traj);
+            dist_without_obstacles = center_state.total_ahead_distance;
+            
+            segment.dist_before_steering = candidate.dist_before_steering_refp;
+            segment.dist_after_steering = candidate.dist_after_steering_refp;
+            segment.signed_turning_radius = candidate.signed_turning_radius_refp;
+            radius_search.setFeedback(segment.completedFraction(center_state.total_ahead_distance));
+        }
+        if( maneuver_traj_succesful )
+            break;
+    }
+    
+    // Like the sequential search: the plan of the last candidate, up to its first collision
+    plan.clear();
+    materializePlan(center_traj, plan);
+    return maneuver_traj_succesful;
+}
 
 bool ManeuverPlanner::linePlanner(const geometry_msgs::PoseStamped& start,
-                               const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan, double &dist_without_obstacles)
+                               const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& plan, double &dist_without_obstacles)
 {
+    StageTimer timer(statistics_ ? &statistics_->collision_check_time : NULL);
     /***** Line planner ****/
     // We want to step forward along the vector created by the robot's position and the goal pose until we find an illegal cell
-    tf::Stamped<tf::Pose> start_tf, goal_tf; 
-    double start_yaw, goal_yaw, useless_pitch, useless_roll;
-    poseStampedMsgToTF(goal,goal_tf);
-    poseStampedMsgToTF(start,start_tf);
-    start_tf.getBasis().getEulerYPR(start_yaw, useless_pitch, useless_roll);
-    goal_tf.getBasis().getEulerYPR(goal_yaw, useless_pitch, useless_roll);
+    // The footprint is up to date, updated by the caller
+    double start_yaw = tf::getYaw(start.pose.orientation);
+    double goal_yaw = tf::getYaw(goal.pose.orientation);
     
     double goal_x = goal.pose.position.x;
     double goal_y = goal.pose.position.y;
@@ -1184,63 +1538,114 @@ bool ManeuverPlanner::linePlanner(const geometry_msgs::PoseStamped& start,
     double diff_y = goal_y - start_y;
     double diff_yaw = angles::normalize_angle(goal_yaw-start_yaw);
 
-    double target_x = start_x;
-    double target_y = start_y;
-    double target_yaw = goal_yaw;
-
-    bool done = false;
-    double scale = 0.0;
     double dScale = 0.05;
     double xyMin = 0.05;
-    double footprint_cost;
-    bool traj_free = true;
     double xydiff = hypot(diff_x,diff_y);
     
     if(xyMin < xydiff*dScale)
     {
         dScale = xyMin/xydiff;
     }
-        
     
-    while(!done)
+    // Scales of the poses, accumulated as the pose by pose walk always did
+    std::vector<double> scales;
+    double scale = 0.0;
+    for( ; scale <= 1.0; scale += dScale)
+        scales.push_back(scale);
+    
+    // Longest run of poses validated at once. Without rotation a run is bounded by line_sweep_length,
+    // with rotation also by the footprint corners moving at most one cell
+    size_t max_run = 1;
+    if( line_sweep_length_ > 0.0 )
     {
-        if(scale > 1.0)
+        double run = xydiff*dScale > 0.0 ? line_sweep_length_/(xydiff*dScale) : scales.size();
+        if( diff_yaw != 0.0 && footprint_radius_ > 0.0 )
+            run = std::min(run, costmap_->getResolution()/(footprint_radius_*std::abs(diff_yaw)*dScale));
+        max_run = std::max(1.0, std::min(run, (double) scales.size()));
+    }
+    const std::vector<geometry_msgs::Point>& footprint = getRobotFootprint();
+    size_t min_run = 1;
+    bool sweep_runs = max_run > 1 && !distance_field_model_ && !footprint.empty();
+    if( sweep_runs )
+    {   // The swept area costs about as much as the perimeters of the poses it replaces when the run is
+        // as long as twice the footprint area over its perimeter, shorter runs are checked pose by pose
+        double area = 0.0, perimeter = 0.0;
+        for (size_t j = 0; j < footprint.size(); j++)
         {
-            target_x = start_x;
-            target_y = start_y;
-            target_yaw = start_yaw;
-
-            done = true;
-            break;
+            const geometry_msgs::Point& a = footprint[j];
+            const geometry_msgs::Point& b = footprint[(j + 1) % footprint.size()];
+            area += 0.5*(a.x*b.y - b.x*a.y);
+            perimeter += hypot(b.x - a.x, b.y - a.y);
         }
-        target_x = start_x + scale * diff_x;
-        target_y = start_y + scale * diff_y;
-        target_yaw = angles::normalize_angle(start_yaw + scale * diff_yaw);
-
-        footprint_cost = footprintCost(target_x, target_y, target_yaw);
-        if(footprint_cost < 0)
+        if( xydiff*dScale > 0.0 && perimeter > 0.0 )
+            min_run = std::max(2.0, std::ceil(2.0*std::abs(area)/(perimeter*xydiff*dScale)));
+        else
+            min_run = 2;
+    }
+    
+    bool traj_free = true;
+    size_t run = max_run;
+    size_t blocked_run_end = 0;  // End of the last run that collided, runs only grow again past it
+    size_t i = 0;
+    while(i < scales.size())
+    {
+        double target_x = start_x + scales[i] * diff_x;
+        double target_y = start_y + scales[i] * diff_y;
+        double target_yaw = angles::normalize_angle(start_yaw + scales[i] * diff_yaw);
+        size_t run_end = i;     // Last pose validated together with this one
+        
+        if( max_run > 1 && distance_field_model_ )
+        {   // The footprint stays inside the clearance circle of this pose while the center moves less than the margin
+            double margin = distance_field_model_->clearance(target_x, target_y) - footprint_radius_;
+            while( margin >= 0.0 && run_end + 1 < scales.size() && run_end + 1 - i < max_run
+                   && (scales[run_end + 1] - scales[i])*xydiff <= margin )
+                run_end++;
+            if( margin < 0.0 && footprintCost(target_x, target_y, target_yaw) < 0 )
+            {
+                traj_free = false;
+                break;
+            }
+        }
+        else if( sweep_runs && run >= min_run && i > 0 )
+        {   // The swept area from the previous pose is grown by the rasterization error of the checks it replaces
+            size_t last = std::min(i - 1 + run, scales.size() - 1);
+            double heading_error = footprint_cache_ ? M_PI/footprint_cache_->numHeadingBins() : 0.0;
+            double padding = 2.0*costmap_->getResolution() + footprint_radius_*(heading_error + std::abs((scales[last] - scales[i - 1])*diff_yaw));
+            footprint_checks_->fetch_add(1, boost::memory_order_relaxed);
+            SE2 from(start_x + scales[i - 1] * diff_x, start_y + scales[i - 1] * diff_y, start_yaw + scales[i - 1] * diff_yaw);
+            SE2 to(start_x + scales[last] * diff_x, start_y + scales[last] * diff_y, start_yaw + scales[last] * diff_yaw);
+            if( sweptAreaFree(*costmap_, footprint, from, to, padding) )
+            {
+                run_end = last;
+                if( last >= blocked_run_end )
+                    run = std::min(2*run, max_run);
+            }
+            else
+            {   // Close to obstacles, the poses of the run are checked one by one
+                blocked_run_end = last;
+                run = 1;
+                continue;
+            }
+        }
+        else
         {
-            done = true;
-            traj_free = false;
-            break;
+            if( footprintCost(target_x, target_y, target_yaw) < 0 )
+            {
+                traj_free = false;
+                break;
+            }
+            if( i >= blocked_run_end )
+                run = std::min(2*run, max_run);
         }
-        scale +=dScale;
-
-        geometry_msgs::PoseStamped new_goal = goal;
-        tf::Quaternion goal_quat = tf::createQuaternionFromYaw(target_yaw);
-
-        new_goal.pose.position.x = target_x;
-        new_goal.pose.position.y = target_y;
-
-        new_goal.pose.orientation.x = goal_quat.x();
-        new_goal.pose.orientation.y = goal_quat.y();
-        new_goal.pose.orientation.z = goal_quat.z();
-        new_goal.pose.orientation.w = goal_quat.w();
-
-        plan.push_back(new_goal);
-
+        
+        plan.push_back(target_x, target_y, target_yaw);
+        for( i++; i <= run_end; i++)
+            plan.push_back(start_x + scales[i] * diff_x, start_y + scales[i] * diff_y, angles::normalize_angle(start_yaw + scales[i] * diff_yaw));
     }
     
+    // Scale of the first pose that collides, past the goal if none does
+    if( !traj_free )
+        scale = scales[i];
     dist_without_obstacles = scale*xydiff;
     
     if(scale < 1.0)
@@ -1251,29 +1656,14 @@ bool ManeuverPlanner::linePlanner(const geometry_msgs::PoseStamped& start,
 
 }
 
-void ManeuverPlanner::removeLastPoints( std::vector<geometry_msgs::PoseStamped>& plan, double & distToRemove)
+void ManeuverPlanner::removeLastPoints( base_local_planner::CompactPlan& plan, double & distToRemove)
 {
-    int i;
-    double dist_next_point;
-    double total_ahead_distance = 0.0;
-    int initialplanSize = plan.size();
-    
-        
-    
-    for (i = initialplanSize-1; i > 0; i--) 
-    {
-        dist_next_point = hypot(plan[i].pose.position.x-plan[i-1].pose.position.x,plan[i].pose.position.y-plan[i-1].pose.position.y);
-        total_ahead_distance += dist_next_point;
-
-        if( total_ahead_distance < distToRemove)
-        {
-           plan.pop_back();
-        }
-        else
-        {
-            break;
-        }
-    }  
+    // Pose i is kept while the plan after pose i-1 is at least distToRemove long, the first pose always
+    size_t initialplanSize = plan.size();
+    if( initialplanSize < 2 )
+        return;
+    size_t newplanSize = 1 + std::min(plan.indexAtArcLength(plan.length() - distToRemove), initialplanSize - 1);
+    plan.truncate(newplanSize);
     return;
     
 }
@@ -1281,19 +1671,154 @@ void ManeuverPlanner::removeLastPoints( std::vector<geometry_msgs::PoseStamped>&
 bool ManeuverPlanner::makePlan(const geometry_msgs::PoseStamped& start,
                                const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles)
 {
-    return makePlanUntilPossible(start, goal, plan, dist_without_obstacles);
+    bool search_complete;
+    return makePlan(start, goal, plan, dist_without_obstacles, defaultDeadline(), search_complete);
+}
+
+bool ManeuverPlanner::makePlan(const geometry_msgs::PoseStamped& start,
+                               const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles,
+                               const ros::WallTime& deadline, bool& search_complete)
+{
+    base_local_planner::CompactPlan compact_plan;
+    bool plan_free = makePlan(start, goal, compact_plan, dist_without_obstacles, deadline, search_complete);
+    compact_plan.toPoses(plan);
+    return plan_free;
+}
+
+bool ManeuverPlanner::makePlan(const geometry_msgs::PoseStamped& start,
+                               const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& plan, double & dist_without_obstacles)
+{
+    bool search_complete;
+    return makePlan(start, goal, plan, dist_without_obstacles, defaultDeadline(), search_complete);
+}
+
+bool ManeuverPlanner::makePlan(const geometry_msgs::PoseStamped& start,
+                               const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& plan, double & dist_without_obstacles,
+                               const ros::WallTime& deadline, bool& search_complete)
+{
+    ros::WallTime call_start = ros::WallTime::now();
+    deadline_ = deadline;
+    search_interrupted_->store(false);
+    bool plan_free = makePlanUntilPossible(start, goal, plan, dist_without_obstacles);
+    if( recorder_ )
+        recordPlan(start, goal, false, deadline, call_start, plan, plan_free, dist_without_obstacles);
+    search_complete = !search_interrupted_->load();
+    if( !search_complete )
+        ROS_WARN("Planning deadline reached, using the best plan found so far");
+    if( statistics_ )
+        statistics_->statistics->search_complete = search_complete;
+    deadline_ = ros::WallTime();
+    search_interrupted_->store(false);
+    return plan_free;
+}
+
+bool ManeuverPlanner::makePlan(const geometry_msgs::PoseStamped& start,
+                               const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& plan, double & dist_without_obstacles,
+                               const ros::WallTime& deadline, bool& search_complete, PlanningStatistics& statistics)
+{
+    StatisticsCollector collector;
+    beginStatistics(collector, statistics);
+    bool plan_free = makePlan(start, goal, plan, dist_without_obstacles, deadline, search_complete);
+    endStatistics(plan_free);
+    return plan_free;
+}
+
+bool ManeuverPlanner::makePlan(const geometry_msgs::PoseStamped& start,
+                               const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& plan, double & dist_without_obstacles, bool uselinePlanner,
+                               PlanningStatistics& statistics)
+{
+    StatisticsCollector collector;
+    beginStatistics(collector, statistics);
+    bool plan_free = makePlan(start, goal, plan, dist_without_obstacles, uselinePlanner);
+    endStatistics(plan_free);
+    return plan_free;
+}
+
+void ManeuverPlanner::beginStatistics(StatisticsCollector& collector, PlanningStatistics& statistics)
+{
+    statistics.reset();
+    collector.statistics = &statistics;
+    collector.start_time = ros::WallTime::now();
+    collector.start_footprint_checks = getFootprintChecks();
+    statistics_ = &collector;
+}
+
+void ManeuverPlanner::endStatistics(bool plan_free)
+{
+    PlanningStatistics& statistics = *statistics_->statistics;
+    statistics.plan_free = plan_free;
+    statistics.reference_points = statistics_->reference_points.load();
+    statistics.radius_candidates = statistics_->radius_candidates.load();
+    statistics.midway_candidates = statistics_->midway_candidates.load();
+    statistics.footprint_checks = getFootprintChecks() - statistics_->start_footprint_checks;
+    statistics.determine_maneuver_time = 1e-9*statistics_->determine_maneuver_time.load();
+    statistics.generation_time = 1e-9*statistics_->generation_time.load();
+    statistics.collision_check_time = 1e-9*statistics_->collision_check_time.load();
+    statistics.fallback_time = 1e-9*statistics_->fallback_time.load();
+    statistics.total_time = (ros::WallTime::now() - statistics_->start_time).toSec();
+    statistics_ = NULL;
+}
+
+void ManeuverPlanner::recordPlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal, bool use_line_planner,
+                                 const ros::WallTime& deadline, const ros::WallTime& call_start, const base_local_planner::CompactPlan& plan,
+                                 bool plan_free, double dist_without_obstacles)
+{
+    PlanRecord record;
+    record.planning_time = (ros::WallTime::now() - call_start).toSec();
+    record.start = start;
+    record.goal = goal;
+    record.use_line_planner = use_line_planner;
+    record.time_budget = deadline.isZero() ? 0.0 : std::max((deadline - call_start).toSec(), 1e-6);
+    if( footprint_ )
+        record.footprint = footprint_->getFootprint();
+    record.plan_free = plan_free;
+    record.dist_without_obstacles = dist_without_obstacles;
+    record.plan_size = plan.size();
+    
+    // The costmap is not changed by planning, so the window taken now is the one the plan was made in
+    double margin = record_window_margin_ + footprint_radius_;
+    record.cropCostmap(*costmap_, std::min(start.pose.position.x, goal.pose.position.x) - margin,
+                                  std::min(start.pose.position.y, goal.pose.position.y) - margin,
+                                  std::max(start.pose.position.x, goal.pose.position.x) + margin,
+                                  std::max(start.pose.position.y, goal.pose.position.y) + margin);
+    recorder_->write(record);
+}
+
+ros::WallTime ManeuverPlanner::defaultDeadline() const
+{
+    if( max_planning_time_ > 0.0 )
+        return ros::WallTime::now() + ros::WallDuration(max_planning_time_);
+    return ros::WallTime();
 }
 
 bool ManeuverPlanner::makePlan(const geometry_msgs::PoseStamped& start,
                                const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles, bool uselinePlanner)
+{
+    base_local_planner::CompactPlan compact_plan;
+    bool plan_free = makePlan(start, goal, compact_plan, dist_without_obstacles, uselinePlanner);
+    compact_plan.toPoses(plan);
+    return plan_free;
+}
+
+bool ManeuverPlanner::makePlan(const geometry_msgs::PoseStamped& start,
+                               const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& plan, double & dist_without_obstacles, bool uselinePlanner)
 {
     if(uselinePlanner)
     {
-        return linePlanner(start, goal, plan, dist_without_obstacles);
+        ros::WallTime call_start = ros::WallTime::now();
+        // The line is checked against the same world as the maneuvers, distance field included
+        updateWorldState();
+        plan.clear();
+        plan.setFrameId(goal.header.frame_id);
+        plan.setStamp(goal.header.stamp);
+        bool plan_free = linePlanner(start, goal, plan, dist_without_obstacles);
+        if( recorder_ )
+            recordPlan(start, goal, true, ros::WallTime(), call_start, plan, plan_free, dist_without_obstacles);
+        return plan_free;
     }
     else
     {
-        return makePlanUntilPossible(start, goal, plan, dist_without_obstacles);
+        return makePlan(start, goal, plan, dist_without_obstacles);
     }
     
 }
@@ -1302,76 +1827,120 @@ bool ManeuverPlanner::makePlan(const geometry_msgs::PoseStamped& start,
                                const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan)
 {
     double dist_without_obstacles;
-    return makePlanUntilPossible(start, goal, plan, dist_without_obstacles);
+    return makePlan(start, goal, plan, dist_without_obstacles);
 }
 
+bool ManeuverPlanner::checkGoals(const geometry_msgs::PoseStamped& start, const std::vector<geometry_msgs::PoseStamped>& goals,
+                                 std::vector<GoalFeasibility>& results, bool keep_plans)
+{
+    return checkGoalBatch(start, goals, false, results, keep_plans);
+}
 
-bool ManeuverPlanner::makePlanUntilPossible(const geometry_msgs::PoseStamped& start,
-                               const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan, double & dist_without_obstacles)
+bool ManeuverPlanner::checkWaypoints(const geometry_msgs::PoseStamped& start, const std::vector<geometry_msgs::PoseStamped>& waypoints,
+                                     std::vector<GoalFeasibility>& results, bool keep_plans)
 {
+    return checkGoalBatch(start, waypoints, true, results, keep_plans);
+}
 
+bool ManeuverPlanner::checkGoalBatch(const geometry_msgs::PoseStamped& start, const std::vector<geometry_msgs::PoseStamped>& goals, bool chain,
+                                     std::vector<GoalFeasibility>& results, bool keep_plans)
+{
+    results.clear();
     if(!initialized_)
     {
         ROS_ERROR("The planner has not been initialized, please call initialize() to use the planner");
         return false;
     }
+    results.resize(goals.size());
+    
+    // One costmap snapshot and footprint update for all the goals
+    updateWorldState();
+    
+    base_local_planner::CompactPlan plan;
+    const geometry_msgs::PoseStamped* leg_start = &start;
+    bool all_feasible = true;
+    for (size_t igoal = 0; igoal < goals.size(); igoal++)
+    {
+        GoalFeasibility& result = results[igoal];
+        // Every goal gets its own time budget
+        deadline_ = defaultDeadline();
+        search_interrupted_->store(false);
+        result.feasible = planInUpdatedWorld(*leg_start, goals[igoal], plan, result.dist_without_obstacles);
+        result.search_complete = !search_interrupted_->load();
+        if( keep_plans )
+            result.plan.swap(plan);
+        all_feasible = all_feasible && result.feasible;
+        if( chain )
+            leg_start = &goals[igoal];
+    }
+    deadline_ = ros::WallTime();
+    search_interrupted_->store(false);
+    
+    ROS_DEBUG("Checked %zu goals, all feasible: %d", goals.size(), (int) all_feasible);
+    return all_feasible;
+}
 
-    ROS_DEBUG("Got a start: %.2f, %.2f, and a goal: %.2f, %.2f", start.pose.position.x, start.pose.position.y, goal.pose.position.x, goal.pose.position.y);
 
-    plan.clear();
-    costmap_ = costmap_ros_->getCostmap();
+bool ManeuverPlanner::makePlanUntilPossible(const geometry_msgs::PoseStamped& start,
+                               const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& plan, double & dist_without_obstacles)
+{
 
-    if(goal.header.frame_id != costmap_ros_->getGlobalFrameID())
+    if(!initialized_)
     {
-        ROS_ERROR("This planner as configured will only accept goals in the %s frame, but a goal was sent in the %s frame.",
-                  costmap_ros_->getGlobalFrameID().c_str(), goal.header.frame_id.c_str());
+        ROS_ERROR("The planner has not been initialized, please call initialize() to use the planner");
         return false;
     }
 
-    tf::Stamped<tf::Pose> goal_tf;
-    tf::Stamped<tf::Pose> start_tf;
-    double useless_pitch, useless_roll, goal_yaw, start_yaw;
+    ROS_DEBUG("Got a start: %.2f, %.2f, and a goal: %.2f, %.2f", start.pose.position.x, start.pose.position.y, goal.pose.position.x, goal.pose.position.y);
 
-    /*
-        poseStampedMsgToTF(goal,goal_tf);
-        poseStampedMsgToTF(start,start_tf);
+    updateWorldState();
+    // A single request may continue from the previous goal, the legs of a batch always start where they are given
+    if( last_goal_as_start_ && valid_last_goal_ )
+        return planInUpdatedWorld(last_goal_, goal, plan, dist_without_obstacles);
+    return planInUpdatedWorld(start, goal, plan, dist_without_obstacles);
+}
 
-        start_tf.getBasis().getEulerYPR(start_yaw, useless_pitch, useless_roll);
-        goal_tf.getBasis().getEulerYPR(goal_yaw, useless_pitch, useless_roll);
-       */
-    /****************************/
-    double temp_yaw, temp_pitch, temp_roll;
-    tf::Quaternion temp_quat;
-    tf::Vector3 temp_vector3;
+void ManeuverPlanner::updateWorldState()
+{
+    if( costmap_ros_ )
+        costmap_ = costmap_ros_->getCostmap();
+    updateFootprint();
+    if( distance_field_model_ )
+        distance_field_model_->update();
+    if( candidate_memo_ )
+        candidate_memo_->update(*costmap_, getRobotFootprint());
+}
 
-    if( last_goal_as_start_ & valid_last_goal_)
-    {
-        start_ = last_goal_;
-    }
-    else
+bool ManeuverPlanner::planInUpdatedWorld(const geometry_msgs::PoseStamped& start,
+                               const geometry_msgs::PoseStamped& goal, base_local_planner::CompactPlan& plan, double & dist_without_obstacles)
+{
+    plan.clear();
+    dist_without_obstacles = 0.0;   // Stays so when the deadline passes before anything is checked
+
+    if(goal.header.frame_id != getGlobalFrameID())
     {
-        start_ = start;
+        ROS_ERROR("This planner as configured will only accept goals in the %s frame, but a goal was sent in the %s frame.",
+                  getGlobalFrameID().c_str(), goal.header.frame_id.c_str());
+        return false;
     }
 
-    poseStampedMsgToTF(goal,goal_tf);
-    poseStampedMsgToTF(start_,start_tf);
-
-
-    start_tf.getBasis().getEulerYPR(start_yaw, useless_pitch, useless_roll);
-    goal_tf.getBasis().getEulerYPR(goal_yaw, useless_pitch, useless_roll);
+    // Only planar poses are used by the searches, plan poses are stamped at the end
+    SE2 goal_pose = poseToSE2(goal.pose);
+    SE2 start_pose = poseToSE2(start.pose);
 
-
-    tf::Stamped<tf::Pose> goal_tf_start_coord; // Goal in the start vector coordinates
-    goal_tf_start_coord.frame_id_ = "/center_rotation_start_pos";
-
-    translate2D(goal_tf,-start_tf.getOrigin(),goal_tf_start_coord);
-    rotate2D(goal_tf_start_coord,-start_yaw,goal_tf_start_coord);
+    SE2 goal_start_coord = start_pose.inverse()*goal_pose; // Goal in the start vector coordinates
 
     
     // Initially compute the type of maneuver, use the center of the robot. This is only done once
     double signed_max_turning_radius_center;    // Maximum steering radius using the center of the robot
     double xlocal_intersection_center;          // Intersection of target in local x coodinates
-    int maneuver_type = determineManeuverType(goal_tf_start_coord,  signed_max_turning_radius_center, xlocal_intersection_center);
+    int maneuver_type;
+    {
+        StageTimer timer(statistics_ ? &statistics_->determine_maneuver_time : NULL);
+        maneuver_type = determineManeuverType(goal_start_coord,  signed_max_turning_radius_center, xlocal_intersection_center);
+    }
+    if( statistics_ )
+        statistics_->statistics->maneuver_type = maneuver_type;
     
     /* Next, depending on the type of maneuver, trajectories are generated using a preferred reference point on the robot 
      * If after exploration maneuver is not possible, then search again using the center of the robot
@@ -1379,9 +1948,51 @@ bool ManeuverPlanner::makePlanUntilPossible(const geometry_msgs::PoseStamped& st
      * If all fails, report that no free path is found
     */
     
-    tf::Stamped<tf::Pose> refpoint_tf_robot_coord; // Refpoint in the robot(+load) coordinate frame
-    std::vector< tf::Stamped<tf::Pose> > refpoint_tf_robot_coord_vec;
-    double maneuver_traj_succesful = false;
+    bool maneuver_traj_succesful;
+    int fallback = PlanningStatistics::FALLBACK_NONE;
+    if( speculative_fallbacks_ && maneuver_type != ManeuverPlanner::MANEUVER_STRAIGHT_OTHERWISE_OVERTAKE )
+    {
+        maneuver_traj_succesful = planWithSpeculativeFallbacks(maneuver_type, start, goal, start_pose, goal_pose, plan, dist_without_obstacles, fallback);
+    }
+    else
+    {
+        maneuver_traj_succesful = planPreferredManeuver(maneuver_type, start, goal, start_pose, goal_pose, plan, dist_without_obstacles);
+        if( fallbacksNeeded(maneuver_type, maneuver_traj_succesful, dist_without_obstacles) )
+        {
+            ROS_WARN("Basic maneuvers did not work and obstacles are close, Try to plan Line ... ");
+            plan.clear();
+            maneuver_traj_succesful = planFallbacks(start, goal, start_pose, goal_pose, plan, dist_without_obstacles, fallback);
+        }
+    }
+    if( statistics_ )
+        statistics_->statistics->fallback = fallback;
+   
+//     for (int iplan = 1; iplan<plan.size()-1;iplan++)
+//     {
+//         std::cout << "plan_angle " << plan. <<std::endl;
+//     }
+//    
+   
+    if(maneuver_traj_succesful == false){
+        // remove last maxDistanceBeforeObstacle_ meters from trajectory
+        removeLastPoints(plan, maxDistanceBeforeObstacle_);                
+        ROS_WARN("No goal-free trajectory found");
+    }
+    
+    plan.setFrameId(goal.header.frame_id);
+    plan.setStamp(goal.header.stamp);
+    return maneuver_traj_succesful;
+
+}
+
+
+
+bool ManeuverPlanner::planPreferredManeuver(int maneuver_type, const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                                 const SE2& start_pose, const SE2& goal_pose, base_local_planner::CompactPlan& plan, double & dist_without_obstacles)
+{
+    SE2 refpoint_robot_coord; // Refpoint in the robot(+load) coordinate frame
+    std::vector<SE2> refpoint_robot_coord_vec;
+    bool maneuver_traj_succesful = false;
     
     
 
@@ -1392,26 +2003,13 @@ bool ManeuverPlanner::makePlanUntilPossible(const geometry_msgs::PoseStamped& st
         // trajectory. Suitable for when trc is desired to keep parallel to the
         // wall. If the trc trajectory is not convex, we switch back
         // reference point to middle of the rotation axis.
-        refpoint_tf_robot_coord.frame_id_ = "/wholerobot_link";
-        refpoint_tf_robot_coord.stamp_ = goal_tf.stamp_;
-        temp_quat.setRPY(0.0,0.0,0.0);
-        refpoint_tf_robot_coord_vec.clear();
-                            
-        
-        temp_vector3 = tf::Vector3(topRightCorner_[0], topRightCorner_[1], 0.0);
-        refpoint_tf_robot_coord.setData(tf::Transform(temp_quat,temp_vector3));            
-        refpoint_tf_robot_coord_vec.push_back(refpoint_tf_robot_coord);        
-        
-        temp_vector3 = tf::Vector3(0.0, 0.0, 0.0);
-        refpoint_tf_robot_coord.setData(tf::Transform(temp_quat,temp_vector3));
-        refpoint_tf_robot_coord_vec.push_back(refpoint_tf_robot_coord);                
-        
-        temp_vector3 = tf::Vector3(left_side_ref_point_[0], left_side_ref_point_[1], 0.0);
-        refpoint_tf_robot_coord.setData(tf::Transform(temp_quat,temp_vector3));
-        refpoint_tf_robot_coord_vec.push_back(refpoint_tf_robot_coord);
+        refpoint_robot_coord_vec.clear();
+        refpoint_robot_coord_vec.push_back(SE2(topRightCorner_[0], topRightCorner_[1], 0.0));
+        refpoint_robot_coord_vec.push_back(SE2(0.0, 0.0, 0.0));
+        refpoint_robot_coord_vec.push_back(SE2(left_side_ref_point_[0], left_side_ref_point_[1], 0.0));
         
         ROS_INFO("Try to plan Left turn");
-        maneuver_traj_succesful = searchTrajectorySingleManeuver(start_tf, goal_tf, refpoint_tf_robot_coord_vec, plan, dist_without_obstacles);
+        maneuver_traj_succesful = searchTrajectorySingleManeuver(start_pose, goal_pose, refpoint_robot_coord_vec, plan, dist_without_obstacles);
         break;
 
     case ManeuverPlanner::MANEUVER_RIGHT :
@@ -1421,58 +2019,33 @@ bool ManeuverPlanner::makePlanUntilPossible(const geometry_msgs::PoseStamped& st
         // trajectory. Suitable for when that point should just round the corner.
         // If recomputing trajectory is not possible, the switch back
         // reference point to middle of the rotation axis.
-        refpoint_tf_robot_coord.frame_id_ = "/wholerobot_link";
-        refpoint_tf_robot_coord.stamp_ = goal_tf.stamp_;            
-        temp_quat.setRPY(0.0,0.0,0.0);
-        refpoint_tf_robot_coord_vec.clear();
-        
-        temp_vector3 = tf::Vector3(right_side_ref_point_[0], right_side_ref_point_[1], 0.0);
-        refpoint_tf_robot_coord.setData(tf::Transform(temp_quat,temp_vector3));            
-        refpoint_tf_robot_coord_vec.push_back(refpoint_tf_robot_coord);                    
-        
-        temp_vector3 = tf::Vector3(0.0, 0.0, 0.0);
-        refpoint_tf_robot_coord.setData(tf::Transform(temp_quat,temp_vector3));
-        refpoint_tf_robot_coord_vec.push_back(refpoint_tf_robot_coord);                               
-        
-        temp_vector3 = tf::Vector3(topLeftCorner_[0], topLeftCorner_[1], 0.0);
-        refpoint_tf_robot_coord.setData(tf::Transform(temp_quat,temp_vector3));            
-        refpoint_tf_robot_coord_vec.push_back(refpoint_tf_robot_coord);
-        
-        
+        refpoint_robot_coord_vec.clear();
+        refpoint_robot_coord_vec.push_back(SE2(right_side_ref_point_[0], right_side_ref_point_[1], 0.0));
+        refpoint_robot_coord_vec.push_back(SE2(0.0, 0.0, 0.0));
+        refpoint_robot_coord_vec.push_back(SE2(topLeftCorner_[0], topLeftCorner_[1], 0.0));
         
         ROS_INFO("Try to plan Right turn");
-        maneuver_traj_succesful = searchTrajectorySingleManeuver(start_tf, goal_tf, refpoint_tf_robot_coord_vec, plan, dist_without_obstacles);
+        maneuver_traj_succesful = searchTrajectorySingleManeuver(start_pose, goal_pose, refpoint_robot_coord_vec, plan, dist_without_obstacles);
         
         break;            
     case ManeuverPlanner::MANEUVER_LEFT_RIGHT :
         // Initially choose top left corner (trc) as reference to generate
         // trajectory. Suitable for when tlc is desired to keep parallel to the
         // left wall. 
-        refpoint_tf_robot_coord.frame_id_ = "/wholerobot_link";
-        refpoint_tf_robot_coord.stamp_ = goal_tf.stamp_;
-        temp_quat.setRPY(0.0,0.0,0.0);
-        
-//             temp_vector3 = tf::Vector3(topLeftCorner_[0], topLeftCorner_[1], 0.0);
-        temp_vector3 = tf::Vector3(topRightCorner_[0], topRightCorner_[1], 0.0);
-        refpoint_tf_robot_coord.setData(tf::Transform(temp_quat,temp_vector3));
+//             refpoint_robot_coord = SE2(topLeftCorner_[0], topLeftCorner_[1], 0.0);
+        refpoint_robot_coord = SE2(topRightCorner_[0], topRightCorner_[1], 0.0);
         
         ROS_INFO("Try to plan Left-Right turn"); 
-        maneuver_traj_succesful = searchTrajectoryLeftRightManeuver(start_tf, goal_tf, refpoint_tf_robot_coord, plan, dist_without_obstacles);            
+        maneuver_traj_succesful = searchTrajectoryLeftRightManeuver(start_pose, goal_pose, refpoint_robot_coord, plan, dist_without_obstacles);            
         break;
     case ManeuverPlanner::MANEUVER_RIGHT_LEFT :
         // Initially choose top left corner (trc) as reference to generate
         // trajectory. Suitable for when tlc is desired to keep parallel to the
         // left wall. 
-        refpoint_tf_robot_coord.frame_id_ = "/wholerobot_link";
-        refpoint_tf_robot_coord.stamp_ = goal_tf.stamp_;
-        temp_quat.setRPY(0.0,0.0,0.0);
-
-        temp_vector3 = tf::Vector3(topRightCorner_[0], topRightCorner_[1], 0.0);
-        refpoint_tf_robot_coord.setData(tf::Transform(temp_quat,temp_vector3));
-
+        refpoint_robot_coord = SE2(topRightCorner_[0], topRightCorner_[1], 0.0);
         
         ROS_INFO("Try to plan Right-Left turn"); 
-        maneuver_traj_succesful = searchTrajectoryLeftRightManeuver(start_tf, goal_tf, refpoint_tf_robot_coord, plan, dist_without_obstacles);            
+        maneuver_traj_succesful = searchTrajectoryLeftRightManeuver(start_pose, goal_pose, refpoint_robot_coord, plan, dist_without_obstacles);            
         break;     
     case ManeuverPlanner::MANEUVER_NONE :
         ROS_INFO("Try straight line"); 
@@ -1482,18 +2055,13 @@ bool ManeuverPlanner::makePlanUntilPossible(const geometry_msgs::PoseStamped& st
         ROS_INFO("Try straight line, otherwise overtake"); 
         maneuver_traj_succesful = linePlanner(start, goal, plan, dist_without_obstacles);            
          std::cout << "Maneuver Planner: dist_without_obstacles " << dist_without_obstacles << std::endl; 
-        if( maneuver_traj_succesful == false && dist_without_obstacles < ( maxDistanceBeforeObstacle_ + maxDistanceBeforeReplanning_) )
+        if( maneuver_traj_succesful == false && dist_without_obstacles < ( maxDistanceBeforeObstacle_ + maxDistanceBeforeReplanning_) && !deadlinePassed() )
         {                
             ROS_INFO("Did not work and obstacles are close: Try to plan Overtake maneuver"); 
-            refpoint_tf_robot_coord.frame_id_ = "/wholerobot_link";
-            refpoint_tf_robot_coord.stamp_ = goal_tf.stamp_;
-            temp_quat.setRPY(0.0,0.0,0.0);
-
-            temp_vector3 = tf::Vector3(topRightCorner_[0], topRightCorner_[1], 0.0);
-//                 temp_vector3 = tf::Vector3(0.0, 0.0, 0.0);
-            refpoint_tf_robot_coord.setData(tf::Transform(temp_quat,temp_vector3));         
+            refpoint_robot_coord = SE2(topRightCorner_[0], topRightCorner_[1], 0.0);
+//                 refpoint_robot_coord = SE2(0.0, 0.0, 0.0);
             plan.clear();
-            maneuver_traj_succesful = searchTrajectoryOvertakeManeuver(start_tf, goal_tf, refpoint_tf_robot_coord, plan, dist_without_obstacles);        
+            maneuver_traj_succesful = searchTrajectoryOvertakeManeuver(start_pose, goal_pose, refpoint_robot_coord, plan, dist_without_obstacles);        
         }
         
 //         if( maneuver_traj_succesful == false)
@@ -1507,47 +2075,124 @@ bool ManeuverPlanner::makePlanUntilPossible(const geometry_msgs::PoseStamped& st
         break;
     }
 
+    return maneuver_traj_succesful;
+}
 
-   
-    
+bool ManeuverPlanner::fallbacksNeeded(int maneuver_type, bool maneuver_traj_succesful, double dist_without_obstacles)
+{
+    // Fallbacks are only tried while there is time left, otherwise the plan found so far is kept
+    return maneuver_traj_succesful == false && maneuver_type != ManeuverPlanner::MANEUVER_STRAIGHT_OTHERWISE_OVERTAKE 
+           && dist_without_obstacles < ( maxDistanceBeforeObstacle_ + maxDistanceBeforeReplanning_) && !deadlinePassed();
+}
 
-    if( maneuver_traj_succesful == false && maneuver_type != ManeuverPlanner::MANEUVER_STRAIGHT_OTHERWISE_OVERTAKE && dist_without_obstacles < ( maxDistanceBeforeObstacle_ + maxDistanceBeforeReplanning_) )
+bool ManeuverPlanner::planFallbacks(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                         const SE2& start_pose, const SE2& goal_pose, base_local_planner::CompactPlan& plan, double & dist_without_obstacles,
+                         int& fallback)
+{
+    StageTimer timer(statistics_ ? &statistics_->fallback_time : NULL);
+    fallback = PlanningStatistics::FALLBACK_LINE;
+    bool maneuver_traj_succesful = linePlanner(start, goal, plan, dist_without_obstacles); 
+     std::cout << "Maneuver Planner: dist_without_obstacles " << dist_without_obstacles << std::endl; 
+    if (maneuver_traj_succesful == false && dist_without_obstacles <  maxDistanceBeforeObstacle_ && !deadlinePassed())
     {
-        ROS_WARN("Basic maneuvers did not work and obstacles are close, Try to plan Line ... ");
+         ROS_WARN("... or Overtake maneuver");
+        SE2 refpoint_robot_coord = SE2(topRightCorner_[0], topRightCorner_[1], 0.0);
         plan.clear();
-        maneuver_traj_succesful = linePlanner(start, goal, plan, dist_without_obstacles); 
-         std::cout << "Maneuver Planner: dist_without_obstacles " << dist_without_obstacles << std::endl; 
-        if (maneuver_traj_succesful == false && dist_without_obstacles <  maxDistanceBeforeObstacle_)
-        {
-             ROS_WARN("... or Overtake maneuver");
-            refpoint_tf_robot_coord.frame_id_ = "/wholerobot_link";
-            refpoint_tf_robot_coord.stamp_ = goal_tf.stamp_;
-            temp_quat.setRPY(0.0,0.0,0.0);
-
-            temp_vector3 = tf::Vector3(topRightCorner_[0], topRightCorner_[1], 0.0);
-            refpoint_tf_robot_coord.setData(tf::Transform(temp_quat,temp_vector3));         
-            plan.clear();
-            maneuver_traj_succesful = searchTrajectoryOvertakeManeuver(start_tf, goal_tf, refpoint_tf_robot_coord, plan, dist_without_obstacles);   
-        }
-        
-                 
-    }
-   
-//     for (int iplan = 1; iplan<plan.size()-1;iplan++)
-//     {
-//         std::cout << "plan_angle " << plan. <<std::endl;
-//     }
-//    
-   
-    if(maneuver_traj_succesful == false){
-        // remove last maxDistanceBeforeObstacle_ meters from trajectory
-        removeLastPoints(plan, maxDistanceBeforeObstacle_);                
-        ROS_WARN("No goal-free trajectory found");
+        fallback = PlanningStatistics::FALLBACK_OVERTAKE;
+        maneuver_traj_succesful = searchTrajectoryOvertakeManeuver(start_pose, goal_pose, refpoint_robot_coord, plan, dist_without_obstacles);   
     }
     return maneuver_traj_succesful;
+}
 
+struct ManeuverPlanner::SpeculativeSearchState
+{
+    int maneuver_type;
+    const geometry_msgs::PoseStamped* start;
+    const geometry_msgs::PoseStamped* goal;
+    const SE2* start_pose;
+    const SE2* goal_pose;
+    
+    boost::mutex mutex;
+    size_t next_search;         // 0 is the preferred maneuver, 1 the fallbacks
+    
+    bool preferred_succesful;
+    double preferred_dist_without_obstacles;
+    base_local_planner::CompactPlan preferred_plan;
+    bool fallbacks_needed;
+    
+    // The fallbacks are cancelled through the interruption flag of their context
+    SearchContext fallbacks;
+};
+
+bool ManeuverPlanner::planWithSpeculativeFallbacks(int maneuver_type, const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                                        const SE2& start_pose, const SE2& goal_pose, base_local_planner::CompactPlan& plan, double & dist_without_obstacles,
+                                        int& fallback)
+{
+    SpeculativeSearchState state;
+    state.maneuver_type = maneuver_type;
+    state.start = &start;
+    state.goal = &goal;
+    state.start_pose = &start_pose;
+    state.goal_pose = &goal_pose;
+    state.next_search = 0;
+    state.preferred_succesful = false;
+    state.preferred_dist_without_obstacles = 0.0;
+    state.fallbacks_needed = false;
+    
+    // Both searches take the pool, so the candidates within each of them are evaluated on a single thread
+    worker_pool_->run(boost::bind(&ManeuverPlanner::evaluateSpeculativeSearch, this, &state));
+    
+    if( !state.fallbacks_needed )
+    {
+        plan.swap(state.preferred_plan);
+        dist_without_obstacles = state.preferred_dist_without_obstacles;
+        return state.preferred_succesful;
+    }
+    
+    ROS_WARN("Basic maneuvers did not work and obstacles are close, Try to plan Line ... ");
+    // The fallbacks were never cancelled, so they can only have been interrupted by the deadline
+    if( state.fallbacks.interrupted.load() )
+        search_interrupted_->store(true);
+    plan.swap(state.fallbacks.plan);
+    dist_without_obstacles = state.fallbacks.dist_without_obstacles;
+    fallback = state.fallbacks.fallback;
+    return state.fallbacks.succesful;
 }
 
+void ManeuverPlanner::evaluateSpeculativeSearch(SpeculativeSearchState* state)
+{
+    while(true)
+    {
+        size_t isearch;
+        {
+            boost::unique_lock<boost::mutex> lock(state->mutex);
+            isearch = state->next_search++;
+        }
+        
+        if( isearch == 0 )
+        {
+            state->preferred_succesful = planPreferredManeuver(state->maneuver_type, *state->start, *state->goal, *state->start_pose, *state->goal_pose,
+                                                               state->preferred_plan, state->preferred_dist_without_obstacles);
+            state->fallbacks_needed = fallbacksNeeded(state->maneuver_type, state->preferred_succesful, state->preferred_dist_without_obstacles);
+            if( !state->fallbacks_needed )
+                state->fallbacks.interrupted.store(true);
+        }
+        else if( isearch == 1 )
+        {   // Not started at all when already cancelled, e.g. when this thread did the preferred maneuver first
+            if( !state->fallbacks.interrupted.load() )
+            {   // The searches of this planner check the interruption flag of the context while it is installed on this thread
+                search_context_.reset(&state->fallbacks);
+                state->fallbacks.succesful = planFallbacks(*state->start, *state->goal, *state->start_pose, *state->goal_pose,
+                                                           state->fallbacks.plan, state->fallbacks.dist_without_obstacles, state->fallbacks.fallback);
+                search_context_.release();
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+}
 
 
 };
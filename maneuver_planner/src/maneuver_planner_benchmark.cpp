@@ -0,0 +1,404 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+// Headless benchmark of the maneuver planner: plans every maneuver type on synthetic
+// (or PGM) costmaps without a Costmap2DROS or a running ROS master, and reports the
+// planning latency percentiles and the number of footprint checks per plan.
+//
+// Usage: maneuver_planner_benchmark [--reps N] [--cold-reps N]
+//            [--pgm file.pgm --resolution r --origin x y --query name sx sy sth gx gy gth ...]
+#include <maneuver_planner/maneuver_planner.h>
+#include <costmap_2d/cost_values.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  const char* GLOBAL_FRAME = "map";
+  const char* PLANNER_NAME = "maneuver_planner";
+
+  struct Query
+  {
+      std::string name;
+      double sx, sy, sth;
+      double gx, gy, gth;
+  };
+
+  struct Scenario
+  {
+      std::string name;
+      boost::shared_ptr<costmap_2d::Costmap2D> map;
+      std::vector<Query> queries;
+  };
+
+  struct FootprintProfile
+  {
+      std::string name;
+      std::vector<geometry_msgs::Point> spec;
+  };
+
+  struct Result
+  {
+      std::vector<double> latencies;    // seconds
+      double total_checks;
+      bool success;
+      size_t plan_size;
+      Result() : total_checks(0.0), success(false), plan_size(0) {}
+  };
+
+  Query makeQuery(const std::string& name, double sx, double sy, double sth, double gx, double gy, double gth)
+  {
+      Query q;
+      q.name = name;
+      q.sx = sx; q.sy = sy; q.sth = sth;
+      q.gx = gx; q.gy = gy; q.gth = gth;
+      return q;
+  }
+
+  geometry_msgs::PoseStamped makePose(double x, double y, double theta)
+  {
+      geometry_msgs::PoseStamped pose;
+      pose.header.frame_id = GLOBAL_FRAME;
+      pose.pose.position.x = x;
+      pose.pose.position.y = y;
+      pose.pose.orientation = tf::createQuaternionMsgFromYaw(theta);
+      return pose;
+  }
+
+  // Rectangle from the footprint parameters in maneuver_navigation/config
+  FootprintProfile makeRectangle(const std::string& name, double min_x, double min_y, double max_x, double max_y)
+  {
+      FootprintProfile profile;
+      profile.name = name;
+      geometry_msgs::Point pt;
+      pt.x = min_x; pt.y = max_y; profile.spec.push_back(pt);
+      pt.x = max_x; pt.y = max_y; profile.spec.push_back(pt);
+      pt.x = max_x; pt.y = min_y; profile.spec.push_back(pt);
+      pt.x = min_x; pt.y = min_y; profile.spec.push_back(pt);
+      return profile;
+  }
+
+  void fillBox(costmap_2d::Costmap2D& map, double min_x, double min_y, double max_x, double max_y, unsigned char cost)
+  {
+      for (unsigned int j = 0; j < map.getSizeInCellsY(); j++)
+      {
+          for (unsigned int i = 0; i < map.getSizeInCellsX(); i++)
+          {
+              double wx, wy;
+              map.mapToWorld(i, j, wx, wy);
+              if( wx >= min_x && wx <= max_x && wy >= min_y && wy <= max_y )
+                  map.setCost(i, j, cost);
+          }
+      }
+  }
+
+  // 24x24 m of walls with a 2.4 m wide corridor along the x axis, robots drive on the right lane
+  boost::shared_ptr<costmap_2d::Costmap2D> makeCorridorMap()
+  {
+      boost::shared_ptr<costmap_2d::Costmap2D> map(new costmap_2d::Costmap2D(480, 480, 0.05, -12.0, -12.0, costmap_2d::LETHAL_OBSTACLE));
+      fillBox(*map, -12.0, -1.2, 12.0, 1.2, costmap_2d::FREE_SPACE);
+      return map;
+  }
+
+  void makeSyntheticScenarios(std::vector<Scenario>& scenarios)
+  {
+      Scenario corridor;
+      corridor.name = "corridor";
+      corridor.map = makeCorridorMap();
+      corridor.queries.push_back(makeQuery("straight", -6.0, -0.5, 0.0, 4.0, -0.5, 0.0));
+      corridor.queries.push_back(makeQuery("left_right", -6.0, -0.5, 0.0, -1.0, 0.5, 0.0));
+      corridor.queries.push_back(makeQuery("right_left", -6.0, 0.5, 0.0, -1.0, -0.5, 0.0));
+      scenarios.push_back(corridor);
+
+      Scenario t_intersection;
+      t_intersection.name = "t_intersection";
+      t_intersection.map = makeCorridorMap();
+      fillBox(*t_intersection.map, 2.0, -12.0, 4.0, 0.0, costmap_2d::FREE_SPACE);
+      t_intersection.queries.push_back(makeQuery("right", -4.0, -0.5, 0.0, 2.5, -5.0, -M_PI/2.0));
+      t_intersection.queries.push_back(makeQuery("left", 3.5, -6.0, M_PI/2.0, -3.0, 0.5, M_PI));
+      t_intersection.queries.push_back(makeQuery("right_stem", 3.5, -6.0, M_PI/2.0, 9.0, -0.5, 0.0));
+      scenarios.push_back(t_intersection);
+
+      Scenario x_intersection;
+      x_intersection.name = "x_intersection";
+      x_intersection.map = makeCorridorMap();
+      fillBox(*x_intersection.map, 2.0, -12.0, 4.0, 12.0, costmap_2d::FREE_SPACE);
+      x_intersection.queries.push_back(makeQuery("left", -4.0, -0.5, 0.0, 3.5, 5.0, M_PI/2.0));
+      x_intersection.queries.push_back(makeQuery("right", -4.0, -0.5, 0.0, 2.5, -5.0, -M_PI/2.0));
+      x_intersection.queries.push_back(makeQuery("straight", -6.0, -0.5, 0.0, 8.0, -0.5, 0.0));
+      scenarios.push_back(x_intersection);
+
+      // A cart on the right lane to overtake, and a wall closing the corridor further ahead
+      Scenario blocked_lane;
+      blocked_lane.name = "blocked_lane";
+      blocked_lane.map = makeCorridorMap();
+      fillBox(*blocked_lane.map, -1.0, -1.2, -0.3, -0.4, costmap_2d::LETHAL_OBSTACLE);
+      fillBox(*blocked_lane.map, 8.0, -1.2, 8.3, 1.2, costmap_2d::LETHAL_OBSTACLE);
+      blocked_lane.queries.push_back(makeQuery("overtake", -2.5, -0.5, 0.0, 3.0, -0.5, 0.0));
+      blocked_lane.queries.push_back(makeQuery("dead_end", 4.0, -0.5, 0.0, 10.0, -0.5, 0.0));
+      scenarios.push_back(blocked_lane);
+
+      // A 0.9 m door across the corridor and a 1.0 m door into a room on its left side
+      Scenario narrow_door;
+      narrow_door.name = "narrow_door";
+      narrow_door.map = makeCorridorMap();
+      fillBox(*narrow_door.map, 0.0, -1.2, 0.2, 1.2, costmap_2d::LETHAL_OBSTACLE);
+      fillBox(*narrow_door.map, 0.0, -0.55, 0.2, 0.35, costmap_2d::FREE_SPACE);
+      fillBox(*narrow_door.map, 4.0, 1.2, 5.0, 2.0, costmap_2d::FREE_SPACE);
+      fillBox(*narrow_door.map, 2.0, 2.0, 8.0, 8.0, costmap_2d::FREE_SPACE);
+      narrow_door.queries.push_back(makeQuery("straight", -4.0, -0.1, 0.0, 3.0, -0.1, 0.0));
+      narrow_door.queries.push_back(makeQuery("left", 1.0, -0.5, 0.0, 4.5, 4.0, M_PI/2.0));
+      scenarios.push_back(narrow_door);
+  }
+
+  // Reads a binary (P5) or ASCII (P2) PGM, with the thresholds and orientation of map_server
+  bool loadPgm(const std::string& file, double resolution, double origin_x, double origin_y,
+               boost::shared_ptr<costmap_2d::Costmap2D>& map)
+  {
+      std::ifstream in(file.c_str(), std::ios::binary);
+      if( !in )
+      {
+          ROS_ERROR("Cannot open %s", file.c_str());
+          return false;
+      }
+      std::string magic;
+      unsigned int header[3];     // width, height, maxval
+      in >> magic;
+      for (int k = 0; k < 3; k++)
+      {
+          in >> std::ws;
+          while( in.peek() == '#' )
+          {   // Skip comment lines
+              std::string comment;
+              std::getline(in, comment);
+              in >> std::ws;
+          }
+          in >> header[k];
+      }
+      if( !in || (magic != "P5" && magic != "P2") || header[2] == 0 || header[2] > 255 )
+      {
+          ROS_ERROR("%s is not an 8 bit PGM file", file.c_str());
+          return false;
+      }
+      in.get();   // Single whitespace before the binary data
+
+      const unsigned int width = header[0], height = header[1];
+      map.reset(new costmap_2d::Costmap2D(width, height, resolution, origin_x, origin_y, costmap_2d::NO_INFORMATION));
+      for (unsigned int row = 0; row < height; row++)
+      {
+          for (unsigned int i = 0; i < width; i++)
+          {
+              int value;
+              if( magic == "P5" )
+                  value = in.get();
+              else
+                  in >> value;
+              if( !in )
+              {
+                  ROS_ERROR("%s is truncated", file.c_str());
+                  return false;
+              }
+              // The first row of the image is the top of the map
+              double occupancy = (header[2] - value) / (double) header[2];
+              unsigned char cost = costmap_2d::NO_INFORMATION;
+              if( occupancy > 0.65 )
+                  cost = costmap_2d::LETHAL_OBSTACLE;
+              else if( occupancy < 0.196 )
+                  cost = costmap_2d::FREE_SPACE;
+              map->setCost(i, height - 1 - row, cost);
+          }
+      }
+      return true;
+  }
+
+  double percentile(const std::vector<double>& sorted, double p)
+  {
+      if( sorted.empty() )
+          return 0.0;
+      size_t rank = (size_t) std::ceil(p*sorted.size());
+      return sorted[std::min(sorted.size(), std::max((size_t) 1, rank)) - 1];
+  }
+
+  void printResult(const Scenario& scenario, const Query& query, const FootprintProfile& footprint,
+                   const char* mode, Result& result)
+  {
+      std::sort(result.latencies.begin(), result.latencies.end());
+      printf("%-15s %-11s %-11s %-5s %-3s %6zu %9.1f %9.3f %9.3f %9.3f %9.3f\n",
+             scenario.name.c_str(), query.name.c_str(), footprint.name.c_str(), mode, result.success ? "yes" : "no",
+             result.plan_size, result.total_checks/std::max((size_t) 1, result.latencies.size()),
+             percentile(result.latencies, 0.5)*1e3, percentile(result.latencies, 0.9)*1e3,
+             percentile(result.latencies, 0.99)*1e3, result.latencies.empty() ? 0.0 : result.latencies.back()*1e3);
+  }
+
+  void timePlan(maneuver_planner::ManeuverPlanner& planner, const Query& query, Result& result)
+  {
+      std::vector<geometry_msgs::PoseStamped> plan;
+      double dist_without_obstacles = 0.0;
+      geometry_msgs::PoseStamped start = makePose(query.sx, query.sy, query.sth);
+      geometry_msgs::PoseStamped goal = makePose(query.gx, query.gy, query.gth);
+
+      unsigned long checks_before = planner.getFootprintChecks();
+      ros::WallTime t_start = ros::WallTime::now();
+      result.success = planner.makePlan(start, goal, plan, dist_without_obstacles);
+      result.latencies.push_back((ros::WallTime::now() - t_start).toSec());
+      result.total_checks += planner.getFootprintChecks() - checks_before;
+      result.plan_size = plan.size();
+  }
+
+  // A first request to the start pose builds the footprint templates, so they are not part of the timings
+  void initPlanner(maneuver_planner::ManeuverPlanner& planner, const Scenario& scenario, const Query& query,
+                   const FootprintProfile& footprint)
+  {
+      planner.initialize(PLANNER_NAME, scenario.map.get(), footprint.spec, GLOBAL_FRAME);
+      std::vector<geometry_msgs::PoseStamped> plan;
+      planner.makePlan(makePose(query.sx, query.sy, query.sth), makePose(query.sx, query.sy, query.sth), plan);
+  }
+
+  void runQuery(const Scenario& scenario, const Query& query, const FootprintProfile& footprint, int reps, int cold_reps)
+  {
+      // Cold: a fresh planner for every plan, nothing remembered from previous requests
+      Result cold;
+      for (int rep = 0; rep < cold_reps; rep++)
+      {
+          maneuver_planner::ManeuverPlanner planner;
+          initPlanner(planner, scenario, query, footprint);
+          timePlan(planner, query, cold);
+      }
+      if( cold_reps > 0 )
+          printResult(scenario, query, footprint, "cold", cold);
+
+      // Warm: the same request repeated on an unchanged costmap, e.g. waiting behind an obstacle
+      Result warm;
+      maneuver_planner::ManeuverPlanner planner;
+      initPlanner(planner, scenario, query, footprint);
+      for (int rep = 0; rep < reps; rep++)
+          timePlan(planner, query, warm);
+      if( reps > 0 )
+          printResult(scenario, query, footprint, "warm", warm);
+  }
+
+  bool parseDoubles(int argc, char** argv, int& i, int n, double* values)
+  {
+      if( i + n >= argc )
+          return false;
+      for (int k = 0; k < n; k++)
+          values[k] = atof(argv[++i]);
+      return true;
+  }
+
+  void usage(const char* program)
+  {
+      fprintf(stderr, "Usage: %s [--reps N] [--cold-reps N] [--pgm file.pgm --resolution r --origin x y "
+                      "--query name sx sy sth gx gy gth ...]\n", program);
+  }
+}
+
+int main(int argc, char** argv)
+{
+    // No master is needed, the planner parameters take their defaults unless one is running
+    ros::init(argc, argv, "maneuver_planner_benchmark", ros::init_options::AnonymousName | ros::init_options::NoRosout);
+
+    int reps = 100;
+    int cold_reps = 20;
+    std::string pgm_file;
+    double resolution = 0.05;
+    double origin[2] = {0.0, 0.0};
+    std::vector<Query> pgm_queries;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        double values[6];
+        if( arg == "--reps" && i + 1 < argc )
+            reps = atoi(argv[++i]);
+        else if( arg == "--cold-reps" && i + 1 < argc )
+            cold_reps = atoi(argv[++i]);
+        else if( arg == "--pgm" && i + 1 < argc )
+            pgm_file = argv[++i];
+        else if( arg == "--resolution" && parseDoubles(argc, argv, i, 1, values) )
+            resolution = values[0];
+        else if( arg == "--origin" && parseDoubles(argc, argv, i, 2, origin) )
+            ;
+        else if( arg == "--query" && i + 1 < argc )
+        {
+            std::string name = argv[++i];
+            if( !parseDoubles(argc, argv, i, 6, values) )
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            pgm_queries.push_back(makeQuery(name, values[0], values[1], values[2], values[3], values[4], values[5]));
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<Scenario> scenarios;
+    if( pgm_file.empty() )
+        makeSyntheticScenarios(scenarios);
+    else
+    {
+        Scenario scenario;
+        scenario.name = pgm_file.substr(pgm_file.find_last_of('/') + 1);
+        scenario.queries = pgm_queries;
+        if( scenario.queries.empty() || !loadPgm(pgm_file, resolution, origin[0], origin[1], scenario.map) )
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        scenarios.push_back(scenario);
+    }
+
+    std::vector<FootprintProfile> footprints;
+    footprints.push_back(makeRectangle("ropod", -0.33, -0.33, 0.33, 0.33));
+    footprints.push_back(makeRectangle("ropod_load", -0.1, -0.36, 1.3, 0.36));
+
+    printf("%-15s %-11s %-11s %-5s %-3s %6s %9s %9s %9s %9s %9s\n", "scenario", "query", "footprint", "mode", "ok",
+           "poses", "checks", "p50[ms]", "p90[ms]", "p99[ms]", "max[ms]");
+    for (size_t s = 0; s < scenarios.size(); s++)
+        for (size_t f = 0; f < footprints.size(); f++)
+            for (size_t q = 0; q < scenarios[s].queries.size(); q++)
+                runQuery(scenarios[s], scenarios[s].queries[q], footprints[f], reps, cold_reps);
+    return 0;
+}
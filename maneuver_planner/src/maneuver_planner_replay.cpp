@@ -0,0 +1,164 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+// Offline replay of the plans recorded by a maneuver planner with the record_file parameter.
+// Every recorded call is repeated on its costmap window and footprint without a Costmap2DROS
+// or a running ROS master, and compared with the recorded outcome and planning time.
+//
+// Usage: maneuver_planner_replay file [--reps N] [--use-time-budget]
+#include <maneuver_planner/maneuver_planner.h>
+#include <maneuver_planner/plan_record.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+  const char* PLANNER_NAME = "maneuver_planner";
+
+  double percentile(const std::vector<double>& sorted, double p)
+  {
+      if( sorted.empty() )
+          return 0.0;
+      size_t rank = (size_t) std::ceil(p*sorted.size());
+      return sorted[std::min(sorted.size(), std::max((size_t) 1, rank)) - 1];
+  }
+
+  bool replayPlan(maneuver_planner::ManeuverPlanner& planner, const maneuver_planner::PlanRecord& record, bool use_time_budget,
+                  base_local_planner::CompactPlan& plan, double& dist_without_obstacles)
+  {
+      if( record.use_line_planner )
+          return planner.makePlan(record.start, record.goal, plan, dist_without_obstacles, true);
+      ros::WallTime deadline;
+      if( use_time_budget && record.time_budget > 0.0 )
+          deadline = ros::WallTime::now() + ros::WallDuration(record.time_budget);
+      bool search_complete;
+      return planner.makePlan(record.start, record.goal, plan, dist_without_obstacles, deadline, search_complete);
+  }
+
+  void usage(const char* program)
+  {
+      fprintf(stderr, "Usage: %s file [--reps N] [--use-time-budget]\n", program);
+  }
+}
+
+int main(int argc, char** argv)
+{
+    // No master is needed, the planner parameters take their defaults unless one is running
+    ros::init(argc, argv, "maneuver_planner_replay", ros::init_options::AnonymousName | ros::init_options::NoRosout);
+
+    std::string file;
+    int reps = 20;
+    // Without the recorded time budget every replay searches to the end, so the plans are the same on any machine
+    bool use_time_budget = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if( arg == "--reps" && i + 1 < argc )
+            reps = atoi(argv[++i]);
+        else if( arg == "--use-time-budget" )
+            use_time_budget = true;
+        else if( file.empty() && arg.compare(0, 2, "--") != 0 )
+            file = arg;
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if( file.empty() || reps < 1 )
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    maneuver_planner::PlanRecordReader reader(file);
+    if( !reader.isValid() )
+    {
+        ROS_ERROR("%s is not a plan record file", file.c_str());
+        return 1;
+    }
+
+    printf("%5s %-4s %7s %7s %8s %8s %6s %6s %9s %9s %9s %9s %5s\n", "plan", "type", "rec_ok", "rep_ok", "rec_dist", "rep_dist",
+           "rec_n", "rep_n", "rec[ms]", "p50[ms]", "p90[ms]", "max[ms]", "same");
+    maneuver_planner::PlanRecord record;
+    size_t num_records = 0, num_different = 0;
+    std::vector<double> all_latencies;
+    while( reader.read(record) )
+    {
+        boost::shared_ptr<costmap_2d::Costmap2D> map = record.makeCostmap();
+
+        std::vector<double> latencies;
+        base_local_planner::CompactPlan plan;
+        double dist_without_obstacles = 0.0;
+        bool plan_free = false;
+        for (int rep = 0; rep < reps; rep++)
+        {
+            // A fresh planner per repetition, so no repetition finds the candidates of the previous one in the candidate memo.
+            // The untimed request to the start pose builds the footprint templates
+            maneuver_planner::ManeuverPlanner planner;
+            planner.initialize(PLANNER_NAME, map.get(), record.footprint, record.goal.header.frame_id);
+            std::vector<geometry_msgs::PoseStamped> warmup_plan;
+            planner.makePlan(record.start, record.start, warmup_plan);
+
+            ros::WallTime t_start = ros::WallTime::now();
+            plan_free = replayPlan(planner, record, use_time_budget, plan, dist_without_obstacles);
+            latencies.push_back((ros::WallTime::now() - t_start).toSec());
+        }
+        all_latencies.insert(all_latencies.end(), latencies.begin(), latencies.end());
+        std::sort(latencies.begin(), latencies.end());
+
+        bool same = plan_free == record.plan_free && plan.size() == record.plan_size &&
+                    std::fabs(dist_without_obstacles - record.dist_without_obstacles) < 1e-6;
+        if( !same )
+            num_different++;
+        printf("%5zu %-4s %7s %7s %8.3f %8.3f %6u %6zu %9.3f %9.3f %9.3f %9.3f %5s\n", num_records, record.use_line_planner ? "line" : "man",
+               record.plan_free ? "yes" : "no", plan_free ? "yes" : "no", record.dist_without_obstacles, dist_without_obstacles,
+               record.plan_size, plan.size(), record.planning_time*1e3, percentile(latencies, 0.5)*1e3,
+               percentile(latencies, 0.9)*1e3, latencies.back()*1e3, same ? "yes" : "no");
+        num_records++;
+    }
+
+    std::sort(all_latencies.begin(), all_latencies.end());
+    printf("%zu plans replayed %d times, %zu with another outcome than recorded. p50 %.3f ms, p90 %.3f ms, p99 %.3f ms\n",
+           num_records, reps, num_different, percentile(all_latencies, 0.5)*1e3, percentile(all_latencies, 0.9)*1e3,
+           percentile(all_latencies, 0.99)*1e3);
+    return 0;
+}
@@ -35,6 +35,7 @@
 * Authors: Cesar Lopez
 *********************************************************************/
 #include <maneuver_planner/parameter_generator.h>
+#include <limits>
 
 namespace parameter_generator {
 
@@ -48,6 +49,8 @@ ParameterGenerator::ParameterGenerator()
     lin_search_max_steps_ = 1;
     lin_search_sign_ = 1;
     lin_search_cnt_ = 0;
+    strategy_ = MID_SEARCH;
+    feedback_ = -std::numeric_limits<double>::max();
 }    
     
 ParameterGenerator::ParameterGenerator(double lin_search_min, double lin_search_max, double lin_search_absmax, double lin_search_step_size_min, int lin_search_max_steps)
@@ -60,6 +63,8 @@ ParameterGenerator::ParameterGenerator(double lin_search_min, double lin_search_
     lin_search_max_steps_ = lin_search_max_steps;
     lin_search_sign_ = 1;
     lin_search_cnt_ = 0;
+    strategy_ = MID_SEARCH;
+    feedback_ = -std::numeric_limits<double>::max();
 
 }
 
@@ -126,5 +131,148 @@ bool ParameterGenerator::linearSearch(double &lin_search_curr)
     }
 }
 
+enum GoldenSectionState
+{
+    GS_FIRST_POINT,     // Nothing returned yet
+    GS_WAIT_X1,         // gs_x1_ returned, waiting for its feedback
+    GS_WAIT_X2,         // gs_x2_ returned, waiting for its feedback
+};
+
+static const double GOLDEN_RATIO_CONJUGATE = 0.6180339887498949;
+
+void ParameterGenerator::resetGoldenSectionSearch(double lin_search_min, double lin_search_max)
+{
+      lin_search_max_ = std::min(lin_search_absmax_,lin_search_max); 
+      lin_search_max_ = std::max(lin_search_max_,lin_search_min); 
+      lin_search_min_ = lin_search_min;
+      gs_lower_ = lin_search_min_;
+      gs_upper_ = lin_search_max_;
+      gs_x1_ = gs_upper_ - GOLDEN_RATIO_CONJUGATE*(gs_upper_-gs_lower_);
+      gs_x2_ = gs_lower_ + GOLDEN_RATIO_CONJUGATE*(gs_upper_-gs_lower_);
+      gs_state_ = GS_FIRST_POINT;
+      lin_search_curr_ = gs_x1_;
+      lin_search_cnt_ = 0;
+      feedback_ = -std::numeric_limits<double>::max();
+}
+
+bool ParameterGenerator::goldenSectionSearch(double &lin_search_curr)
+{
+    if( lin_search_cnt_ >= lin_search_max_steps_ )
+    {
+        lin_search_curr = lin_search_curr_;
+        return false;
+    }
+    
+    if( gs_state_ == GS_FIRST_POINT )
+    {   // Both inner points are evaluated first
+        lin_search_curr_ = gs_x1_;
+        gs_state_ = GS_WAIT_X1;
+    }
+    else if( gs_state_ == GS_WAIT_X1 && lin_search_cnt_ == 1 )
+    {
+        gs_f1_ = feedback_;
+        if( gs_upper_-gs_lower_ < lin_search_step_size_min_ )
+        {   // Range too small to be split
+            lin_search_curr = lin_search_curr_;
+            return false;
+        }
+        lin_search_curr_ = gs_x2_;
+        gs_state_ = GS_WAIT_X2;
+    }
+    else
+    {
+        if( gs_state_ == GS_WAIT_X1 )
+            gs_f1_ = feedback_;
+        else
+            gs_f2_ = feedback_;
+        
+        // Keep the part of the bracket around the better inner point, the remaining inner point is reused
+        if( gs_f1_ >= gs_f2_ )
+        {
+            gs_upper_ = gs_x2_;
+            gs_x2_ = gs_x1_;
+            gs_f2_ = gs_f1_;
+            gs_x1_ = gs_upper_ - GOLDEN_RATIO_CONJUGATE*(gs_upper_-gs_lower_);
+            lin_search_curr_ = gs_x1_;
+            gs_state_ = GS_WAIT_X1;
+        }
+        else
+        {
+            gs_lower_ = gs_x1_;
+            gs_x1_ = gs_x2_;
+            gs_f1_ = gs_f2_;
+            gs_x2_ = gs_lower_ + GOLDEN_RATIO_CONJUGATE*(gs_upper_-gs_lower_);
+            lin_search_curr_ = gs_x2_;
+            gs_state_ = GS_WAIT_X2;
+        }
+        if( gs_upper_-gs_lower_ < lin_search_step_size_min_ )
+        {
+            lin_search_curr = lin_search_curr_;
+            return false;
+        }
+    }
+    
+    lin_search_cnt_++;
+    feedback_ = -std::numeric_limits<double>::max();
+    lin_search_curr = lin_search_curr_;
+    return true;
+}
+
+void ParameterGenerator::resetSearch(double lin_search_min, double lin_search_max)
+{
+    switch (strategy_)
+    {
+    case LINEAR_SEARCH:
+        resetLinearSearch(lin_search_min, lin_search_max);
+        break;
+    case GOLDEN_SECTION_SEARCH:
+        resetGoldenSectionSearch(lin_search_min, lin_search_max);
+        break;
+    default:
+        resetMidSearch(lin_search_min, lin_search_max);
+        break;
+    }
+}
+
+bool ParameterGenerator::search(double &lin_search_curr)
+{
+    switch (strategy_)
+    {
+    case LINEAR_SEARCH:
+        return linearSearch(lin_search_curr);
+    case GOLDEN_SECTION_SEARCH:
+        return goldenSectionSearch(lin_search_curr);
+    default:
+        return midSearch(lin_search_curr);
+    }
+}
+
+void ParameterGenerator::searchValues(double lin_search_min, double lin_search_max, std::vector<double>& values) const
+{
+    ParameterGenerator generator = *this;
+    if( generator.strategy_ == GOLDEN_SECTION_SEARCH )
+        generator.strategy_ = MID_SEARCH;
+    
+    double value;
+    values.clear();
+    generator.resetSearch(lin_search_min, lin_search_max);
+    while( generator.search(value) )
+        values.push_back(value);
+}
+
+void ParameterGenerator::setFeedback(double feedback)
+{
+    feedback_ = feedback;
+}
+
+void ParameterGenerator::setStrategy(SearchStrategy strategy)
+{
+    strategy_ = strategy;
+}
+
+ParameterGenerator::SearchStrategy ParameterGenerator::getStrategy() const
+{
+    return strategy_;
+}
 
 };
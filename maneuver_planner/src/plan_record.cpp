@@ -0,0 +1,260 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#include <maneuver_planner/plan_record.h>
+#include <ros/console.h>
+#include <costmap_2d/cost_values.h>
+#include <boost/weak_ptr.hpp>
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace maneuver_planner{
+namespace
+{
+    // Host byte order, the files are meant to be replayed on a machine like the robot
+    const char FILE_MAGIC[4] = {'M', 'P', 'R', 'C'};
+    const unsigned int FILE_VERSION = 1;
+    // Larger costmap windows are taken for corrupt records, the run length encoding would allow a few bytes to claim any size
+    const unsigned long long MAX_RECORD_CELLS = 1ull << 24;
+    
+    template <typename T> void put(std::ostream& out, const T& value)
+    {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    
+    template <typename T> bool get(std::istream& in, T& value)
+    {
+        return (bool) in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    }
+    
+    void putPose(std::ostream& out, const geometry_msgs::PoseStamped& pose)
+    {
+        put(out, pose.pose.position.x);
+        put(out, pose.pose.position.y);
+        put(out, pose.pose.orientation.x);
+        put(out, pose.pose.orientation.y);
+        put(out, pose.pose.orientation.z);
+        put(out, pose.pose.orientation.w);
+    }
+    
+    bool getPose(std::istream& in, const std::string& frame_id, geometry_msgs::PoseStamped& pose)
+    {
+        pose.header.frame_id = frame_id;
+        return get(in, pose.pose.position.x) && get(in, pose.pose.position.y) &&
+               get(in, pose.pose.orientation.x) && get(in, pose.pose.orientation.y) &&
+               get(in, pose.pose.orientation.z) && get(in, pose.pose.orientation.w);
+    }
+    
+    boost::mutex recorders_mutex;
+    std::map<std::string, boost::weak_ptr<PlanRecorder> > recorders;
+}
+
+void PlanRecord::cropCostmap(const costmap_2d::Costmap2D& costmap, double min_x, double min_y, double max_x, double max_y)
+{
+    resolution = costmap.getResolution();
+    int x0 = std::max(0, (int) std::floor((min_x - costmap.getOriginX())/resolution));
+    int y0 = std::max(0, (int) std::floor((min_y - costmap.getOriginY())/resolution));
+    int x1 = std::min((int) costmap.getSizeInCellsX(), (int) std::ceil((max_x - costmap.getOriginX())/resolution));
+    int y1 = std::min((int) costmap.getSizeInCellsY(), (int) std::ceil((max_y - costmap.getOriginY())/resolution));
+    size_x = std::max(0, x1 - x0);
+    size_y = std::max(0, y1 - y0);
+    origin_x = costmap.getOriginX() + x0*resolution;
+    origin_y = costmap.getOriginY() + y0*resolution;
+    
+    cells.resize(size_x*size_y);
+    const unsigned char* charmap = costmap.getCharMap();
+    for (unsigned int j = 0; j < size_y; j++)
+    {
+        const unsigned char* row = charmap + costmap.getIndex(x0, y0 + j);
+        std::copy(row, row + size_x, cells.begin() + j*size_x);
+    }
+}
+
+boost::shared_ptr<costmap_2d::Costmap2D> PlanRecord::makeCostmap() const
+{
+    boost::shared_ptr<costmap_2d::Costmap2D> costmap(new costmap_2d::Costmap2D(size_x, size_y, resolution, origin_x, origin_y, costmap_2d::NO_INFORMATION));
+    if( !cells.empty() )
+        std::copy(cells.begin(), cells.end(), costmap->getCharMap());
+    return costmap;
+}
+
+boost::shared_ptr<PlanRecorder> PlanRecorder::open(const std::string& file)
+{
+    boost::mutex::scoped_lock lock(recorders_mutex);
+    boost::shared_ptr<PlanRecorder> recorder = recorders[file].lock();
+    if( recorder )
+        return recorder;
+    
+    recorder.reset(new PlanRecorder(file));
+    if( !recorder->out_ )
+    {
+        ROS_ERROR("Cannot open %s to record the plans", file.c_str());
+        return boost::shared_ptr<PlanRecorder>();
+    }
+    recorders[file] = recorder;
+    return recorder;
+}
+
+PlanRecorder::PlanRecorder(const std::string& file) : out_(file.c_str(), std::ios::binary | std::ios::trunc)
+{
+    out_.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+    put(out_, FILE_VERSION);
+}
+
+void PlanRecorder::write(const PlanRecord& record)
+{
+    boost::mutex::scoped_lock lock(mutex_);
+    
+    unsigned int frame_length = record.goal.header.frame_id.size();
+    put(out_, frame_length);
+    out_.write(record.goal.header.frame_id.data(), frame_length);
+    putPose(out_, record.start);
+    putPose(out_, record.goal);
+    put(out_, (unsigned char) record.use_line_planner);
+    put(out_, record.time_budget);
+    
+    unsigned int footprint_size = record.footprint.size();
+    put(out_, footprint_size);
+    for (unsigned int i = 0; i < footprint_size; i++)
+    {
+        put(out_, record.footprint[i].x);
+        put(out_, record.footprint[i].y);
+    }
+    
+    put(out_, record.origin_x);
+    put(out_, record.origin_y);
+    put(out_, record.resolution);
+    put(out_, record.size_x);
+    put(out_, record.size_y);
+    // Runs of equal cells, costmaps are mostly free space and walls
+    std::vector<std::pair<unsigned int, unsigned char> > runs;
+    for (size_t i = 0; i < record.cells.size(); i++)
+    {
+        if( runs.empty() || runs.back().second != record.cells[i] )
+            runs.push_back(std::make_pair(0u, record.cells[i]));
+        runs.back().first++;
+    }
+    unsigned int num_runs = runs.size();
+    put(out_, num_runs);
+    for (size_t i = 0; i < runs.size(); i++)
+    {
+        put(out_, runs[i].first);
+        put(out_, runs[i].second);
+    }
+    
+    put(out_, (unsigned char) record.plan_free);
+    put(out_, record.dist_without_obstacles);
+    put(out_, record.plan_size);
+    put(out_, record.planning_time);
+    out_.flush();
+}
+
+PlanRecordReader::PlanRecordReader(const std::string& file) : in_(file.c_str(), std::ios::binary), valid_(false)
+{
+    char magic[sizeof(FILE_MAGIC)];
+    unsigned int version;
+    valid_ = in_.read(magic, sizeof(magic)) && std::equal(magic, magic + sizeof(magic), FILE_MAGIC) &&
+             get(in_, version) && version == FILE_VERSION;
+    if( valid_ )
+    {
+        std::streampos records_start = in_.tellg();
+        in_.seekg(0, std::ios::end);
+        end_ = in_.tellg();
+        in_.seekg(records_start);
+        valid_ = (bool) in_;
+    }
+}
+
+bool PlanRecordReader::remains(unsigned long long bytes)
+{
+    std::streampos position = in_.tellg();
+    return position != std::streampos(-1) && position <= end_ && (unsigned long long) (end_ - position) >= bytes;
+}
+
+bool PlanRecordReader::read(PlanRecord& record)
+{
+    if( !valid_ )
+        return false;
+    
+    unsigned int frame_length;
+    if( !get(in_, frame_length) || !remains(frame_length) )
+        return false;
+    std::string frame_id(frame_length, '\0');
+    unsigned char use_line_planner;
+    if( !in_.read(&frame_id[0], frame_length) || !getPose(in_, frame_id, record.start) || !getPose(in_, frame_id, record.goal) ||
+        !get(in_, use_line_planner) || !get(in_, record.time_budget) )
+        return false;
+    record.use_line_planner = use_line_planner;
+    
+    unsigned int footprint_size;
+    if( !get(in_, footprint_size) || !remains(2ull*sizeof(double)*footprint_size) )
+        return false;
+    record.footprint.resize(footprint_size);
+    for (unsigned int i = 0; i < footprint_size; i++)
+    {
+        if( !get(in_, record.footprint[i].x) || !get(in_, record.footprint[i].y) )
+            return false;
+        record.footprint[i].z = 0.0;
+    }
+    
+    unsigned int num_runs;
+    if( !get(in_, record.origin_x) || !get(in_, record.origin_y) || !get(in_, record.resolution) ||
+        !get(in_, record.size_x) || !get(in_, record.size_y) || !get(in_, num_runs) )
+        return false;
+    unsigned long long num_cells = (unsigned long long) record.size_x*record.size_y;
+    if( num_cells > MAX_RECORD_CELLS || !remains((sizeof(unsigned int) + sizeof(unsigned char))*(unsigned long long) num_runs) )
+        return false;
+    record.cells.clear();
+    record.cells.reserve(num_cells);
+    for (unsigned int i = 0; i < num_runs; i++)
+    {
+        unsigned int count;
+        unsigned char value;
+        if( !get(in_, count) || !get(in_, value) || record.cells.size() + count > num_cells )
+            return false;
+        record.cells.insert(record.cells.end(), count, value);
+    }
+    if( record.cells.size() != num_cells )
+        return false;
+    
+    unsigned char plan_free;
+    if( !get(in_, plan_free) || !get(in_, record.dist_without_obstacles) || !get(in_, record.plan_size) || !get(in_, record.planning_time) )
+        return false;
+    record.plan_free = plan_free;
+    return true;
+}
+};
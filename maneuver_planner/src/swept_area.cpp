@@ -0,0 +1,163 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#include <maneuver_planner/swept_area.h>
+#include <algorithm>
+#include <cmath>
+
+namespace maneuver_planner{
+
+namespace {
+
+struct HullPoint
+{
+    double u, v;
+    bool operator<(const HullPoint& other) const { return u < other.u || (u == other.u && v < other.v); }
+};
+
+double cross(const HullPoint& o, const HullPoint& a, const HullPoint& b)
+{
+    return (a.u - o.u)*(b.v - o.v) - (a.v - o.v)*(b.u - o.u);
+}
+
+// Andrew's monotone chain, counterclockwise without repeating the first point
+void convexHull(std::vector<HullPoint>& points, std::vector<HullPoint>& hull)
+{
+    std::sort(points.begin(), points.end());
+    hull.resize(2*points.size());
+    size_t k = 0;
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        while (k >= 2 && cross(hull[k-2], hull[k-1], points[i]) <= 0.0)
+            k--;
+        hull[k++] = points[i];
+    }
+    for (size_t i = points.size() - 1, lower = k + 1; i > 0; i--)
+    {
+        while (k >= lower && cross(hull[k-2], hull[k-1], points[i-1]) <= 0.0)
+            k--;
+        hull[k++] = points[i-1];
+    }
+    hull.resize(k > 1 ? k - 1 : k);
+}
+
+}
+
+bool sweptAreaFree(const costmap_2d::Costmap2D& costmap, const std::vector<geometry_msgs::Point>& footprint_spec,
+                   const SE2& from, const SE2& to, double padding)
+{
+    if( footprint_spec.size() < 3 )
+        return false;
+    
+    // Corners of both footprints in cell units
+    double resolution = costmap.getResolution();
+    double origin_x = costmap.getOriginX();
+    double origin_y = costmap.getOriginY();
+    std::vector<HullPoint> points(2*footprint_spec.size());
+    for (size_t i = 0; i < footprint_spec.size(); i++)
+    {
+        double x, y;
+        from.transformPoint(footprint_spec[i].x, footprint_spec[i].y, x, y);
+        points[2*i].u = (x - origin_x)/resolution;
+        points[2*i].v = (y - origin_y)/resolution;
+        to.transformPoint(footprint_spec[i].x, footprint_spec[i].y, x, y);
+        points[2*i + 1].u = (x - origin_x)/resolution;
+        points[2*i + 1].v = (y - origin_y)/resolution;
+    }
+    std::vector<HullPoint> hull;
+    convexHull(points, hull);
+    size_t n = hull.size();
+    
+    // The hull is grown by a square of half side pad, which contains the padding circle
+    double pad = padding/resolution;
+    double min_v = hull[0].v, max_v = hull[0].v;
+    for (size_t i = 1; i < n; i++)
+    {
+        min_v = std::min(min_v, hull[i].v);
+        max_v = std::max(max_v, hull[i].v);
+    }
+    // Like the costmap model, an area that leaves the map is not free
+    int size_x = costmap.getSizeInCellsX();
+    int size_y = costmap.getSizeInCellsY();
+    if( points.front().u - pad < 0.0 || min_v - pad < 0.0 || points.back().u + pad >= size_x || max_v + pad >= size_y )
+        return false;
+    
+    // Extent of the hull within every strip of one row, from its edges clipped to the strip
+    int first_strip = (int) std::floor(min_v);
+    int num_strips = (int) std::floor(max_v) - first_strip + 1;
+    std::vector<double> strip_min_u(num_strips, points.back().u);
+    std::vector<double> strip_max_u(num_strips, points.front().u);
+    for (size_t i = 0; i < n; i++)
+    {
+        const HullPoint& a = hull[i].v <= hull[(i + 1) % n].v ? hull[i] : hull[(i + 1) % n];
+        const HullPoint& b = hull[i].v <= hull[(i + 1) % n].v ? hull[(i + 1) % n] : hull[i];
+        double slope = a.v != b.v ? (b.u - a.u)/(b.v - a.v) : 0.0;
+        double u_in = a.u;
+        for (int strip = (int) std::floor(a.v); strip <= (int) std::floor(b.v); strip++)
+        {
+            double u_out = strip + 1.0 < b.v ? a.u + (strip + 1.0 - a.v)*slope : b.u;
+            int index = strip - first_strip;
+            strip_min_u[index] = std::min(strip_min_u[index], std::min(u_in, u_out));
+            strip_max_u[index] = std::max(strip_max_u[index], std::max(u_in, u_out));
+            u_in = u_out;
+        }
+    }
+    
+    // Within a row, the grown hull spans the strips up to pad away, widened by pad on both sides
+    const unsigned char* charmap = costmap.getCharMap();
+    for (int row = (int) std::floor(min_v - pad); row <= (int) std::floor(max_v + pad); row++)
+    {
+        int first = std::max((int) std::floor(row - pad), first_strip) - first_strip;
+        int last = std::min((int) std::floor(row + 1.0 + pad), first_strip + num_strips - 1) - first_strip;
+        double row_min_u = strip_min_u[first], row_max_u = strip_max_u[first];
+        for (int index = first + 1; index <= last; index++)
+        {
+            row_min_u = std::min(row_min_u, strip_min_u[index]);
+            row_max_u = std::max(row_max_u, strip_max_u[index]);
+        }
+        
+        // Lethal and unknown are the two highest costs
+        const unsigned char* cells = charmap + row*size_x;
+        unsigned char max_cost = 0;
+        for (int cell = (int) std::floor(row_min_u - pad); cell <= (int) std::floor(row_max_u + pad); cell++)
+            max_cost = std::max(max_cost, cells[cell]);
+        if( max_cost >= costmap_2d::LETHAL_OBSTACLE )
+            return false;
+    }
+    return true;
+}
+
+};
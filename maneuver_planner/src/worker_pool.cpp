@@ -0,0 +1,141 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2018, TU/e
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Authors: Cesar Lopez
+*********************************************************************/
+#include <maneuver_planner/worker_pool.h>
+
+namespace maneuver_planner {
+
+WorkerPool::WorkerPool(unsigned int num_threads)
+    : num_workers_(0), generation_(0), pending_(0), shutdown_(false)
+{
+    // The calling thread always takes part in a run, so only num_threads-1 extra threads are needed
+    for (unsigned int i = 1; i < num_threads; i++)
+    {
+        threads_.create_thread(boost::bind(&WorkerPool::workerLoop, this));
+        num_workers_++;
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    job_cond_.notify_all();
+    threads_.join_all();
+}
+
+unsigned int WorkerPool::size() const
+{
+    return num_workers_ + 1;
+}
+
+void WorkerPool::run(const boost::function<void ()>& task)
+{
+    boost::unique_lock<boost::mutex> run_lock(run_mutex_, boost::try_to_lock);
+    if (!run_lock.owns_lock() || num_workers_ == 0)
+    {   // Pool busy (nested call) or no workers: execute on this thread only
+        task();
+        return;
+    }
+
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        task_ = task;
+        pending_ = num_workers_;
+        generation_++;
+    }
+    job_cond_.notify_all();
+
+    // The workers still use the state of the task, so it is only left once they are done
+    boost::exception_ptr exception;
+    try
+    {
+        task();
+    }
+    catch (...)
+    {
+        exception = boost::current_exception();
+    }
+
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    while (pending_ > 0)
+        done_cond_.wait(lock);
+    task_.clear();
+    if (!exception)
+        exception = exception_;
+    exception_ = boost::exception_ptr();
+    lock.unlock();
+    if (exception)
+        boost::rethrow_exception(exception);
+}
+
+void WorkerPool::workerLoop()
+{
+    unsigned long seen_generation = 0;
+    while (true)
+    {
+        boost::function<void ()> task;
+        {
+            boost::unique_lock<boost::mutex> lock(mutex_);
+            while (!shutdown_ && generation_ == seen_generation)
+                job_cond_.wait(lock);
+            if (shutdown_)
+                return;
+            seen_generation = generation_;
+            task = task_;
+        }
+
+        boost::exception_ptr exception;
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            exception = boost::current_exception();
+        }
+
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        if (exception && !exception_)
+            exception_ = exception;
+        if (--pending_ == 0)
+            done_cond_.notify_all();
+    }
+}
+
+};
@@ -0,0 +1,86 @@
+/*
+ * candidate_memo_test.cpp
+ *
+ *  Created on: Nov 12, 2018
+ *      Author: Cesar Lopez
+ */
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <maneuver_planner/candidate_memo.h>
+
+namespace maneuver_planner {
+
+//key of a segment from a start pose, the rest of the segment parameters fixed
+static CandidateMemo::Key startKey(double x, double y, double theta) {
+  CandidateMemo::Key key;
+  key.push_back(x);
+  key.push_back(y);
+  key.push_back(theta);
+  key.push_back(1.5);
+  key.push_back(-0.8);
+  return key;
+}
+
+static CandidateMemoEntry makeEntry(bool traj_free, int collision_pose) {
+  CandidateMemoEntry entry;
+  entry.traj_free = traj_free;
+  entry.collision_pose = collision_pose;
+  entry.min_x = 0.5;
+  entry.min_y = 0.5;
+  entry.max_x = 2.0;
+  entry.max_y = 2.0;
+  entry.revision = 0;
+  return entry;
+}
+
+TEST(CandidateMemoTest, neighbourNeverTurnsCollisionFree){
+  costmap_2d::Costmap2D costmap(64, 64, 0.05, 0.0, 0.0);
+  std::vector<geometry_msgs::Point> footprint;
+  CandidateMemo memo(100);
+  memo.update(costmap, footprint);
+
+  //the footprint of a segment from a start just beside this one missed the obstacle
+  memo.store(startKey(1.0, 1.0, 0.3), makeEntry(false, 12));
+  memo.store(startKey(1.0 + 0.004, 1.0, 0.3), makeEntry(true, -1));
+  memo.store(startKey(1.0, 1.0 - 1e-9, 0.3), makeEntry(true, -1));
+  memo.store(startKey(1.0, 1.0, 0.3 + 1e-6), makeEntry(true, -1));
+
+  CandidateMemoEntry entry;
+  ASSERT_TRUE(memo.lookup(startKey(1.0, 1.0, 0.3), entry));
+  EXPECT_FALSE(entry.traj_free);
+  EXPECT_EQ(12, entry.collision_pose);
+
+  //a start that was never checked gets no outcome, however close it is to a free one
+  EXPECT_FALSE(memo.lookup(startKey(1.0 + 0.002, 1.0, 0.3), entry));
+  EXPECT_FALSE(memo.lookup(startKey(1.0 + 0.004 + 1e-12, 1.0, 0.3), entry));
+  ASSERT_TRUE(memo.lookup(startKey(1.0 + 0.004, 1.0, 0.3), entry));
+  EXPECT_TRUE(entry.traj_free);
+}
+
+TEST(CandidateMemoTest, changedCostmapDropsEntry){
+  costmap_2d::Costmap2D costmap(64, 64, 0.05, 0.0, 0.0);
+  std::vector<geometry_msgs::Point> footprint;
+  CandidateMemo memo(100);
+  memo.update(costmap, footprint);
+  memo.store(startKey(1.0, 1.0, 0.3), makeEntry(true, -1));
+
+  //a change outside of the swept area keeps the entry
+  costmap.setCost(60, 60, 254);
+  memo.update(costmap, footprint);
+  CandidateMemoEntry entry;
+  EXPECT_TRUE(memo.lookup(startKey(1.0, 1.0, 0.3), entry));
+
+  //an obstacle inside of it drops the entry
+  costmap.setCost(20, 20, 254);
+  memo.update(costmap, footprint);
+  EXPECT_FALSE(memo.lookup(startKey(1.0, 1.0, 0.3), entry));
+}
+
+}
+
+int main( int argc, char **argv ) {
+  testing::InitGoogleTest( &argc, argv );
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,148 @@
+/*
+ * costmap_change_tracker_test.cpp
+ *
+ *  Created on: Nov 20, 2018
+ *      Author: Cesar Lopez
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <maneuver_planner/costmap_change_tracker.h>
+
+namespace maneuver_planner {
+
+static const double RESOLUTION = 0.1;
+
+//world center of cell (x, y) of the costmap
+static double worldX(const costmap_2d::Costmap2D& costmap, int x) {
+  return costmap.getOriginX() + (x + 0.5) * RESOLUTION;
+}
+static double worldY(const costmap_2d::Costmap2D& costmap, int y) {
+  return costmap.getOriginY() + (y + 0.5) * RESOLUTION;
+}
+
+//index of a cell in the world, independent of the origin of the costmap
+static std::pair<int, int> worldCell(const costmap_2d::Costmap2D& costmap, int x, int y) {
+  return std::make_pair((int) std::floor(worldX(costmap, x) / RESOLUTION), (int) std::floor(worldY(costmap, y) / RESOLUTION));
+}
+
+TEST(CostmapChangeTrackerTest, unchangedCellsKeepTheirRevisionAcrossAShift){
+  costmap_2d::Costmap2D costmap(64, 64, RESOLUTION, 0.0, 0.0, costmap_2d::FREE_SPACE);
+  costmap.setCost(20, 20, costmap_2d::LETHAL_OBSTACLE);
+  CostmapChangeTracker tracker(8);
+  unsigned long initial = tracker.update(costmap);
+
+  //the window rolls by 10 and 5 cells, the obstacle is now at cell (10, 15)
+  costmap.updateOrigin(1.0, 0.5);
+  unsigned long shifted = tracker.update(costmap);
+  EXPECT_GT(shifted, initial);
+  EXPECT_EQ(initial, tracker.resetRevision());
+
+  //the world around the obstacle did not change, the cells that entered the map did
+  EXPECT_FALSE(tracker.changedSince(initial, 2.0, 1.9, 2.2, 2.2));
+  EXPECT_FALSE(tracker.changedSince(initial, 0, 0, 40, 40));
+  EXPECT_TRUE(tracker.changedSince(initial, 60, 10, 63, 12));
+  EXPECT_TRUE(tracker.changedSince(initial, 10, 60, 12, 63));
+  EXPECT_TRUE(tracker.changedSince(initial, 7.3, 0.6, 7.3, 0.6));
+
+  //the snapshot moved with the map, another update finds nothing new
+  EXPECT_EQ(shifted, tracker.update(costmap));
+
+  //a change after the shift is found at its world position
+  costmap.setCost(30, 30, costmap_2d::LETHAL_OBSTACLE);
+  unsigned long changed = tracker.update(costmap);
+  EXPECT_GT(changed, shifted);
+  EXPECT_TRUE(tracker.changedSince(shifted, worldX(costmap, 30), worldY(costmap, 30), worldX(costmap, 30), worldY(costmap, 30)));
+  EXPECT_FALSE(tracker.changedSince(shifted, worldX(costmap, 10), worldY(costmap, 15), worldX(costmap, 10), worldY(costmap, 15)));
+}
+
+TEST(CostmapChangeTrackerTest, fractionalShiftChangesEverything){
+  costmap_2d::Costmap2D costmap(32, 32, RESOLUTION, 0.0, 0.0, costmap_2d::FREE_SPACE);
+  CostmapChangeTracker tracker(8);
+  unsigned long initial = tracker.update(costmap);
+
+  costmap_2d::Costmap2D moved(32, 32, RESOLUTION, 0.05, 0.0, costmap_2d::FREE_SPACE);
+  unsigned long reset = tracker.update(moved);
+  EXPECT_EQ(reset, tracker.resetRevision());
+  EXPECT_TRUE(tracker.changedSince(initial, 10, 10, 10, 10));
+  EXPECT_FALSE(tracker.changedSince(reset, 10, 10, 10, 10));
+}
+
+TEST(CostmapChangeTrackerTest, randomShiftsAndEditsAreNeverMissed){
+  const int size = 48;
+  costmap_2d::Costmap2D costmap(size, size, RESOLUTION, 0.0, 0.0, costmap_2d::FREE_SPACE);
+  CostmapChangeTracker tracker(8);
+  std::vector<unsigned long> revisions;
+  revisions.push_back(tracker.update(costmap));
+
+  //revision of the last update that changed every world cell, entering the map counts as a change
+  std::map<std::pair<int, int>, unsigned long> last_change;
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      last_change[worldCell(costmap, x, y)] = revisions.back();
+    }
+  }
+
+  srand(7);
+  int num_changed_queries = 0;
+  for (int step = 0; step < 200; ++step) {
+    std::map<std::pair<int, int>, unsigned char> before;
+    for (int y = 0; y < size; ++y) {
+      for (int x = 0; x < size; ++x) {
+        before[worldCell(costmap, x, y)] = costmap.getCost(x, y);
+      }
+    }
+    if (step % 4 == 0) {
+      int dx = rand() % 11 - 5, dy = rand() % 11 - 5;
+      costmap.updateOrigin(costmap.getOriginX() + dx * RESOLUTION, costmap.getOriginY() + dy * RESOLUTION);
+    }
+    for (int edit = rand() % 4; edit > 0; --edit) {
+      costmap.setCost(rand() % size, rand() % size, rand() % 2 ? costmap_2d::LETHAL_OBSTACLE : costmap_2d::FREE_SPACE);
+    }
+    unsigned long revision = tracker.update(costmap);
+    for (int y = 0; y < size; ++y) {
+      for (int x = 0; x < size; ++x) {
+        std::pair<int, int> cell = worldCell(costmap, x, y);
+        std::map<std::pair<int, int>, unsigned char>::const_iterator previous = before.find(cell);
+        if (previous == before.end() || previous->second != costmap.getCost(x, y)) {
+          last_change[cell] = revision;
+        }
+      }
+    }
+    revisions.push_back(revision);
+
+    //every box with a cell changed after a past revision is reported, in cells and in world coordinates
+    for (int query = 0; query < 20; ++query) {
+      unsigned long since = revisions[rand() % revisions.size()];
+      int x0 = rand() % size, y0 = rand() % size;
+      int x1 = std::min(size - 1, x0 + rand() % 6), y1 = std::min(size - 1, y0 + rand() % 6);
+      bool changed = false;
+      for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+          changed = changed || last_change[worldCell(costmap, x, y)] > since;
+        }
+      }
+      if (changed) {
+        num_changed_queries++;
+        EXPECT_TRUE(tracker.changedSince(since, x0, y0, x1, y1)) << "step " << step;
+        EXPECT_TRUE(tracker.changedSince(since, worldX(costmap, x0), worldY(costmap, y0), worldX(costmap, x1), worldY(costmap, y1)));
+      }
+    }
+  }
+  EXPECT_GT(num_changed_queries, 500);
+  //the window only moved by whole cells, nothing reset the tracker
+  EXPECT_EQ(revisions.front(), tracker.resetRevision());
+}
+
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,84 @@
+/*
+ * parameter_generator_test.cpp
+ *
+ *  Created on: Nov 20, 2018
+ *      Author: Cesar Lopez
+ */
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <maneuver_planner/parameter_generator.h>
+
+namespace parameter_generator {
+
+//unimodal feedback, highest at the optimum
+static double feedbackAround(double value, double optimum) {
+  return -(value - optimum) * (value - optimum);
+}
+
+//runs a golden-section search on [min, max], returns the value with the highest feedback
+static double runGoldenSection(ParameterGenerator& generator, double min, double max, double optimum, std::vector<double>& values) {
+  generator.setStrategy(ParameterGenerator::GOLDEN_SECTION_SEARCH);
+  generator.resetSearch(min, max);
+  double value, best_value = min, best_feedback = -HUGE_VAL;
+  while (generator.search(value)) {
+    values.push_back(value);
+    double feedback = feedbackAround(value, optimum);
+    generator.setFeedback(feedback);
+    if (feedback > best_feedback) {
+      best_feedback = feedback;
+      best_value = value;
+    }
+  }
+  return best_value;
+}
+
+TEST(ParameterGeneratorTest, goldenSectionConvergesToTheOptimum){
+  const double step_size_min = 0.01;
+  ParameterGenerator generator(0.0, 10.0, 10.0, step_size_min, 100);
+  std::vector<double> values;
+  double best_value = runGoldenSection(generator, 0.0, 10.0, 3.7, values);
+
+  EXPECT_NEAR(3.7, best_value, step_size_min);
+  for (unsigned int i = 0; i < values.size(); ++i) {
+    EXPECT_GE(values[i], 0.0);
+    EXPECT_LE(values[i], 10.0);
+  }
+  //the bracket shrinks by the golden ratio per value, 10 m down to 1 cm takes 15 reductions after the first two values
+  EXPECT_LE(values.size(), 17u);
+  EXPECT_GE(values.size(), 10u);
+}
+
+TEST(ParameterGeneratorTest, goldenSectionFindsTheOptimumAtTheBorder){
+  ParameterGenerator generator(0.0, 2.0, 2.0, 0.01, 100);
+  std::vector<double> values;
+  double best_value = runGoldenSection(generator, 0.0, 2.0, 2.5, values);
+
+  //an optimum outside the range is approached from inside
+  EXPECT_NEAR(2.0, best_value, 0.02);
+  EXPECT_LE(values.size(), 15u);
+}
+
+TEST(ParameterGeneratorTest, goldenSectionKeepsToMaxSteps){
+  ParameterGenerator generator(0.0, 10.0, 10.0, 1e-6, 5);
+  std::vector<double> values;
+  runGoldenSection(generator, 0.0, 10.0, 3.7, values);
+  EXPECT_EQ(5u, values.size());
+}
+
+TEST(ParameterGeneratorTest, goldenSectionOfAnEmptyRange){
+  ParameterGenerator generator(0.0, 10.0, 10.0, 0.01, 100);
+  std::vector<double> values;
+  double best_value = runGoldenSection(generator, 4.0, 4.0, 3.7, values);
+  ASSERT_EQ(1u, values.size());
+  EXPECT_DOUBLE_EQ(4.0, best_value);
+}
+
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
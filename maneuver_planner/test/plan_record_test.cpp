@@ -0,0 +1,172 @@
+/*
+ * plan_record_test.cpp
+ *
+ *  Created on: Nov 20, 2018
+ *      Author: Cesar Lopez
+ */
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <maneuver_planner/plan_record.h>
+
+namespace maneuver_planner {
+
+static const char* RECORD_FILE = "plan_record_test.rec";
+
+template <typename T> static void put(std::ostream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+//a file with the header of PlanRecorder and a record up to its footprint size
+static void writeRecordStart(std::ofstream& out, unsigned int footprint_size) {
+  out.write("MPRC", 4);
+  put(out, 1u);
+  std::string frame_id = "map";
+  put(out, (unsigned int) frame_id.size());
+  out.write(frame_id.data(), frame_id.size());
+  for (int i = 0; i < 2*6; i++) {
+    put(out, 0.0);
+  }
+  put(out, (unsigned char) 0);
+  put(out, 0.0);
+  put(out, footprint_size);
+}
+
+static PlanRecord makeRecord() {
+  PlanRecord record;
+  record.start.header.frame_id = "map";
+  record.goal.header.frame_id = "map";
+  record.start.pose.position.x = 0.5;
+  record.goal.pose.position.x = 2.5;
+  record.goal.pose.position.y = 1.0;
+  record.time_budget = 0.05;
+  geometry_msgs::Point point;
+  point.x = 0.3;
+  point.y = -0.2;
+  record.footprint.push_back(point);
+  point.y = 0.2;
+  record.footprint.push_back(point);
+  point.x = -0.3;
+  record.footprint.push_back(point);
+
+  costmap_2d::Costmap2D costmap(40, 30, 0.1, -1.0, -1.0);
+  costmap.setCost(10, 12, costmap_2d::LETHAL_OBSTACLE);
+  costmap.setCost(11, 12, costmap_2d::LETHAL_OBSTACLE);
+  record.cropCostmap(costmap, -0.5, -0.5, 2.0, 1.5);
+
+  record.plan_free = true;
+  record.dist_without_obstacles = 2.1;
+  record.plan_size = 42;
+  record.planning_time = 0.003;
+  return record;
+}
+
+TEST(PlanRecordTest, roundTrip){
+  PlanRecord written = makeRecord();
+  {
+    boost::shared_ptr<PlanRecorder> recorder = PlanRecorder::open(RECORD_FILE);
+    ASSERT_TRUE(recorder);
+    recorder->write(written);
+  }
+
+  PlanRecordReader reader(RECORD_FILE);
+  ASSERT_TRUE(reader.isValid());
+  PlanRecord read;
+  ASSERT_TRUE(reader.read(read));
+  EXPECT_EQ(written.goal.header.frame_id, read.goal.header.frame_id);
+  EXPECT_DOUBLE_EQ(2.5, read.goal.pose.position.x);
+  EXPECT_EQ(written.footprint.size(), read.footprint.size());
+  EXPECT_EQ(written.size_x, read.size_x);
+  EXPECT_EQ(written.size_y, read.size_y);
+  EXPECT_TRUE(written.cells == read.cells);
+  EXPECT_EQ(42u, read.plan_size);
+  EXPECT_FALSE(reader.read(read));
+  std::remove(RECORD_FILE);
+}
+
+TEST(PlanRecordTest, truncatedRecordIsNotRead){
+  {
+    boost::shared_ptr<PlanRecorder> recorder = PlanRecorder::open(RECORD_FILE);
+    ASSERT_TRUE(recorder);
+    recorder->write(makeRecord());
+  }
+  std::string contents;
+  {
+    std::ifstream in(RECORD_FILE, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream out(RECORD_FILE, std::ios::binary | std::ios::trunc);
+    out.write(contents.data(), contents.size() - 5);
+  }
+
+  PlanRecordReader reader(RECORD_FILE);
+  ASSERT_TRUE(reader.isValid());
+  PlanRecord read;
+  EXPECT_FALSE(reader.read(read));
+  std::remove(RECORD_FILE);
+}
+
+TEST(PlanRecordTest, corruptSizesAreRejectedBeforeAllocating){
+  {
+    //a footprint size that the few bytes left cannot hold
+    std::ofstream out(RECORD_FILE, std::ios::binary | std::ios::trunc);
+    writeRecordStart(out, 0xffffffffu);
+    put(out, 0.0);
+  }
+  PlanRecord read;
+  {
+    PlanRecordReader reader(RECORD_FILE);
+    ASSERT_TRUE(reader.isValid());
+    EXPECT_FALSE(reader.read(read));
+  }
+
+  {
+    //a costmap window of 2^40 cells, claimed by a single run
+    std::ofstream out(RECORD_FILE, std::ios::binary | std::ios::trunc);
+    writeRecordStart(out, 0u);
+    put(out, 0.0);
+    put(out, 0.0);
+    put(out, 0.05);
+    put(out, 1u << 20);
+    put(out, 1u << 20);
+    put(out, 1u);
+    put(out, 0xffffffffu);
+    put(out, (unsigned char) 0);
+  }
+  {
+    PlanRecordReader reader(RECORD_FILE);
+    ASSERT_TRUE(reader.isValid());
+    EXPECT_FALSE(reader.read(read));
+  }
+
+  {
+    //more runs than bytes left
+    std::ofstream out(RECORD_FILE, std::ios::binary | std::ios::trunc);
+    writeRecordStart(out, 0u);
+    put(out, 0.0);
+    put(out, 0.0);
+    put(out, 0.05);
+    put(out, 10u);
+    put(out, 10u);
+    put(out, 0x7fffffffu);
+  }
+  {
+    PlanRecordReader reader(RECORD_FILE);
+    ASSERT_TRUE(reader.isValid());
+    EXPECT_FALSE(reader.read(read));
+  }
+  std::remove(RECORD_FILE);
+}
+
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
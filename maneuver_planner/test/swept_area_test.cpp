@@ -0,0 +1,151 @@
+/*
+ * swept_area_test.cpp
+ *
+ *  Created on: Nov 20, 2018
+ *      Author: Cesar Lopez
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <maneuver_planner/swept_area.h>
+
+namespace maneuver_planner {
+
+static const double RESOLUTION = 0.05;
+
+static std::vector<geometry_msgs::Point> makeFootprint(const double* coords, int num_points) {
+  std::vector<geometry_msgs::Point> footprint(num_points);
+  for (int i = 0; i < num_points; ++i) {
+    footprint[i].x = coords[2*i];
+    footprint[i].y = coords[2*i + 1];
+  }
+  return footprint;
+}
+
+static bool insidePolygon(const std::vector<geometry_msgs::Point>& polygon, double x, double y) {
+  bool inside = false;
+  for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+    if ((polygon[i].y > y) != (polygon[j].y > y) &&
+        x < (polygon[j].x - polygon[i].x) * (y - polygon[i].y) / (polygon[j].y - polygon[i].y) + polygon[i].x) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+//brute force: the footprint at many poses between from and to, sampled much finer than the cells
+static bool perPoseFree(const costmap_2d::Costmap2D& costmap, const std::vector<geometry_msgs::Point>& footprint,
+                        const SE2& from, const SE2& to) {
+  double min_x = footprint[0].x, max_x = min_x, min_y = footprint[0].y, max_y = min_y;
+  for (size_t i = 1; i < footprint.size(); ++i) {
+    min_x = std::min(min_x, footprint[i].x);
+    max_x = std::max(max_x, footprint[i].x);
+    min_y = std::min(min_y, footprint[i].y);
+    max_y = std::max(max_y, footprint[i].y);
+  }
+  double step = RESOLUTION / 3;
+  std::vector<std::pair<double, double> > samples;
+  for (double x = min_x; x <= max_x; x += step) {
+    for (double y = min_y; y <= max_y; y += step) {
+      if (insidePolygon(footprint, x, y)) {
+        samples.push_back(std::make_pair(x, y));
+      }
+    }
+  }
+  double dyaw = angles::shortest_angular_distance(from.theta(), to.theta());
+  const int num_poses = 40;
+  for (int k = 0; k <= num_poses; ++k) {
+    double s = (double) k / num_poses;
+    SE2 pose(from.x() + s * (to.x() - from.x()), from.y() + s * (to.y() - from.y()), from.theta() + s * dyaw);
+    for (size_t i = 0; i < samples.size(); ++i) {
+      double x, y;
+      pose.transformPoint(samples[i].first, samples[i].second, x, y);
+      unsigned int mx, my;
+      if (!costmap.worldToMap(x, y, mx, my) || costmap.getCost(mx, my) >= costmap_2d::LETHAL_OBSTACLE) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static double uniform(double min, double max) {
+  return min + (max - min) * rand() / (double) RAND_MAX;
+}
+
+//the padding the planner gives a run, for the rotation and the rasterization
+static double padding(double radius, double dyaw) {
+  return 2.0 * RESOLUTION + radius * std::abs(dyaw);
+}
+
+TEST(SweptAreaTest, neverFreeWhereAPoseCollides){
+  const double rectangle[] = {0.3, 0.2, 0.3, -0.2, -0.3, -0.2, -0.3, 0.2};
+  const double pentagon[] = {0.4, 0.0, 0.1, -0.25, -0.3, -0.2, -0.3, 0.2, 0.1, 0.25};
+  std::vector<std::vector<geometry_msgs::Point> > footprints;
+  footprints.push_back(makeFootprint(rectangle, 4));
+  footprints.push_back(makeFootprint(pentagon, 5));
+
+  srand(42);
+  int num_free = 0, num_blocked = 0;
+  for (int map = 0; map < 10; ++map) {
+    costmap_2d::Costmap2D costmap(80, 80, RESOLUTION, 0.0, 0.0, costmap_2d::FREE_SPACE);
+    for (int obstacle = 0; obstacle < 10; ++obstacle) {
+      costmap.setCost(rand() % 80, rand() % 80, obstacle % 2 ? costmap_2d::LETHAL_OBSTACLE : costmap_2d::NO_INFORMATION);
+    }
+    for (size_t f = 0; f < footprints.size(); ++f) {
+      const std::vector<geometry_msgs::Point>& footprint = footprints[f];
+      double radius = 0.0;
+      for (size_t i = 0; i < footprint.size(); ++i) {
+        radius = std::max(radius, hypot(footprint[i].x, footprint[i].y));
+      }
+      for (int move = 0; move < 25; ++move) {
+        SE2 from(uniform(0.5, 3.5), uniform(0.5, 3.5), uniform(-M_PI, M_PI));
+        double heading = uniform(-M_PI, M_PI), length = uniform(0.0, 0.4), dyaw = uniform(-0.1, 0.1);
+        SE2 to(from.x() + length * cos(heading), from.y() + length * sin(heading), from.theta() + dyaw);
+
+        bool swept_free = sweptAreaFree(costmap, footprint, from, to, padding(radius, dyaw));
+        if (!perPoseFree(costmap, footprint, from, to)) {
+          EXPECT_FALSE(swept_free) << "map " << map << " footprint " << f << " move " << move;
+          num_blocked++;
+        } else if (swept_free) {
+          num_free++;
+        }
+      }
+    }
+  }
+  //both outcomes occur, so the check above is not vacuous
+  EXPECT_GT(num_blocked, 20);
+  EXPECT_GT(num_free, 200);
+}
+
+TEST(SweptAreaTest, freeAwayFromObstacles){
+  const double rectangle[] = {0.3, 0.2, 0.3, -0.2, -0.3, -0.2, -0.3, 0.2};
+  std::vector<geometry_msgs::Point> footprint = makeFootprint(rectangle, 4);
+  costmap_2d::Costmap2D costmap(80, 80, RESOLUTION, 0.0, 0.0, costmap_2d::FREE_SPACE);
+  SE2 from(1.0, 2.0, 0.0), to(3.0, 2.0, 0.0);
+  double pad = padding(0.36, 0.0);
+  EXPECT_TRUE(sweptAreaFree(costmap, footprint, from, to, pad));
+
+  //an obstacle a cell beyond the padding does not block, one inside the padding does
+  unsigned int mx, my;
+  ASSERT_TRUE(costmap.worldToMap(2.0, 2.2 + pad + 1.5 * RESOLUTION, mx, my));
+  costmap.setCost(mx, my, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_TRUE(sweptAreaFree(costmap, footprint, from, to, pad));
+  ASSERT_TRUE(costmap.worldToMap(2.0, 2.2 + pad / 2, mx, my));
+  costmap.setCost(mx, my, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_FALSE(sweptAreaFree(costmap, footprint, from, to, pad));
+
+  //leaving the map is not free
+  EXPECT_FALSE(sweptAreaFree(costmap, footprint, SE2(3.0, 1.0, 0.0), SE2(3.9, 1.0, 0.0), pad));
+}
+
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
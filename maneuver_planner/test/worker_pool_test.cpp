@@ -0,0 +1,122 @@
+/*
+ * worker_pool_test.cpp
+ *
+ *  Created on: Nov 20, 2018
+ *      Author: Cesar Lopez
+ */
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+
+#include <maneuver_planner/worker_pool.h>
+
+namespace maneuver_planner {
+
+//candidates pulled by index from shared state, like the candidate evaluation of the planner
+struct IndexedWork {
+  boost::atomic<size_t> next;
+  std::vector<int> results;
+  std::vector<int> evaluations;
+  boost::mutex mutex;
+  std::set<boost::thread::id> threads;
+
+  IndexedWork(size_t size) : next(0), results(size, -1), evaluations(size, 0) {}
+};
+
+static void evaluateItems(IndexedWork* work) {
+  {
+    boost::unique_lock<boost::mutex> lock(work->mutex);
+    work->threads.insert(boost::this_thread::get_id());
+  }
+  size_t i;
+  while ((i = work->next.fetch_add(1)) < work->results.size()) {
+    //items take different times, so they finish out of order
+    if (i % 7 == 0) {
+      boost::this_thread::sleep(boost::posix_time::microseconds(200));
+    }
+    work->results[i] = (int) (i * i);
+    work->evaluations[i]++;
+  }
+}
+
+TEST(WorkerPoolTest, resultsKeepTheOrderOfTheItems){
+  WorkerPool pool(4);
+  ASSERT_EQ(4u, pool.size());
+  IndexedWork work(500);
+  pool.run(boost::bind(&evaluateItems, &work));
+
+  //every item evaluated once, the result in its own slot whatever thread evaluated it
+  for (size_t i = 0; i < work.results.size(); ++i) {
+    EXPECT_EQ(1, work.evaluations[i]);
+    EXPECT_EQ((int) (i * i), work.results[i]);
+  }
+  EXPECT_EQ(4u, work.threads.size());
+  EXPECT_EQ(1u, work.threads.count(boost::this_thread::get_id()));
+}
+
+static void runNested(WorkerPool* pool, IndexedWork* inner, boost::atomic<int>* runs) {
+  if (runs->fetch_add(1) == 0) {
+    pool->run(boost::bind(&evaluateItems, inner));
+  }
+}
+
+TEST(WorkerPoolTest, nestedRunStaysOnTheCallingThread){
+  WorkerPool pool(3);
+  IndexedWork inner(50);
+  boost::atomic<int> runs(0);
+  pool.run(boost::bind(&runNested, &pool, &inner, &runs));
+
+  EXPECT_EQ(3, runs.load());
+  EXPECT_EQ(1u, inner.threads.size());
+  for (size_t i = 0; i < inner.results.size(); ++i) {
+    EXPECT_EQ((int) (i * i), inner.results[i]);
+  }
+}
+
+static void throwOnCaller(boost::thread::id caller, boost::atomic<int>* finished) {
+  if (boost::this_thread::get_id() == caller) {
+    throw std::runtime_error("caller");
+  }
+  boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+  finished->fetch_add(1);
+}
+
+TEST(WorkerPoolTest, exceptionOfTheCallerWaitsForTheWorkers){
+  WorkerPool pool(3);
+  boost::atomic<int> finished(0);
+  EXPECT_THROW(pool.run(boost::bind(&throwOnCaller, boost::this_thread::get_id(), &finished)), std::runtime_error);
+  //the workers were done before the exception left run
+  EXPECT_EQ(2, finished.load());
+}
+
+static void throwOnWorker(boost::thread::id caller, boost::atomic<int>* finished) {
+  if (boost::this_thread::get_id() != caller) {
+    throw std::runtime_error("worker");
+  }
+  finished->fetch_add(1);
+}
+
+TEST(WorkerPoolTest, exceptionOfAWorkerIsRethrown){
+  WorkerPool pool(3);
+  boost::atomic<int> finished(0);
+  EXPECT_THROW(pool.run(boost::bind(&throwOnWorker, boost::this_thread::get_id(), &finished)), std::runtime_error);
+  EXPECT_EQ(1, finished.load());
+
+  //the pool is still usable, and the exception is not thrown again
+  IndexedWork work(100);
+  EXPECT_NO_THROW(pool.run(boost::bind(&evaluateItems, &work)));
+  for (size_t i = 0; i < work.results.size(); ++i) {
+    EXPECT_EQ((int) (i * i), work.results[i]);
+  }
+}
+
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}